@@ -18,9 +18,18 @@ SUBDIRS := \
 CMSIS/core \
 StdPeriph_Driver/src \
 src/BME280 \
+src/CLOCK \
 src/COMMON \
+src/FILTER \
+src/FORMAT \
+src/HISTOGRAM \
 src/I2C \
+src/MEASURE \
+src/POWER \
+src/PROFILE \
+src/SCHEDULER \
 src/SPI \
+src/TIMER \
 src/UART \
 src \
 startup \
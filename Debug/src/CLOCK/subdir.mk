@@ -0,0 +1,25 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+C_SRCS += \
+../src/CLOCK/CLOCK.c 
+
+OBJS += \
+./src/CLOCK/CLOCK.o 
+
+C_DEPS += \
+./src/CLOCK/CLOCK.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+src/CLOCK/%.o: ../src/CLOCK/%.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: MCU GCC Compiler'
+	@echo $(PWD)
+	arm-none-eabi-gcc -mcpu=cortex-m3 -mthumb -mfloat-abi=soft -DSTM32 -DSTM32F1 -DSTM32F103C8Tx -DDEBUG -DSTM32F10X_MD -DUSE_STDPERIPH_DRIVER -I"E:/STM32_ARM/MY_LIBRARIES/BME280/StdPeriph_Driver/inc" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/inc" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/CMSIS/device" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/CMSIS/core" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/COMMON" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/I2C" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/SPI" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/UART" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/BME280" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/CLOCK" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/FILTER" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/FORMAT" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/HISTOGRAM" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/MEASURE" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/POWER" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/PROFILE" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/SCHEDULER" -I"E:/STM32_ARM/MY_LIBRARIES/BME280/src/TIMER" -O0 -g3 -Wall -fmessage-length=0 -ffunction-sections -c -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+
@@ -6,35 +6,124 @@
  */
 
 #include "BME280.h"
-
-
-BME280 bme;
-CONF conf_BME280;
+#include "BME280_compensate.h"
+
+
+// --------------------------------------------------------- //
+// description of compensation parameters in raw calibration bytes:
+//		calib[ 0..25] -> registers 0x88 -> 0xA1
+//		calib[26..32] -> registers 0xE1 -> 0xE7
+typedef enum {calib_u8, calib_s8, calib_u16, calib_s16, calib_h4, calib_h5} CALIB_TYPE;
+
+typedef struct {
+	uint8_t index;		// index of first byte in calib table
+	uint8_t type;		// how bytes are packed
+	uint8_t offset;		// offset of parameter in TCOEF
+} CALIB_FIELD;
+
+static const CALIB_FIELD calib_fields[] = {
+	{ 0, calib_u16, offsetof(TCOEF, dig_T1)},	// 0x88 / 0x89
+	{ 2, calib_s16, offsetof(TCOEF, dig_T2)},	// 0x8A / 0x8B
+	{ 4, calib_s16, offsetof(TCOEF, dig_T3)},	// 0x8C / 0x8D
+	{ 6, calib_u16, offsetof(TCOEF, dig_P1)},	// 0x8E / 0x8F
+	{ 8, calib_s16, offsetof(TCOEF, dig_P2)},	// 0x90 / 0x91
+	{10, calib_s16, offsetof(TCOEF, dig_P3)},	// 0x92 / 0x93
+	{12, calib_s16, offsetof(TCOEF, dig_P4)},	// 0x94 / 0x95
+	{14, calib_s16, offsetof(TCOEF, dig_P5)},	// 0x96 / 0x97
+	{16, calib_s16, offsetof(TCOEF, dig_P6)},	// 0x98 / 0x99
+	{18, calib_s16, offsetof(TCOEF, dig_P7)},	// 0x9A / 0x9B
+	{20, calib_s16, offsetof(TCOEF, dig_P8)},	// 0x9C / 0x9D
+	{22, calib_s16, offsetof(TCOEF, dig_P9)},	// 0x9E / 0x9F
+	{25, calib_u8,  offsetof(TCOEF, dig_H1)},	// 0xA1
+	{26, calib_s16, offsetof(TCOEF, dig_H2)},	// 0xE1 / 0xE2
+	{28, calib_u8,  offsetof(TCOEF, dig_H3)},	// 0xE3
+	{29, calib_h4,  offsetof(TCOEF, dig_H4)},	// 0xE4 / 0xE5[3:0]
+	{30, calib_h5,  offsetof(TCOEF, dig_H5)},	// 0xE5[7:4] / 0xE6
+	{32, calib_s8,  offsetof(TCOEF, dig_H6)},	// 0xE7
+};
 
 void check_boundaries (BME280 *bme);																// check if read uncompensated values are in boundary MIN and MAX
-void soft_reset (void);																				// execute sensor reset by software
+void soft_reset (BME280 *bme);																		// execute sensor reset by software
 void get_status (BME280 *bme);																		// read statuses of sensor
-uint8_t bme280_compute_measure_time(MEASUREMENT_TIME type, CONF *sensor);							// measurement time in milliseconds for the active configuration
-void pressure_at_sea_level(BME280 *bme);															// calculating pressure reduced to sea level
 
-void BME280_read_data(uint8_t SLA, uint8_t register_addr,  uint8_t size, uint8_t *Data);			// read data from sensor
-void BME280_write_data(uint8_t SLA, uint8_t register_addr, uint8_t size, uint8_t *Data);			// write data to sensor
-uint8_t read_compensation_parameter_write_configuration_and_check_it (CONF *sensor, BME280 *bme);	// write configuration and check if saved configuration is equal to set
+void BME280_write_data(BME280 *bme, uint8_t register_addr, uint8_t size, uint8_t *Data);			// write data to sensor
+static void init_device(BME280 *bme);																// set default configuration of device context
+static uint8_t register_write_rank(uint8_t reg);													// order of registers in batched write
+static uint8_t read_compensation_parameter(BME280 *bme);											// read and check compensation parameters, needed only after reset
+uint8_t write_configuration_and_check_it (CONF *sensor, BME280 *bme);								// write configuration and check if saved configuration is equal to set
+void decode_compensation_parameters(const uint8_t *calib, TCOEF *coef);							// unpack raw calibration bytes into compensation parameters
+static uint8_t write_configuration(CONF *sensor, BME280 *bme);										// write registers which are different from shadow copy
+static uint8_t check_configuration(CONF *sensor, BME280 *bme);										// read configuration registers and compare with set values
+
+#if BME280_SPI
+static const BME280_TRANSPORT spi_transport;														// bus operations of sensor connected by SPI
+#endif
+#if BME280_I2C
+static const BME280_TRANSPORT i2c_transport;														// bus operations of sensor connected by I2C
+#endif
 
 #if CALCULATION_AVERAGE_TEMP
-	void calculation_average_temp(BME280 *bme);	// calculate average temperature, No of samples to calculations is taken from No_OF_SAMPLES
-	void calculation_average_humidity(BME280 *bme);	// calculate average values of temperature or humidity, No of samples to calculations is taken from No_OF_SAMPLES
+	void calculation_average_temp(BME280 *bme);			// calculate average temperature in running window
+#endif
+#if CALCULATION_AVERAGE_PRESSURE
+	void calculation_average_pressure(BME280 *bme);		// calculate average pressure in running window
+#endif
+#if CALCULATION_AVERAGE_HUMIDITY
+	void calculation_average_humidity(BME280 *bme);		// calculate average humidity in running window
 #endif
 
 /****************************************************************************/
-/*      setting function configurations of sensor					        */
+/*      prepare context of sensor connected by SPI					        */
 /****************************************************************************/
-uint8_t BME280_Conf (CONF *sensor, BME280 *bme)
+#if BME280_SPI
+void BME280_Init_SPI(BME280 *bme, GPIO_TypeDef *cs_port, uint16_t cs_pin)
 {
-	uint8_t counter = 0;
-	uint8_t  result_of_check = 5;
-	static uint32_t current_time = 0;
+	init_device(bme);
+
+	bme->transport	= &spi_transport;
+	bme->interface	= BME280_INTERFACE_SPI;
+	bme->cs_port	= cs_port;
+	bme->cs_pin		= cs_pin;
+
+	SPI_CS_Conf(cs_port, cs_pin);
+}
+#endif
+
+/****************************************************************************/
+/*      prepare context of sensor connected by I2C					        */
+/****************************************************************************/
+#if BME280_I2C
+void BME280_Init_I2C(BME280 *bme, uint8_t SLA)
+{
+	init_device(bme);
+
+	bme->transport	= &i2c_transport;
+	bme->interface	= BME280_INTERFACE_I2C;
+	bme->SLA		= SLA;
+}
+#endif
+
+/****************************************************************************/
+/*      prepare context of sensor with own bus operations, ctx is			*/
+/*      available for transport as bme->transport_ctx				        */
+/****************************************************************************/
+void BME280_Init_Transport(BME280 *bme, const BME280_TRANSPORT *transport, void *ctx)
+{
+	init_device(bme);
+
+	bme->transport		= transport;
+	bme->transport_ctx	= ctx;
+	bme->interface		= BME280_INTERFACE_OTHER;
+}
+
+/****************************************************************************/
+/*      set default configuration of device context			        		*/
+/****************************************************************************/
+static void init_device(BME280 *bme)
+{
+	CONF *sensor = &bme->conf;
 
+	memset(bme, 0, sizeof(BME280));
 
 	sensor->filter		= BME280_FILTER_OFF;
 	if (!sensor->filter)
@@ -49,17 +138,120 @@ uint8_t BME280_Conf (CONF *sensor, BME280 *bme)
 	sensor->reserved2	= 0;
 	sensor->t_sb		= BME280_STANDBY_MS_0_5;
 
-	if (current_time == 0)
+	BME280_Set_Average_Window(bme, No_OF_SAMPLES, No_OF_SAMPLES, No_OF_SAMPLES);
+	BME280_Set_Backend(bme, BME280_BACKEND_DEFAULT);
+	BME280_Set_Altitude(bme, BME280_ALTITUDE);
+	BME280_Set_Reference_Pressure(bme, BME280_REFERENCE_PRESSURE);
+}
+
+/****************************************************************************/
+/*      altitude of sensor, factors of reduction to sea level are			*/
+/*      computed once here, not for every sample							*/
+/****************************************************************************/
+void BME280_Set_Altitude(BME280 *bme, int32_t altitude)
+{
+	bme->station_altitude = altitude;
+	bme280_prepare_sea_level(altitude, bme->sea_factor);
+}
+
+/****************************************************************************/
+/*      reference pressure of altitude computation, reciprocal is computed	*/
+/*      once here, so every sample only multiplies; pressure out of range	*/
+/*      of sensor is rejected and previous reference is kept				*/
+/****************************************************************************/
+uint8_t BME280_Set_Reference_Pressure(BME280 *bme, uint32_t pressure)
+{
+	if ((pressure < BME280_REFERENCE_MIN) || (pressure > BME280_REFERENCE_MAX)) return 1;
+
+	bme->reference_inv = bme280_prepare_altitude_reference(pressure);
+	return 0;
+}
+
+/****************************************************************************/
+/*      select compensation back end, not included one is replaced by int32 */
+/****************************************************************************/
+void BME280_Set_Backend(BME280 *bme, uint8_t backend)
+{
+	bme->backend = BME280_BACKEND_INT32;
+
+#if BME280_COMPENSATION_INT64
+	if (backend == BME280_BACKEND_INT64) bme->backend = backend;
+#endif
+#if BME280_COMPENSATION_FLOAT
+	if (backend == BME280_BACKEND_FLOAT) bme->backend = backend;
+#endif
+}
+
+/****************************************************************************/
+/*      set window sizes of averages and clear collected samples,	        */
+/*      window over No_OF_SAMPLES_MAX doesn't fit into buffers of context	*/
+/*      -> return 1 and windows aren't changed						        */
+/****************************************************************************/
+uint8_t BME280_Set_Average_Window(BME280 *bme, uint16_t temp, uint16_t pressure, uint16_t humidity)
+{
+	if ((temp > No_OF_SAMPLES_MAX) || (pressure > No_OF_SAMPLES_MAX) || (humidity > No_OF_SAMPLES_MAX)) return 1;
+
+#if CALCULATION_AVERAGE_TEMP
+	moving_avg_init(&bme->avg_temp, bme->smaples_of_temp, temp);
+#endif
+#if CALCULATION_AVERAGE_PRESSURE
+	moving_avg_init(&bme->avg_pressure, bme->smaples_of_pressure, pressure);
+#endif
+#if CALCULATION_AVERAGE_HUMIDITY
+	moving_avg_init(&bme->avg_humidity, bme->smaples_of_humidity, humidity);
+#endif
+	return 0;
+}
+
+/****************************************************************************/
+/*      switch context to normal mode with given standby time and filter,   */
+/*      registers are written by next BME280_Conf()					        */
+/****************************************************************************/
+void BME280_Set_Normal_Mode(BME280 *bme, uint8_t t_sb, uint8_t filter)
+{
+	bme->conf.mode		= BME280_NORMALMODE;
+	bme->conf.t_sb		= t_sb;
+	bme->conf.filter	= filter;
+}
+
+/****************************************************************************/
+/*      period of conversions in normal mode [us]					        */
+/****************************************************************************/
+uint32_t BME280_Cycle_Time_us(BME280 *bme)
+{
+	// t_standby for t_sb setting: 0.5, 62.5, 125, 250, 500, 1000, 10, 20 ms
+	static const uint32_t standby_us[8] = {500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000};
+
+	return bme280_compute_measure_time_us(typical_time, &bme->conf) + standby_us[bme->conf.t_sb];
+}
+
+/****************************************************************************/
+/*      setting function configurations of sensor,					        */
+/*      configuration is taken from bme->conf						        */
+/****************************************************************************/
+uint8_t BME280_Conf (BME280 *bme)
+{
+	CONF *sensor = &bme->conf;
+	uint8_t counter = 0;
+	uint8_t  result_of_check = 5;
+	uint8_t  result_of_calib;
+
+	if (!bme->reset_done)
 		{
-			soft_reset();				// make a reset to clear previous setting
-			current_time = source_time; // get system time
+			soft_reset(bme);				// make a reset to clear previous setting
+			bme->shadow.valid = 0;			// registers have reset values now
+			bme->calib_loaded = 0;			// NVM is copied into registers again
+			bme->reset_time = get_time_ms();	// get system time
+			bme->reset_done = 1;
 		}
 
-	if(source_time <= (current_time + 3) ) return 3;	//wait 3ms aster software reset
+	if((get_time_ms() - bme->reset_time) <= 3) return 3;	//wait 3ms aster software reset
 
 	do
 	{
-		result_of_check = read_compensation_parameter_write_configuration_and_check_it(sensor, bme);
+		result_of_calib = bme->calib_loaded ? 0 : read_compensation_parameter(bme);
+		result_of_check = write_configuration_and_check_it(sensor, bme);
+		if(!result_of_check) result_of_check = result_of_calib;
 		counter++;
 	}
 	while((result_of_check) && (counter < 3));
@@ -68,33 +260,23 @@ uint8_t BME280_Conf (CONF *sensor, BME280 *bme)
 	return result_of_check;	// if everything is OK return 0
 }
 
-
 /****************************************************************************/
-/*      read, check, calculate and prepare string for measured values       */
+/*      read back configuration registers and compare them with			*/
+/*      bme->conf, nothing is written (periodic verification)				*/
 /****************************************************************************/
-uint8_t BME280_ReadTPH(BME280 *bme)
+uint8_t BME280_Verify (BME280 *bme)
 {
-	#if USE_STRING
-		uint8_t len;
-	#endif
-
-	uint8_t temp[8];
-	uint8_t divisor;
-	int32_t var1, var2, var3, var4, var5, t_fine;
-	uint32_t p;
-	uint32_t humidity_max = 102400;
-    const int32_t temperature_min = -4000;
-    const int32_t temperature_max = 8500;
+	return check_configuration(&bme->conf, bme);
+}
 
-	var1    = 0;
-	var2    = 0;
-	p       = 0;
-	t_fine  = 0;
-	divisor = 0;
 
-	bme->adc_P = 0;
-	bme->adc_T = 0;
-	bme->adc_H = 0;
+/****************************************************************************/
+/*      read, check, calculate and prepare string for measured values,      */
+/*      in forced mode next measurement is started after reading            */
+/****************************************************************************/
+uint8_t BME280_ReadTPH(BME280 *bme)
+{
+	uint8_t result;
 
 	// ----- if occured some error during parameterization sensor don't do any measure -----
 	if(bme->err_conf) return 1;
@@ -108,72 +290,81 @@ uint8_t BME280_ReadTPH(BME280 *bme)
 
 #endif
 
-	BME280_read_data(BME280_ADDR, 0xF7, 8, (uint8_t *)&temp);	// read data register
+	BME280_read_data(bme, 0xF7, BME280_DATA_SIZE, bme->raw);	// read data register
 
-	bme->adc_P = (temp[0] << 12) | (temp[1] << 4) | (temp[2] >> 4);
-	bme->adc_T = (temp[3] << 12) | (temp[4] << 4) | (temp[5] >> 4);
-	bme->adc_H = (temp[6] << 8)  |  temp[7];
+	result = BME280_Calculate(bme);
+	if (result) return result;
 
+	// ----- measure and prepare values for the next reading -----
+	if(bme->conf.mode == BME280_FORCEDMODE) BME280_Trigger(bme);
 
-	// ----- check boundaries -----
-	check_boundaries(bme);
-
-	// ----- if raw values are lower or over the limits, function is intermittent and returning 3  -----
-	if ((bme->err_boundaries_T != 0) || ( bme->err_boundaries_P != 0) || ( bme->err_boundaries_H != 0)) return 3;
+	return 0;	// if everything is OK return 0
+}
 
-	/*-----------------------------------------------------------------------*/
-	/********************* calculate temperature *****************************/
-	/*-----------------------------------------------------------------------*/
+/****************************************************************************/
+/*      start forced measurement, return maximum conversion time [us]       */
+/****************************************************************************/
+uint32_t BME280_Trigger(BME280 *bme)
+{
+	const BME280_REG trigger = {0xF4, bme->conf.bt[1]};
 
-    var1 = (int32_t)((bme->adc_T / 8) - ((int32_t)bme->coef.dig_T1 * 2));
-    var1 = (var1 * ((int32_t)bme->coef.dig_T2)) / 2048;
-    var2 = (int32_t)((bme->adc_T / 16) - ((int32_t)bme->coef.dig_T1));
-    var2 = (((var2 * var2) / 4096) * ((int32_t)bme->coef.dig_T3)) / 16384;
-    t_fine = var1 + var2;
-    bme->temperature = (t_fine * 5 + 128) / 256;
+	BME280_write_registers(bme, &trigger, 1);
 
-    if (bme->temperature < temperature_min)
-    {
-    	bme->temperature = temperature_min;
-    }
-    else if (bme->temperature > temperature_max)
-    {
-    	bme->temperature = temperature_max;
-    }
+	return bme280_compute_measure_time_us(max_time, &bme->conf);
+}
 
-	if(my_abs(bme->temperature) > 9) 	divisor = 100;
-	else 								divisor = 10;
+/****************************************************************************/
+/*      check and calculate values from bme->raw, strings are prepared		*/
+/*      later, on demand, by BME280_Temp_Str/Pressure_Str/Humi_Str			*/
+/****************************************************************************/
+uint8_t BME280_Calculate(BME280 *bme)
+{
+	int32_t adc_T, adc_P, adc_H;
+	uint32_t abs_value, integer;
+	uint8_t div_by_zero;
+	BME280_TPH tph;
+	PROFILE_BEGIN(calculate_start);
 
+	bme280_unpack_raw(bme->raw, &adc_T, &adc_P, &adc_H);
+	bme->data_ready = 0;
 
-	bme->t1 = (int32_t)bme->temperature / (int8_t)divisor;
-	bme->t2 = my_abs((uint32_t)bme->temperature % (uint8_t)divisor);
+	bme->adc_T = adc_T;
+	bme->adc_P = (uint32_t)adc_P;
+	bme->adc_H = (uint32_t)adc_H;
 
-	// ----- prepare string with value of temperature -----
-#if USE_STRING
 
-	#if CALCULATION_AVERAGE_TEMP
+	// ----- check boundaries -----
+	PROFILE_BEGIN(stage_start);
+	check_boundaries(bme);
+	PROFILE_END(PROFILE_BOUNDARIES, stage_start);
 
+	// ----- if raw values are lower or over the limits, function is intermittent and returning 3  -----
+	if ((bme->err_boundaries_T != 0) || ( bme->err_boundaries_P != 0) || ( bme->err_boundaries_H != 0)) return 3;
 
-		// ----- calculation of average temperature -----
-		calculation_average_temp(bme);
+	/*-----------------------------------------------------------------------*/
+	/********************* calculate temperature *****************************/
+	/*-----------------------------------------------------------------------*/
 
-		itoa(bme->avearage_temp_cel, &bme->temp2str[0], 10);
-		len = strlen(bme->temp2str);
-		bme->temp2str[len++] = ',';
+	div_by_zero = bme280_compensate(bme->backend, &bme->calib, adc_T, adc_P, adc_H, &tph);
 
-		if( bme->avearage_temp_fract < 10) bme->temp2str[len++] = '0';
-		itoa(bme->avearage_temp_fract, &bme->temp2str[len++],10);
+	bme->temperature = tph.temperature;
 
-	#else
+	// ----- split into integer and fractional part (reciprocal multiplication, no division) -----
+	abs_value = my_abs(bme->temperature);
+	integer = udiv100(abs_value);
 
-		itoa(bme->t1, &bme->temp2str[0], 10);
-		len = strlen(bme->temp2str);
-		bme->temp2str[len++] = ',';
+	bme->t1 = (bme->temperature < 0) ? -(int32_t)integer : (int32_t)integer;
+	bme->t2 = abs_value - integer * 100;
 
-		if( bme->t2 < 10) bme->temp2str[len++] = '0';
-		itoa(bme->t2, &bme->temp2str[len++],10);
-	#endif
+#if USE_STRING
+	bme->str_valid = 0;		// strings are formatted on demand from new values
+#endif
 
+#if CALCULATION_AVERAGE_TEMP
+	// ----- calculation of average temperature -----
+	PROFILE_RESTART(stage_start);
+	calculation_average_temp(bme);
+	PROFILE_END(PROFILE_AVERAGE, stage_start);
 #endif
 
 	/*-----------------------------------------------------------------------*/
@@ -181,134 +372,118 @@ uint8_t BME280_ReadTPH(BME280 *bme)
 	/*-----------------------------------------------------------------------*/
 
 	bme->compensate_status = 0;
-	var1 = 0;
-	var2 = 0;
-	p 	 = 0;
-
-	var1 = (((int32_t)t_fine) >> 1) - (int32_t)64000;
-	var2 = (((var1 >> 2) * (var1 >> 2)) >> 11 ) * ((int32_t)bme->coef.dig_P6);
-	var2 = var2 + ((var1 * ((int32_t)bme->coef.dig_P5)) << 1);
-	var2 = (var2 >> 2) + (((int32_t)bme->coef.dig_P4) << 16);
-	var1 = (((bme->coef.dig_P3 * (((var1 >> 2) * (var1 >> 2)) >> 13 )) >> 3) + ((((int32_t)bme->coef.dig_P2) * var1) >> 1)) >> 18;
-	var1 =((((32768 + var1)) * ((int32_t)bme->coef.dig_P1)) >> 15);
-
-	if (var1 == 0) //if dividing by 0, function is intermittent and returning 4
+
+	if (div_by_zero) //if dividing by 0, function is intermittent and returning 4
 	{
 		bme->compensate_status = 1;
 		return 4;
 	}
 
-	p = (((uint32_t)(((int32_t)1048576) - bme->adc_P) - (var2 >> 12))) * 3125;
-
-	if (p < 0x80000000) p = (p << 1) / ((uint32_t)var1);
-	else				p = (p / (uint32_t)var1) * 2;
-
-
-	var1 = (((int32_t)bme->coef.dig_P9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
-	var2 = (((int32_t)(p >> 2)) * ((int32_t)bme->coef.dig_P8)) >> 13;
-	p = (uint32_t)((int32_t)p + ((var1 + var2 + bme->coef.dig_P7) >> 4));
-
-
-	bme->preasure = (uint32_t)p;
+	bme->pressure_fine = tph.pressure;
+	bme->preasure = tph.pressure >> 8;
 	bme->p1 =  (int32_t)bme->preasure;
 
-	// ----- prepare string with value of pressure -----
-#if USE_STRING
-	if ((bme->p1/100) < 1000)
-	{
-		bme->pressure2str[0] = ' ';
-		itoa(bme->p1/100, &bme->pressure2str[1],10);
-	}
-	else
-	{
-		itoa(bme->p1/100, &bme->pressure2str[0],10);
-	}
-
-	bme->pressure2str[4] = ',';
-	itoa(bme->p1%100, &bme->pressure2str[5],10);
-
+#if CALCULATION_AVERAGE_PRESSURE
+	// ----- calculation of average pressure -----
+	PROFILE_RESTART(stage_start);
+	calculation_average_pressure(bme);
+	PROFILE_END(PROFILE_AVERAGE, stage_start);
 #endif
 
 	/*-----------------------------------------------------------------------*/
 	/********************* calculate humidity ********************************/
 	/*-----------------------------------------------------------------------*/
 
-	var1    = 0;
-	var2    = 0;
-	var3    = 0;
-	var4    = 0;
-	var5    = 0;
-
-	var1 = t_fine - ((int32_t)76800);
-	var2 = (int32_t)(bme->adc_H * 16384);
-	var3 = (int32_t)(((int32_t)bme->coef.dig_H4) * 1048576);
-	var4 = ((int32_t)bme->coef.dig_H5) * var1;
-	var5 = (((var2 - var3) - var4) + (int32_t)16384) / 32768;
-	var2 = (var1 * ((int32_t)bme->coef.dig_H6)) / 1024;
-	var3 = (var1 * ((int32_t)bme->coef.dig_H3)) / 2048;
-	var4 = ((var2 * (var3 + (int32_t)32768)) / 1024) + (int32_t)2097152;
-	var2 = ((var4 * ((int32_t)bme->coef.dig_H2)) + 8192) / 16384;
-	var3 = var5 * var2;
-	var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
-	var5 = var3 - ((var4 * ((int32_t)bme->coef.dig_H1)) / 16);
-	var5 = (var5 < 0 ? 0 : var5);
-	var5 = (var5 > 419430400 ? 419430400 : var5);
-	bme->humidity = (uint32_t)(var5 / 4096);
-
-	if (bme->humidity > humidity_max)
-	{
-		bme->humidity = humidity_max;
-	}
+	bme->humidity = tph.humidity;
 
 	bme->humidity *= 100;
-	bme->humidity /= 1024;
-
+	bme->humidity >>= 10;			// humidity isn't negative, x 100 / 1024
 
-	if(my_abs(bme->humidity/100) > 9) 	divisor = 100;
-	else 								divisor = 10;
+	integer = udiv100(bme->humidity);
 
+	bme->h1 = integer;
+	bme->h2 = bme->humidity - integer * 100;
 
-	bme->h1 = (int32_t)bme->humidity / (int8_t)divisor;
-	bme->h2 = my_abs((uint32_t)bme->humidity % (uint8_t)divisor);
-
-	// ----- prepare string with value of humidity -----
-#if USE_STRING
-
-	#if CALCULATION_AVERAGE_HUMIDITY
+#if CALCULATION_AVERAGE_HUMIDITY
+	// ----- calculation of average humidity -----
+	PROFILE_RESTART(stage_start);
+	calculation_average_humidity(bme);
+	PROFILE_END(PROFILE_AVERAGE, stage_start);
+#endif
 
-		// ----- calculation of average humidity -----
-		calculation_average_humidity(bme);
+	// ----- calculate a preasure sea level -----
+	PROFILE_RESTART(stage_start);
+	bme->sea_pressure_redu = bme280_sea_level_pressure(bme->sea_factor, bme->temperature, bme->preasure);
+	PROFILE_END(PROFILE_SEA_LEVEL, stage_start);
 
-		itoa(bme->avearage_humidity_cel, &bme->humi2str[0], 10);
-		len = strlen(bme->humi2str);
-		bme->humi2str[len++] = ',';
+	// ----- calculate altitude against reference pressure -----
+	PROFILE_RESTART(stage_start);
+	bme->altitude = bme280_altitude(bme->reference_inv, bme->pressure_fine);
+	PROFILE_END(PROFILE_ALTITUDE, stage_start);
 
-		if( bme->avearage_humidity_fract < 10) bme->humi2str[len++] = '0';
-		itoa(bme->avearage_humidity_fract, &bme->humi2str[len++],10);
+	PROFILE_END(PROFILE_CALCULATE, calculate_start);
+	return 0;	// if everything is OK return 0
+}
 
-	#else
+#if USE_STRING
+/****************************************************************************/
+/*      temperature as string, formatted at first call after new sample		*/
+/*      (average if CALCULATION_AVERAGE_TEMP) and cached up to next one		*/
+/****************************************************************************/
+const char *BME280_Temp_Str(BME280 *bme)
+{
+	if (!(bme->str_valid & BME280_STR_TEMP))
+	{
+		PROFILE_BEGIN(string_start);
+#if CALCULATION_AVERAGE_TEMP
+		FORMAT_Fixed2(bme->temp2str, bme->avearage_temp, 0);
+#else
+		FORMAT_Fixed2(bme->temp2str, bme->temperature, 0);
+#endif
+		PROFILE_END(PROFILE_STRING, string_start);
+		bme->str_valid |= BME280_STR_TEMP;
+	}
 
-		itoa(bme->h1, &bme->humi2str[0], 10);
-		len = strlen(bme->humi2str);
-		bme->humi2str[len++] = ',';
+	return bme->temp2str;
+}
 
-		if( bme->h2 < 10) bme->humi2str[len++] = '0';
-		itoa(bme->h2, &bme->humi2str[len++],10);
-	#endif
+/****************************************************************************/
+/*      pressure [hPa] as string, formatted at first call after new sample	*/
+/****************************************************************************/
+const char *BME280_Pressure_Str(BME280 *bme)
+{
+	if (!(bme->str_valid & BME280_STR_PRESSURE))
+	{
+		PROFILE_BEGIN(string_start);
+		FORMAT_Fixed2(bme->pressure2str, bme->p1, BME280_PRESSURE_STR_SIZE - 1);		// Pa = hPa x 0,01
+		PROFILE_END(PROFILE_STRING, string_start);
+		bme->str_valid |= BME280_STR_PRESSURE;
+	}
 
-#endif
+	return bme->pressure2str;
+}
 
-	// ----- measure and prepare values for the next reading -----
-	if(conf_BME280.mode == BME280_FORCEDMODE)
+/****************************************************************************/
+/*      humidity as string, formatted at first call after new sample		*/
+/*      (average if CALCULATION_AVERAGE_HUMIDITY) and cached up to next one	*/
+/****************************************************************************/
+const char *BME280_Humi_Str(BME280 *bme)
+{
+	if (!(bme->str_valid & BME280_STR_HUMIDITY))
 	{
-		BME280_write_data(BME280_ADDR, 0xF4, 1, &conf_BME280.bt[1]);		// write configurations bytes
+		PROFILE_BEGIN(string_start);
+#if CALCULATION_AVERAGE_HUMIDITY
+		FORMAT_Fixed2(bme->humi2str, bme->avearage_humidity, 0);
+#else
+		FORMAT_Fixed2(bme->humi2str, bme->humidity, 0);
+#endif
+		PROFILE_END(PROFILE_STRING, string_start);
+		bme->str_valid |= BME280_STR_HUMIDITY;
 	}
 
-	// ----- calculate a preasure sea level -----
-	pressure_at_sea_level(bme);
-
-	return 0;	// if everything is OK return 0
+	return bme->humi2str;
 }
+#endif
 
 /****************************************************************************/
 /*      check if read uncompensated values are in boundary MIN and MAX      */
@@ -335,13 +510,13 @@ void check_boundaries (BME280 *bme)
 /****************************************************************************/
 void get_status (BME280 *bme)
 {
-	uint8_t *status = 0;
+	uint8_t status = 0;
 
-	BME280_read_data(BME280_ADDR, 0xF3, 1, status);	// read set register
+	BME280_read_data(bme, 0xF3, 1, &status);	// read set register
 
 
-	bme->measuring_staus =  *status & BMP280_MEASURING_STATUS;
-	bme->im_update_staus =  *status & BMP280_IM_UPDATE_STATUS;
+	bme->measuring_staus =  status & BMP280_MEASURING_STATUS;
+	bme->im_update_staus =  status & BMP280_IM_UPDATE_STATUS;
 }
 
 /****************************************************************************/
@@ -349,18 +524,33 @@ void get_status (BME280 *bme)
 /****************************************************************************/
 uint8_t bme280_compute_measure_time(MEASUREMENT_TIME type, CONF *sensor)
 {
+	uint32_t mesas_time = bme280_compute_measure_time_us(type, sensor);
+
+	mesas_time += 500;	// Increment the value to next highest integer if greater than 0.5
+	mesas_time /= 1000;	// Convert to milliseconds
+
+    return mesas_time;
+}
+
+/****************************************************************************/
+/*      measurement time in microseconds for the active configuration       */
+/****************************************************************************/
+uint32_t bme280_compute_measure_time_us(MEASUREMENT_TIME type, CONF *sensor)
+{
+	// number of samples for oversampling setting: skipped, x1, x2, x4, x8, x16 (codes 6, 7 are also x16)
+	static const uint8_t samples[8] = {0, 1, 2, 4, 8, 16, 16, 16};
 
 	uint32_t t_dur = 0, p_dur = 0, h_dur = 0, mesas_time = 0;
 
 	if (type == typical_time)
 	{
-		if( sensor->osrs_t != BME280_SKIPPED) t_dur = 2000 * (uint8_t)sensor->osrs_t;
+		if( sensor->osrs_t != BME280_SKIPPED) t_dur = 2000 * samples[sensor->osrs_t];
 		else 								  t_dur = 0;
 
-		if( sensor->osrs_p != BME280_SKIPPED) p_dur = 2000 * (uint8_t)sensor->osrs_p + 500;
+		if( sensor->osrs_p != BME280_SKIPPED) p_dur = 2000 * samples[sensor->osrs_p] + 500;
 		else 								  p_dur = 0;
 
-		if( sensor->osrs_h != BME280_SKIPPED) h_dur = 2000 * (uint8_t)sensor->osrs_h + 500;
+		if( sensor->osrs_h != BME280_SKIPPED) h_dur = 2000 * samples[sensor->osrs_h] + 500;
 		else 								  h_dur = 0;
 
 		mesas_time = 1000 + t_dur + p_dur + h_dur;
@@ -369,188 +559,353 @@ uint8_t bme280_compute_measure_time(MEASUREMENT_TIME type, CONF *sensor)
 
 	if (type == max_time)
 	{
-		if( sensor->osrs_t != BME280_SKIPPED) t_dur = 2300 * (uint8_t)sensor->osrs_t;
+		if( sensor->osrs_t != BME280_SKIPPED) t_dur = 2300 * samples[sensor->osrs_t];
 		else 								  t_dur = 0;
 
-		if( sensor->osrs_p != BME280_SKIPPED) p_dur = 2300 * (uint8_t)sensor->osrs_p + 575;
+		if( sensor->osrs_p != BME280_SKIPPED) p_dur = 2300 * samples[sensor->osrs_p] + 575;
 		else 								  p_dur = 0;
 
-		if( sensor->osrs_h != BME280_SKIPPED) h_dur = 2300 * (uint8_t)sensor->osrs_h + 575;
+		if( sensor->osrs_h != BME280_SKIPPED) h_dur = 2300 * samples[sensor->osrs_h] + 575;
 		else 								  h_dur = 0;
 
 		mesas_time = 1250 * 1 + t_dur + p_dur + h_dur;
 
 	}
 
-	mesas_time += 500;	// Increment the value to next highest integer if greater than 0.5
-	mesas_time /= 1000;	// Convert to milliseconds
-
     return mesas_time;
 }
 
 /****************************************************************************/
-/*      calculating pressure reduced to sea level            				*/
+/*     write consecutive registers, starting from register_addr		        */
 /****************************************************************************/
-void pressure_at_sea_level(BME280 *bme){
+void BME280_write_data(BME280 *bme, uint8_t register_addr, uint8_t size, uint8_t *Data)
+{
+	BME280_REG regs[BME280_MAX_REG_WRITE];
+
+	if (size > BME280_MAX_REG_WRITE) return;
 
-        uint16_t st_baryczny,tpm,t_sr;
-        uint32_t p0,p_sr;
+	for (uint8_t i = 0; i < size; i++)
+	{
+		regs[i].reg   = register_addr++;
+		regs[i].value = Data[i];
+	}
 
-        st_baryczny = (800000 * (1000 + 4 * bme->temperature) / (bme->preasure));          		// calculation of the baric degree acc. to the pattern of the Babineta
-        p0 = bme->preasure + (100000 * BME280_ALTITUDE / (st_baryczny));              			// calculation of approximate sea level pressure
-        p_sr = (bme->preasure + p0) / 2;                     									// calculation of average pressure for layers between sea level and sensor
-        tpm = bme->temperature + ((6 * BME280_ALTITUDE) / 1000);                           		// calculation of average temperature for layer of air
-        t_sr = (bme->temperature + tpm) / 2;                                              		// calculation of average temperature for layer between sea level and sensor
-        st_baryczny = (800000 * (1000 + 4 * t_sr) / (p_sr));              						// calculation of more accurate value of baric degree
-        bme->sea_pressure_redu = bme->preasure + (100000 * BME280_ALTITUDE / (st_baryczny)); 	// calculation of more accurate value of pressure for sea level
+	BME280_write_registers(bme, regs, size);
 }
 
 /****************************************************************************/
-/*     in depend on selected protocol data are saved to sensor		        */
+/*     write list of (register, value) pairs in one bus transaction:		*/
+/*     one chip-select window for SPI, one START/STOP for I2C.				*/
+/*     ctrl_hum (0xF2) is written before config (0xF5) and ctrl_meas (0xF4)	*/
+/*     is written last, because ctrl_hum is applied only after ctrl_meas	*/
+/*     is written and ctrl_meas may start a measurement						*/
 /****************************************************************************/
-void BME280_write_data(uint8_t SLA, uint8_t register_addr, uint8_t size, uint8_t *Data)
+void BME280_write_registers(BME280 *bme, const BME280_REG *regs, uint8_t count)
 {
-#if BME280_I2C
+	BME280_REG ordered[BME280_MAX_REG_WRITE];
+	BME280_REG tmp;
+	uint8_t i, k;
 
-	int i;
-	  const uint8_t* buffer = (uint8_t*)Data;
+	if ((count == 0) || (count > BME280_MAX_REG_WRITE)) return;
 
-	  //select device
-	  I2C_ADDRES(SLA, register_addr);
+	// stable insertion sort by write rank, list is short
+	for (i = 0; i < count; i++)
+	{
+		tmp = regs[i];
+		for (k = i; (k > 0) && (register_write_rank(ordered[k-1].reg) > register_write_rank(tmp.reg)); k--)
+		{
+			ordered[k] = ordered[k-1];
+		}
+		ordered[k] = tmp;
+	}
 
-	  //sending data from whole buffer
-	  for (i = 0; i < size; i++)
-	  {
-	   I2C_SendData(I2C1, buffer[i]);
-	   while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED) != SUCCESS);
-	  }
-	  //STOP signal generating
-	  I2C_GenerateSTOP(I2C1, ENABLE);
+	bme->transport->write(bme, ordered, count);
+}
 
-#endif
+/****************************************************************************/
+/*     order in which registers are written in one transaction		        */
+/****************************************************************************/
+static uint8_t register_write_rank(uint8_t reg)
+{
+	switch (reg)
+	{
+	case 0xF2:	return 0;	// ctrl_hum
+	case 0xF4:	return 2;	// ctrl_meas
+	default:	return 1;	// config and others
+	}
+}
+
+/****************************************************************************/
+/*      data are read by transport selected for sensor				        */
+/****************************************************************************/
+void BME280_read_data(BME280 *bme, uint8_t register_addr,  uint8_t size, uint8_t *Data)
+{
+	bme->transport->read(bme, register_addr, size, Data);
+}
 
+/****************************************************************************/
+/*      start reading data without waiting, callback is called from 		*/
+/*      interrupt when data are in Data buffer, return 1 if bus is busy		*/
+/****************************************************************************/
+uint8_t BME280_read_data_async(BME280 *bme, uint8_t register_addr, uint8_t size, uint8_t *Data, void (*callback)(void))
+{
+	if (bme->transport->read_async)
+		return bme->transport->read_async(bme, register_addr, size, Data, callback);
+
+	bme->transport->read(bme, register_addr, size, Data);		// data are ready immediately
+	if (callback) callback();
+	return 0;
+}
+
+/****************************************************************************/
+/*      SPI transport												        */
+/****************************************************************************/
 #if BME280_SPI
-//	SPI_SendData(register_addr, Data, size);
+static void spi_read(BME280 *bme, uint8_t register_addr, uint8_t size, uint8_t *Data)
+{
+#if BME280_SPI_DMA
 
-	const uint8_t register_mask = 0x7F;
-	uint8_t data;
+	while (BME280_read_data_DMA(bme, register_addr, size, Data, 0) == 1);	// wait if previous transfer isn't finished
+	while (SPI_DMA_Busy());
 
-	SELECT();
+#else
+//	SPI_ReceiveData(register_addr, Data, size );
+
+	SPI_Select(bme->cs_port, bme->cs_pin);
+
+	while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_TXE) == RESET);
+	SPI_I2S_SendData(SPI1, register_addr);
+	while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_RXNE) == RESET);
+	SPI_I2S_ReceiveData(SPI1);
 
 	for (uint8_t i = 0; i < size; i++)
 	{
-		data = Data[i];
 		while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_TXE) == RESET);
-		SPI_I2S_SendData(SPI1, register_mask & register_addr);
+		SPI_I2S_SendData(SPI1, 0);
+		while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_RXNE) == RESET);
+		Data[i] = SPI_I2S_ReceiveData(SPI1);
+	}
 
+	SPI_Deselect(bme->cs_port, bme->cs_pin);
+#endif
+}
+
+static void spi_write(BME280 *bme, const BME280_REG *regs, uint8_t count)
+{
+	const uint8_t register_mask = 0x7F;
+	uint8_t i;
+
+#if BME280_SPI_DMA
+
+	uint8_t tx[2 * BME280_MAX_REG_WRITE];
+
+	for (i = 0; i < count; i++)
+	{
+		tx[2*i]		= register_mask & regs[i].reg;
+		tx[2*i + 1] = regs[i].value;
+	}
+
+	while (SPI_DMA_Transfer(bme->cs_port, bme->cs_pin, tx, 2 * count, 0, 0, 0) == 1);	// wait if previous transfer isn't finished
+	while (SPI_DMA_Busy());
+
+#else
+
+	SPI_Select(bme->cs_port, bme->cs_pin);
+
+	for (i = 0; i < count; i++)
+	{
 		while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_TXE) == RESET);
-		SPI_I2S_SendData(SPI1, data);
+		SPI_I2S_SendData(SPI1, register_mask & regs[i].reg);
 
-		register_addr++;
+		while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_TXE) == RESET);
+		SPI_I2S_SendData(SPI1, regs[i].value);
 	}
 	while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_TXE) == RESET);
+	while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_BSY) == SET);
 
-	DESELECT();
+	SPI_Deselect(bme->cs_port, bme->cs_pin);
 #endif
-
 }
 
+static const BME280_TRANSPORT spi_transport = {
+	spi_read,
+	spi_write,
+#if BME280_SPI_DMA
+	BME280_read_data_DMA,
+#else
+	0,								// polled SPI: blocking read is used
+#endif
+};
+
 /****************************************************************************/
-/*      in depend on selected protocol data are readed from sensor	        */
+/*      start reading data by DMA, callback is called from interrupt		*/
+/*      when data are copied to Data buffer, return 1 if DMA is busy		*/
 /****************************************************************************/
-void BME280_read_data(uint8_t SLA, uint8_t register_addr,  uint8_t size, uint8_t *Data)
+#if BME280_SPI_DMA
+uint8_t BME280_read_data_DMA(BME280 *bme, uint8_t register_addr, uint8_t size, uint8_t *Data, void (*callback)(void))
 {
+	return SPI_DMA_Transfer(bme->cs_port, bme->cs_pin, &register_addr, 1, Data, size, callback);
+}
+#endif
+#endif
+
+/****************************************************************************/
+/*      I2C transport												        */
+/****************************************************************************/
 #if BME280_I2C
+static void (*volatile i2c_async_callback)(void);
 
-	  int i;
-	  uint8_t* buffer = (uint8_t*)Data;
-
-	  //select device
-	  I2C_ADDRES(SLA, register_addr);
-
-	  //START signal sending and waiting for response
-	  I2C_GenerateSTART(I2C1, ENABLE);
-	  while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT) != SUCCESS);
-
-	  //Receiving only one data byte and turn off ack signal
-	  I2C_AcknowledgeConfig(I2C1, ENABLE);
-	  //Device address sending, setting microcontroller as master in receive mode
-	  I2C_Send7bitAddress(I2C1, SLA, I2C_Direction_Receiver);
-	  //waitnig for EV6
-	  while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED) != SUCCESS);
-
-	  for (i = 0; i < size - 1; i++)
-	  {
-	   while(I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_RECEIVED) != SUCCESS);
-	   buffer[i] = I2C_ReceiveData(I2C1);
-	  }
-	  //Receiving only one byte
-	  I2C_AcknowledgeConfig(I2C1, DISABLE);
-
-	  //STOP signal generating
-	  I2C_GenerateSTOP(I2C1, ENABLE);
-	  //waiting for signal
-	  while(I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_RECEIVED) != SUCCESS);
-	  //reading data from receiving register
-	  buffer[i] = I2C_ReceiveData(I2C1);
-#endif
+static void i2c_read(BME280 *bme, uint8_t register_addr, uint8_t size, uint8_t *Data)
+{
+	I2C_READ(bme->SLA, register_addr, size, Data);
+}
 
+static void i2c_write(BME280 *bme, const BME280_REG *regs, uint8_t count)
+{
+	// register address of the first pair is sent by I2C_WRITE, next pairs follow data byte
+	uint8_t data[2 * BME280_MAX_REG_WRITE - 1];
 
-#if BME280_SPI
-//	SPI_ReceiveData(register_addr, Data, size );
+	data[0] = regs[0].value;
+	for (uint8_t i = 1; i < count; i++)
+	{
+		data[2*i - 1] = regs[i].reg;
+		data[2*i]	  = regs[i].value;
+	}
+
+	I2C_WRITE(bme->SLA, regs[0].reg, 2 * count - 1, data);
+}
 
-	SELECT();
+static void i2c_async_done(I2C_STATUS status)
+{
+	void (*callback)(void) = i2c_async_callback;
 
-	while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_TXE) == RESET);
-	SPI_I2S_SendData(SPI1, register_addr);
-	while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_RXNE) == RESET);
-	SPI_I2S_ReceiveData(SPI1);
+	i2c_async_callback = 0;
+	if (callback) callback();
+}
 
-	for (uint8_t i = 0; i < size; i++)
+static uint8_t i2c_read_async(BME280 *bme, uint8_t register_addr, uint8_t size, uint8_t *Data, void (*callback)(void))
+{
+	if (i2c_async_callback) return 1;
+
+	i2c_async_callback = callback;
+	if (I2C_READ_IT(bme->SLA, register_addr, size, Data, i2c_async_done) != i2c_ok)
 	{
-		while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_TXE) == RESET);
-		SPI_I2S_SendData(SPI1, 0);
-		while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_RXNE) == RESET);
-		Data[i] = SPI_I2S_ReceiveData(SPI1);
+		i2c_async_callback = 0;
+		return 1;
 	}
+	return 0;
+}
 
-	DESELECT();
+static const BME280_TRANSPORT i2c_transport = {
+	i2c_read,
+	i2c_write,
+	i2c_read_async,
+};
 #endif
-}
 
 /****************************************************************************/
 /*      execute sensor reset by software							        */
 /****************************************************************************/
-void soft_reset (void)
+void soft_reset (BME280 *bme)
 {
-	BME280_write_data(BME280_ADDR, 0xE0, 1, (uint8_t*)BME280_SOFTWARE_RESET);		// write configurations bytes
+	const BME280_REG reset = {0xE0, BME280_SOFTWARE_RESET};
+	BME280_write_registers(bme, &reset, 1);
 }
 
 /****************************************************************************/
-/*     write configuration and check if saved configuration is equal to set */
+/*     unpack raw calibration bytes into compensation parameters			*/
+/****************************************************************************/
+void decode_compensation_parameters(const uint8_t *calib, TCOEF *coef)
+{
+	const CALIB_FIELD *field;
+	const uint8_t *raw;
+	uint8_t *dst;
+	int16_t value;
+
+	memset(coef, 0, sizeof(TCOEF));
+
+	for (field = calib_fields; field < &calib_fields[sizeof(calib_fields) / sizeof(calib_fields[0])]; field++)
+	{
+		raw = &calib[field->index];
+		dst = (uint8_t *)coef + field->offset;
+
+		switch (field->type)
+		{
+		case calib_u8:
+		case calib_s8:
+			*dst = raw[0];
+			break;
+
+		case calib_h4:
+			value = ((int16_t)(int8_t)raw[0] * 16) | (raw[1] & 0x0F);
+			*(int16_t *)dst = value;
+			break;
+
+		case calib_h5:
+			value = ((int16_t)(int8_t)raw[1] * 16) | (raw[0] >> 4);
+			*(int16_t *)dst = value;
+			break;
+
+		default:	// calib_u16, calib_s16 -> LSB first
+			*(uint16_t *)dst = ((uint16_t)raw[1] << 8) | raw[0];
+			break;
+		}
+	}
+}
+
+/****************************************************************************/
+/*     write only registers which are different from shadow copy,			*/
+/*     return number of written registers									*/
+/****************************************************************************/
+static uint8_t write_configuration(CONF *sensor, BME280 *bme)
+{
+	static const uint8_t addr[3] = {0xF2, 0xF4, 0xF5};	// index is the same as in CONF.bt table
+	BME280_REG regs[3];
+	uint8_t i;
+	uint8_t count = 0;
+
+	for (i = 0; i < 3; i++)
+	{
+		// ctrl_hum is applied by sensor only after writing ctrl_meas, so ctrl_meas is written as well
+		if (bme->shadow.valid && (bme->shadow.reg[i] == sensor->bt[i]) && !((i == 1) && count))
+		{
+			bme->shadow.hits++;
+			continue;
+		}
+
+		regs[count].reg   = addr[i];
+		regs[count].value = sensor->bt[i];
+		count++;
+
+		bme->shadow.reg[i] = sensor->bt[i];
+		bme->shadow.misses++;
+	}
+
+	if (count) BME280_write_registers(bme, regs, count);
+
+	bme->shadow.valid = 1;
+
+	return count;
+}
+
+/****************************************************************************/
+/*     read configuration registers and compare them with set values		*/
 /****************************************************************************/
-uint8_t read_compensation_parameter_write_configuration_and_check_it (CONF *sensor, BME280 *bme)
+static uint8_t check_configuration(CONF *sensor, BME280 *bme)
 {
 	uint8_t buf[3];
 	uint8_t i;
 	uint8_t bt_temp[3];
-	uint8_t temp_humidity[7];
+	uint8_t regs[4];
 
-	BME280_write_data(BME280_ADDR, 0xF2,  1, &sensor->bt[0]);		// write configurations byte for ctrl_hum
-	BME280_write_data(BME280_ADDR, 0xF4,  2, &sensor->bt[1]);		// write configurations bytes
-	BME280_read_data(BME280_ADDR,  0xF2,  1, &buf[0]);				// read set registers
-	BME280_read_data(BME280_ADDR,  0xF4,  2, &buf[1]);				// read set registers
-	BME280_read_data(BME280_ADDR,  0x88, 24, bme->coef.bt);			// read compensation parameters: 0x88 -> 0x9F
-	BME280_read_data(BME280_ADDR,  0xA1,  1, &bme->coef.bt[24]);	// read compensation parameters: 0xA1
+	BME280_read_data(bme,  0xF2,  4, &regs[0]);				// read set registers 0xF2 -> 0xF5 (0xF3 is status register)
 
-	BME280_read_data(BME280_ADDR,  0xE1,  7, &temp_humidity[0]);	// read compensation parameters: 0xE1 -> 0xE2
-
-	bme->coef.dig_H2 = ((uint16_t)temp_humidity[1] << 8 ) | (uint16_t)temp_humidity[0];
-	bme->coef.dig_H3 = temp_humidity[2];
-	bme->coef.dig_H4 = ((uint16_t)temp_humidity[3] << 4) | ((uint16_t)temp_humidity[4] & 0x0F);
-	bme->coef.dig_H5 = ((uint16_t)temp_humidity[5] << 4) | ((uint16_t)temp_humidity[4] >> 4);
-	bme->coef.dig_H6 = temp_humidity[6];
+	buf[0] = regs[0];
+	buf[1] = regs[2];
+	buf[2] = regs[3];
 
+	bme->shadow.last_verify = get_time_ms();
+	bme->shadow.valid = 0;		// in case of error all registers are written again
 
 	// ----- check if set configuration registers are that same as readed -----
 	if(sensor->mode == BME280_FORCEDMODE)   /* sometimes hapend, that sensor go to sleep mode after single measurement was finished
@@ -570,7 +925,7 @@ uint8_t read_compensation_parameter_write_configuration_and_check_it (CONF *sens
 			if(buf[i] != bt_temp[i])
 			{
 				if(bme->err_conf == calib_reg) 	bme->err_conf = both;
-				else
+				else 							bme->err_conf = config_reg;
 				return 2;
 			}
 		}
@@ -588,6 +943,28 @@ uint8_t read_compensation_parameter_write_configuration_and_check_it (CONF *sens
 		}
 	}
 
+	bme->shadow.valid = 1;
+
+	return 0;
+}
+
+/****************************************************************************/
+/*     read compensation parameters, they change only by NVM copy after	*/
+/*     reset, so they are read once after reset or after failed check		*/
+/****************************************************************************/
+static uint8_t read_compensation_parameter(BME280 *bme)
+{
+	uint8_t i;
+	uint8_t calib[BME280_CALIB_SIZE];
+	uint32_t start_time;
+
+	start_time = get_time_us();
+	BME280_read_data(bme,  0x88, BME280_CALIB1_SIZE, &calib[0]);					// read compensation parameters: 0x88 -> 0xA1
+	BME280_read_data(bme,  0xE1, BME280_CALIB2_SIZE, &calib[BME280_CALIB1_SIZE]);	// read compensation parameters: 0xE1 -> 0xE7
+	bme->calib_read_time = get_time_us() - start_time;
+
+	decode_compensation_parameters(calib, &bme->coef);
+	bme280_prepare_calibration(&bme->coef, &bme->calib);
 
 	// ----- check if pressure and temperature calibration coefficients are diferent from 0 -----
 	// ----- coefficients of humidity can contain 0 value so that aren't checked -----
@@ -600,93 +977,70 @@ uint8_t read_compensation_parameter_write_configuration_and_check_it (CONF *sens
 		}
 	}
 
+	bme->calib_loaded = 1;
 
 	return 0;
 }
 
 /****************************************************************************/
-/*     Calculate average temperature,										*/
-/* 	   No of samples to calculations is taken from No_OF_SAMPLES 			*/
+/*     write configuration and check if saved configuration is equal to set */
 /****************************************************************************/
-#if CALCULATION_AVERAGE_TEMP
-	void calculation_average_temp(BME280 *bme)
-	{
-		int32_t avearage_temp_value = 0;
-		static uint8_t i = 1;
-		uint8_t k;
-		uint8_t avearage_fract_temp;
+uint8_t write_configuration_and_check_it (CONF *sensor, BME280 *bme)
+{
+	uint8_t written;
 
-		if(i <= No_OF_SAMPLES)
-		{
-			if(bme->t1 >= 0) bme->smaples_of_temp[i-1] = 100 * bme->t1 + bme->t2;
-			else 			 bme->smaples_of_temp[i-1] = -1 * (100 * my_abs(bme->t1) + bme->t2);
-		}
-		else
-		{
-			for (k = 1; k < i - 1; k++)
-			{
-				bme->smaples_of_temp[k-1] = bme->smaples_of_temp[k];
-			}
+	written = write_configuration(sensor, bme);						// only changed registers are sent
 
-			if(bme->t1 >= 0) bme->smaples_of_temp[--k] = 100 * bme->t1 + bme->t2;
-			else 			 bme->smaples_of_temp[--k] = -1 * (100 * my_abs(bme->t1) + bme->t2);
-		}
+	// ----- readback is needed only after write or when verification period passed -----
+	if (written || ((get_time_ms() - bme->shadow.last_verify) >= BME280_VERIFY_PERIOD))
+		return check_configuration(sensor, bme);
 
-		for (k = 0; k < i - 1; k++)
-		{
-			avearage_temp_value += bme->smaples_of_temp[k];
-		}
+	return 0;
+}
 
-		avearage_temp_value /= (i - 1);
+/****************************************************************************/
+/*     Calculate average temperature in running window						*/
+/****************************************************************************/
+#if CALCULATION_AVERAGE_TEMP
+	void calculation_average_temp(BME280 *bme)
+	{
+		int32_t avearage_temp_value;
 
-		bme->avearage_temp_cel = avearage_temp_value / 100 ;
-		avearage_fract_temp = (my_abs(avearage_temp_value)) % 100;
-		bme->avearage_temp_fract = avearage_fract_temp;
+		avearage_temp_value = moving_avg_update(&bme->avg_temp, bme->temperature);
+		bme->avearage_temp = avearage_temp_value;
 
-		if( i <= No_OF_SAMPLES) i++;
+		uint32_t abs_value = my_abs(avearage_temp_value);
+		uint32_t integer = udiv100(abs_value);
+
+		bme->avearage_temp_cel = (avearage_temp_value < 0) ? -(int32_t)integer : (int32_t)integer;
+		bme->avearage_temp_fract = abs_value - integer * 100;
 	}
 #endif
 
-	/****************************************************************************/
-	/*     Calculate average humidity,										*/
-	/* 	   No of samples to calculations is taken from No_OF_SAMPLES 			*/
-	/****************************************************************************/
-	#if CALCULATION_AVERAGE_HUMIDITY
-		void calculation_average_humidity(BME280 *bme)
-		{
-			uint32_t avearage_humidity_value = 0;
-			static uint8_t i = 1;
-			uint8_t k;
-			uint8_t avearage_fract_humidity;
-
-			if(i <= No_OF_SAMPLES)
-			{
-				bme->smaples_of_humidity[i-1] = 100 * bme->h1 + bme->h2;
-
-			}
-			else
-			{
-				for (k = 1; k < i - 1; k++)
-				{
-					bme->smaples_of_humidity[k-1] = bme->smaples_of_humidity[k];
-				}
-
-				bme->smaples_of_humidity[--k] = 100 * bme->h1 + bme->h2;
-			}
-
-			for (k = 0; k < i - 1; k++)
-			{
-				avearage_humidity_value += bme->smaples_of_humidity[k];
-			}
-
-			avearage_humidity_value /= (i - 1);
+/****************************************************************************/
+/*     Calculate average pressure in running window							*/
+/****************************************************************************/
+#if CALCULATION_AVERAGE_PRESSURE
+	void calculation_average_pressure(BME280 *bme)
+	{
+		bme->avearage_pressure = moving_avg_update(&bme->avg_pressure, bme->preasure);
+	}
+#endif
 
-			bme->avearage_humidity_cel = avearage_humidity_value / 100 ;
-			avearage_fract_humidity = (my_abs(avearage_humidity_value)) % 100;
-			bme->avearage_humidity_fract = avearage_fract_humidity;
+/****************************************************************************/
+/*     Calculate average humidity in running window							*/
+/****************************************************************************/
+#if CALCULATION_AVERAGE_HUMIDITY
+	void calculation_average_humidity(BME280 *bme)
+	{
+		int32_t avearage_humidity_value;
 
-			if( i <= No_OF_SAMPLES) i++;
-		}
-	#endif
+		avearage_humidity_value = moving_avg_update(&bme->avg_humidity, bme->humidity);
+		bme->avearage_humidity = avearage_humidity_value;
 
+		uint32_t integer = udiv100(avearage_humidity_value);		// humidity isn't negative
 
+		bme->avearage_humidity_cel = integer;
+		bme->avearage_humidity_fract = avearage_humidity_value - integer * 100;
+	}
+#endif
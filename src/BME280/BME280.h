@@ -9,16 +9,34 @@
 #define BME280_BME280_H_
 
 #include "stm32f10x.h"
-#include "../SPI/SPI.h"
-#include "../I2C/I2C.h"
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include "../COMMON/common_var.h"
+#include "../FILTER/FILTER.h"
+#include "../FORMAT/FORMAT.h"
+#include "../PROFILE/PROFILE.h"
 
 // --------------------------------------------------------- //
-//select communication protocol
+//select communication protocol (can be given also by compiler options, e.g. host tests)
+#ifndef BME280_SPI
 #define BME280_SPI 1
+#endif
+#ifndef BME280_I2C
 #define BME280_I2C 0
+#endif
+
+#if BME280_SPI
+#define BME280_SPI_DMA 1	// SPI1 transfers are executed by DMA1 channel 2 (Rx) and channel 3 (Tx)
+#endif
+
+#ifndef BME280_USE_SIM
+#define BME280_USE_SIM 0	// sensor is replaced by simulated register map (BME280_sim.c), no bus is used
+#endif
+
+// protocol headers are included after selection, so they can see the settings above
+#include "../SPI/SPI.h"
+#include "../I2C/I2C.h"
 
 // --------------------------------------------------------- //
 #define USE_STRING 1				// allow for preparing of string with temperature and pressure values
@@ -26,8 +44,40 @@
 #define BME280_ALTITUDE 	205 	// current sensor altitude above sea level at the measurement site [m]
 
 // --------------------------------------------------------- //
-#define BME280_ADDR 		0xEC	// Sensor addres -> SDO pin is connected to GND
-//#define BME280_ADDR 		0xEE	// Sensor addres -> SDO pin is connected to VCC
+// pressure reduced to sea level: factor p0/p of Babinet formula is computed for the altitude
+// once, in table over temperature, every sample only interpolates it and multiplies pressure
+#define BME280_SEA_T_MIN		-4000	// temperature of first entry [x 0,01 degree]
+#define BME280_SEA_T_SHIFT		9		// step of table is 2^9 x 0,01 degree = 5,12 degree
+#define BME280_SEA_TABLE_SIZE	26		// covers -40 .. 88 degree
+
+// --------------------------------------------------------- //
+// altitude computed from pressure (international barometric formula) against reference pressure,
+// BME280_Set_Reference_Pressure() changes it at runtime (e.g. local QNH) within operating range of sensor
+#define BME280_REFERENCE_PRESSURE	101325	// default reference pressure [Pa]
+#define BME280_REFERENCE_MIN		30000	// range of reference pressure [Pa]
+#define BME280_REFERENCE_MAX		110000
+
+// --------------------------------------------------------- //
+// sizes of strings for the whole range of compensated values (with terminating zero)
+#define BME280_TEMP_STR_SIZE		7		// "-40,00"
+#define BME280_PRESSURE_STR_SIZE	8		// "1100,00", lower values are padded with space
+#define BME280_HUMI_STR_SIZE		7		// "100,00"
+
+// strings are formatted on demand and cached up to next sample, bits of str_valid:
+#define BME280_STR_TEMP				0x01
+#define BME280_STR_PRESSURE			0x02
+#define BME280_STR_HUMIDITY			0x04
+
+// --------------------------------------------------------- //
+#define BME280_ADDR_SDO_GND	0xEC	// Sensor addres -> SDO pin is connected to GND
+#define BME280_ADDR_SDO_VCC	0xEE	// Sensor addres -> SDO pin is connected to VCC
+#define BME280_ADDR 		BME280_ADDR_SDO_GND
+
+// --------------------------------------------------------- //
+// interface used by sensor
+#define BME280_INTERFACE_SPI	0
+#define BME280_INTERFACE_I2C	1
+#define BME280_INTERFACE_OTHER	2	// transport given by BME280_Init_Transport
 
 // --------------------------------------------------------- //
 // Oversampling for registers:
@@ -89,12 +139,31 @@
 // --------------------------------------------------------- //
 #define SIZE_OF_TCOEF_UNION 33
 #define SIZE_OF_PT_UNION 24			//pressure and temperature union
+#define BME280_CALIB1_SIZE 26		// calibration registers 0x88 -> 0xA1 read in one burst
+#define BME280_CALIB2_SIZE 7		// calibration registers 0xE1 -> 0xE7 read in one burst
+#define BME280_CALIB_SIZE (BME280_CALIB1_SIZE + BME280_CALIB2_SIZE)
+#define BME280_DATA_SIZE 8			// data registers 0xF7 -> 0xFE read in one burst
+
+// --------------------------------------------------------- //
+// compensation back ends, selected per sensor by BME280_Set_Backend:
+//		int32 -> Bosch 32-bit integer formulas, pressure resolution 1 Pa
+//		int64 -> pressure by Bosch 64-bit formula, resolution 1/256 Pa
+//		float -> Bosch floating point formulas in single precision (software float on Cortex-M3)
+#define BME280_BACKEND_INT32	0
+#define BME280_BACKEND_INT64	1
+#define BME280_BACKEND_FLOAT	2
+
+#define BME280_COMPENSATION_INT64	1		// include 64-bit back end
+#define BME280_COMPENSATION_FLOAT	1		// include float back end
+#define BME280_BACKEND_DEFAULT		BME280_BACKEND_INT32
 
 // --------------------------------------------------------- //
 // calculation of average values of temperature and humidity
 #define CALCULATION_AVERAGE_TEMP 1
+#define CALCULATION_AVERAGE_PRESSURE 1
 #define CALCULATION_AVERAGE_HUMIDITY 1
-#define No_OF_SAMPLES 10
+#define No_OF_SAMPLES 10				// default window size of average
+#define No_OF_SAMPLES_MAX 64			// capacity of averaging buffers (3 x 4 x 64 bytes per sensor), larger window is rejected by BME280_Set_Average_Window
 
 // --------------------------------------------------------- //
 // 3-wire SPI interface -> spi3w_en[0]  -> addres register 0xF5 bits: 0
@@ -103,6 +172,12 @@
 #endif
 
 
+// --------------------------------------------------------- //
+#define BME280_VERIFY_PERIOD 60000	// period of configuration readback when registers weren't written [ms]
+
+// --------------------------------------------------------- //
+#define BME280_MAX_REG_WRITE 8		// maximum number of registers written in one transaction
+
 // --------------------------------------------------------- //
 typedef enum {T_lower_limit = 1, T_over_limit = 2, P_lower_limit = 3, P_over_limit = 4, H_lower_limit = 5, H_over_limit = 6 } ERR_BOUNDARIES;
 typedef enum {calib_reg = 1, config_reg = 2, both = 3} ERR_CONF;
@@ -125,7 +200,31 @@ typedef union {
 	};
 }CONF;
 
-extern CONF conf_BME280;
+// --------------------------------------------------------- //
+typedef struct {
+	uint8_t reg;		// register address
+	uint8_t value;		// value written to register
+} BME280_REG;
+
+// --------------------------------------------------------- //
+// bus operations of sensor, set by BME280_Init_SPI / BME280_Init_I2C
+// or given by BME280_Init_Transport (e.g. simulated sensor)
+struct BME280;
+
+typedef struct {
+	void (*read)(struct BME280 *bmp, uint8_t reg, uint8_t size, uint8_t *data);		// blocking read of consecutive registers
+	void (*write)(struct BME280 *bmp, const BME280_REG *regs, uint8_t count);		// write ordered (register, value) pairs in one transaction
+	uint8_t (*read_async)(struct BME280 *bmp, uint8_t reg, uint8_t size, uint8_t *data, void (*callback)(void));	// non-blocking read, return 1 if bus is busy, 0 -> blocking read is used
+} BME280_TRANSPORT;
+
+// --------------------------------------------------------- //
+typedef struct {
+	uint8_t  reg[3];		// last written values of ctrl_hum, ctrl_meas and config (index as in CONF.bt)
+	uint8_t  valid;			// set "1" if reg table is equal to registers of sensor
+	uint32_t last_verify;	// system time of last configuration readback [ms]
+	uint32_t hits;			// number of register writes skipped, because value didn't change
+	uint32_t misses;		// number of register writes sent to sensor
+} BME280_SHADOW;
 
 // --------------------------------------------------------- //
 typedef union {
@@ -158,9 +257,51 @@ typedef union {
 	};
 } TCOEF;
 
-
+// --------------------------------------------------------- //
+// calibration prepared for compensation: coefficients are extended to 32 bit
+// and terms which depend only on calibration are computed once, after
+// compensation parameters are read (bme280_prepare_calibration)
 typedef struct {
+	int32_t T1;				// dig_T1
+	int32_t T1x2;			// dig_T1 * 2
+	int32_t T2;				// dig_T2
+	int32_t T3;				// dig_T3
+	int32_t P1;				// dig_P1
+	int32_t P2;				// dig_P2
+	int32_t P3;				// dig_P3
+	int32_t P4x65536;		// dig_P4 << 16
+	int32_t P5x2;			// dig_P5 * 2
+	int32_t P6;				// dig_P6
+	int32_t P7;				// dig_P7
+	int32_t P8;				// dig_P8
+	int32_t P9;				// dig_P9
+	int32_t H1;				// dig_H1
+	int32_t H2;				// dig_H2
+	int32_t H3;				// dig_H3
+	int32_t H4x1048576;		// dig_H4 * 1048576
+	int32_t H5;				// dig_H5
+	int32_t H6;				// dig_H6
+} BME280_CALIB;
+
+
+typedef struct BME280 {
+	// ----- device context -----
+	CONF conf;					// configuration of sensor, applied by BME280_Conf
+	const BME280_TRANSPORT *transport;	// bus operations
+	void *transport_ctx;		// data of transport given by BME280_Init_Transport
+	uint8_t interface;			// BME280_INTERFACE_SPI, BME280_INTERFACE_I2C or BME280_INTERFACE_OTHER
+	uint8_t SLA;				// I2C address of sensor (BME280_ADDR_SDO_GND or BME280_ADDR_SDO_VCC)
+	GPIO_TypeDef *cs_port;		// SPI chip select port
+	uint16_t cs_pin;			// SPI chip select pin
+	uint8_t reset_done;			// set "1" when software reset was sent
+	uint32_t reset_time;		// system time of software reset [ms]
+	uint8_t calib_loaded;		// set "1" when compensation parameters were read and checked after reset
+
 	TCOEF coef;
+	BME280_CALIB calib;			// coef prepared for compensation
+	uint8_t backend;			// compensation back end: BME280_BACKEND_INT32, _INT64 or _FLOAT
+	uint8_t raw[BME280_DATA_SIZE];	// data registers of the last conversion: press[3], temp[3], hum[2]
+	volatile uint8_t data_ready;	// set "1" when raw contains conversion which wasn't calculated yet
 	uint8_t measuring_staus;	// status of measuring sensor
 	uint8_t im_update_staus ;	// status of im update sensor
 	int32_t adc_T;				// raw value of temperature
@@ -171,6 +312,8 @@ typedef struct {
 	uint8_t err_boundaries_T;	// if raw value of temperature is over limits
 	uint8_t err_boundaries_P;	// if raw value of pressure is over limits
 	uint8_t err_boundaries_H;	// if raw value of humidity is over limits
+	uint32_t calib_read_time;	// bus time spent on reading of compensation parameters [us]
+	BME280_SHADOW shadow;		// shadow copy of writable configuration registers
 
 
 	// ----- temperature -----
@@ -179,26 +322,41 @@ typedef struct {
 	uint8_t t2;				// after comma
 
 #if CALCULATION_AVERAGE_TEMP
+	int32_t avearage_temp;						// average temperature [x 0,01 degree]
 	int8_t avearage_temp_cel;
 	uint8_t avearage_temp_fract;
-	int16_t smaples_of_temp[No_OF_SAMPLES];
+	MOVING_AVG avg_temp;						// running window of temperature
+	int32_t smaples_of_temp[No_OF_SAMPLES_MAX];
 #endif
 
 #if USE_STRING
-	char temp2str[6];		// tepmerature as string
+	char temp2str[BME280_TEMP_STR_SIZE];		// tepmerature as string
 #endif
 
 	// ----- pressure -----
 	uint32_t 	preasure;		// value of calculated pressure
+	uint32_t	pressure_fine;	// pressure x 1/256 Pa, full resolution of back end
 	int32_t 	p1;				// before comma
 	//int32_t 	p2;				// after comma
 
+#if CALCULATION_AVERAGE_PRESSURE
+	uint32_t avearage_pressure;					// average pressure [Pa]
+	MOVING_AVG avg_pressure;					// running window of pressure
+	int32_t smaples_of_pressure[No_OF_SAMPLES_MAX];
+#endif
+
 	// ----- sea pressure -----
 	uint32_t sea_pressure_redu;
+	uint32_t sea_factor[BME280_SEA_TABLE_SIZE];	// p0/p in Q12.20 for temperature BME280_SEA_T_MIN + (i << BME280_SEA_T_SHIFT)
+	int32_t station_altitude;					// altitude of sensor used by reduction [m]
+
+	// ----- altitude from pressure -----
+	int32_t altitude;							// altitude against reference pressure [x 0,01 m]
+	uint32_t reference_inv;						// 2^40 / reference pressure [Pa]
 
 
 #if USE_STRING
-	char pressure2str[7];		// pressure as string
+	char pressure2str[BME280_PRESSURE_STR_SIZE];	// pressure as string
 #endif
 
 //-----------------------------------------------------------------------
@@ -208,22 +366,54 @@ typedef struct {
 	uint8_t h2;				// after comma
 
 #if CALCULATION_AVERAGE_HUMIDITY
+	int32_t avearage_humidity;					// average humidity [x 0,01 %]
 	int8_t avearage_humidity_cel;
 	uint8_t avearage_humidity_fract;
-	int16_t smaples_of_humidity[No_OF_SAMPLES];
+	MOVING_AVG avg_humidity;					// running window of humidity
+	int32_t smaples_of_humidity[No_OF_SAMPLES_MAX];
 #endif
 
 #if USE_STRING
-	char humi2str[7];		// humidity as string
+	char humi2str[BME280_HUMI_STR_SIZE];		// humidity as string
+
+	uint8_t str_valid;		// BME280_STR_x bits of strings formatted from current values
 #endif
 
 } BME280;
 
-extern BME280 bme;
-
 
 // --------------------------------------------------------- //
-uint8_t BME280_Conf (CONF *sensor, BME280 *bmp);
+#if BME280_SPI
+void BME280_Init_SPI(BME280 *bmp, GPIO_TypeDef *cs_port, uint16_t cs_pin);	// prepare context of sensor with chip select on given pin
+#endif
+#if BME280_I2C
+void BME280_Init_I2C(BME280 *bmp, uint8_t SLA);								// prepare context of sensor with given I2C address
+#endif
+void BME280_Init_Transport(BME280 *bmp, const BME280_TRANSPORT *transport, void *ctx);		// prepare context of sensor with own bus operations
+uint8_t BME280_Conf (BME280 *bmp);
+uint8_t BME280_Verify (BME280 *bmp);													// read back configuration registers, return 2 if they differ from bmp->conf
+void BME280_Set_Backend(BME280 *bmp, uint8_t backend);			// select compensation back end, not included one is replaced by int32
+uint8_t BME280_Set_Average_Window(BME280 *bmp, uint16_t temp, uint16_t pressure, uint16_t humidity);	// window sizes of averages, return 1 if any is over No_OF_SAMPLES_MAX
+void BME280_Set_Altitude(BME280 *bmp, int32_t altitude);								// altitude of sensor [m] for pressure reduced to sea level
+uint8_t BME280_Set_Reference_Pressure(BME280 *bmp, uint32_t pressure);					// reference of altitude computation [Pa], return 1 if out of BME280_REFERENCE_MIN .. MAX
 uint8_t BME280_ReadTPH(BME280 *bmp);
+uint8_t BME280_Calculate(BME280 *bmp);													// calculate values from raw data registers saved in bmp->raw
+#if USE_STRING
+const char *BME280_Temp_Str(BME280 *bmp);												// temperature string of current sample, formatted on first call
+const char *BME280_Pressure_Str(BME280 *bmp);											// pressure string [hPa] of current sample, formatted on first call
+const char *BME280_Humi_Str(BME280 *bmp);												// humidity string of current sample, formatted on first call
+#endif
+uint32_t BME280_Trigger(BME280 *bmp);													// start forced measurement, return maximum conversion time [us]
+void BME280_Set_Normal_Mode(BME280 *bmp, uint8_t t_sb, uint8_t filter);					// sensor converts continuously, apply by BME280_Conf()
+uint32_t BME280_Cycle_Time_us(BME280 *bmp);												// period of conversions in normal mode [us]
+uint8_t bme280_compute_measure_time(MEASUREMENT_TIME type, CONF *sensor);				// measurement time in milliseconds for the active configuration
+uint32_t bme280_compute_measure_time_us(MEASUREMENT_TIME type, CONF *sensor);			// measurement time in microseconds for the active configuration
+void BME280_write_registers(BME280 *bmp, const BME280_REG *regs, uint8_t count);	// write list of registers in one transaction
+void BME280_read_data(BME280 *bmp, uint8_t register_addr, uint8_t size, uint8_t *Data);			// blocking read of registers
+uint8_t BME280_read_data_async(BME280 *bmp, uint8_t register_addr, uint8_t size, uint8_t *Data, void (*callback)(void));	// non-blocking read, return 1 if bus is busy
+
+#if BME280_SPI_DMA
+uint8_t BME280_read_data_DMA(BME280 *bmp, uint8_t register_addr, uint8_t size, uint8_t *Data, void (*callback)(void));	// non-blocking read, return 1 if DMA is busy
+#endif
 
 #endif /* BME280_BME280_H_ */
@@ -0,0 +1,448 @@
+/*
+ * BME280_compensate.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "BME280_compensate.h"
+
+#define TEMPERATURE_MIN		-4000		// x 0,01 degree
+#define TEMPERATURE_MAX		8500		// x 0,01 degree
+#define HUMIDITY_MAX		102400		// 100 % x 1024
+#define PRESSURE_MIN		30000		// Pa, operating range of sensor
+#define PRESSURE_MAX		110000		// Pa
+
+// altitude table: ratio p/p_ref in Q8.24 from 0,25 to 1,125 with step 2^-7,
+// interpolation error is below 0,1 m for ratio over 0,7 (up to ~3 km)
+#define ALT_RATIO_MIN		(1UL << 22)	// 0,25 in Q8.24
+#define ALT_RATIO_SHIFT		17			// step 2^-7 in Q8.24
+#define ALT_TABLE_SIZE		113
+
+// Integer formulas give the same bits as Bosch reference code (datasheet, chapter 4.2.3
+// and 8.2): scaling is done by arithmetic right shifts as there, not by divisions,
+// which round towards zero and differ for negative intermediate values.
+
+
+/****************************************************************************/
+/*      split data registers 0xF7 - 0xFE into raw values			        */
+/****************************************************************************/
+void bme280_unpack_raw(const uint8_t *regs, int32_t *adc_T, int32_t *adc_P, int32_t *adc_H)
+{
+	*adc_P = (regs[0] << 12) | (regs[1] << 4) | (regs[2] >> 4);
+	*adc_T = (regs[3] << 12) | (regs[4] << 4) | (regs[5] >> 4);
+	*adc_H = (regs[6] << 8)  |  regs[7];
+}
+
+/****************************************************************************/
+/*      extend coefficients and compute terms which depend only on			*/
+/*      calibration, called once after compensation parameters are read	*/
+/****************************************************************************/
+void bme280_prepare_calibration(const TCOEF *coef, BME280_CALIB *cal)
+{
+	cal->T1			= coef->dig_T1;
+	cal->T1x2		= (int32_t)coef->dig_T1 * 2;
+	cal->T2			= coef->dig_T2;
+	cal->T3			= coef->dig_T3;
+
+	cal->P1			= coef->dig_P1;
+	cal->P2			= coef->dig_P2;
+	cal->P3			= coef->dig_P3;
+	cal->P4x65536	= ((int32_t)coef->dig_P4) << 16;
+	cal->P5x2		= (int32_t)coef->dig_P5 * 2;
+	cal->P6			= coef->dig_P6;
+	cal->P7			= coef->dig_P7;
+	cal->P8			= coef->dig_P8;
+	cal->P9			= coef->dig_P9;
+
+	cal->H1			= coef->dig_H1;
+	cal->H2			= coef->dig_H2;
+	cal->H3			= coef->dig_H3;
+	cal->H4x1048576	= (int32_t)coef->dig_H4 * 1048576;
+	cal->H5			= coef->dig_H5;
+	cal->H6			= coef->dig_H6;
+}
+
+/****************************************************************************/
+/*      temperature x 0,01 degree, t_fine is used by P and H		        */
+/****************************************************************************/
+int32_t bme280_compensate_T(const BME280_CALIB *cal, int32_t adc_T, int32_t *t_fine)
+{
+	int32_t var1, var2, temperature;
+
+	var1 = (((adc_T >> 3) - cal->T1x2) * cal->T2) >> 11;
+	var2 = (adc_T >> 4) - cal->T1;
+	var2 = (((var2 * var2) >> 12) * cal->T3) >> 14;
+	*t_fine = var1 + var2;
+	temperature = (*t_fine * 5 + 128) >> 8;
+
+	if      (temperature < TEMPERATURE_MIN) temperature = TEMPERATURE_MIN;
+	else if (temperature > TEMPERATURE_MAX) temperature = TEMPERATURE_MAX;
+
+	return temperature;
+}
+
+/****************************************************************************/
+/*      pressure in Pa, 0 if division by zero						        */
+/****************************************************************************/
+uint32_t bme280_compensate_P(const BME280_CALIB *cal, int32_t adc_P, int32_t t_fine)
+{
+	int32_t var1, var2;
+	uint32_t p;
+
+	var1 = (t_fine >> 1) - (int32_t)64000;
+	var2 = (((var1 >> 2) * (var1 >> 2)) >> 11 ) * cal->P6;
+	var2 = var2 + var1 * cal->P5x2;
+	var2 = (var2 >> 2) + cal->P4x65536;
+	var1 = (((cal->P3 * (((var1 >> 2) * (var1 >> 2)) >> 13 )) >> 3) + ((cal->P2 * var1) >> 1)) >> 18;
+	var1 = ((32768 + var1) * cal->P1) >> 15;
+
+	if (var1 == 0) return 0;
+
+	p = (((uint32_t)(((int32_t)1048576) - adc_P) - (var2 >> 12))) * 3125;
+
+	if (p < 0x80000000) p = (p << 1) / ((uint32_t)var1);
+	else				p = (p / (uint32_t)var1) * 2;
+
+	var1 = (cal->P9 * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+	var2 = (((int32_t)(p >> 2)) * cal->P8) >> 13;
+	p = (uint32_t)((int32_t)p + ((var1 + var2 + cal->P7) >> 4));
+
+	return p;
+}
+
+/****************************************************************************/
+/*      humidity x 1/1024 %											        */
+/****************************************************************************/
+uint32_t bme280_compensate_H(const BME280_CALIB *cal, int32_t adc_H, int32_t t_fine)
+{
+	int32_t var1, var2, var3, var4, var5;
+	uint32_t humidity;
+
+	var1 = t_fine - ((int32_t)76800);
+	var5 = (((adc_H << 14) - cal->H4x1048576 - cal->H5 * var1) + (int32_t)16384) >> 15;
+	var2 = (var1 * cal->H6) >> 10;
+	var3 = (var1 * cal->H3) >> 11;
+	var4 = ((var2 * (var3 + (int32_t)32768)) >> 10) + (int32_t)2097152;
+	var2 = ((var4 * cal->H2) + 8192) >> 14;
+	var3 = var5 * var2;
+	var4 = ((var3 >> 15) * (var3 >> 15)) >> 7;
+	var5 = var3 - ((var4 * cal->H1) >> 4);
+	var5 = (var5 < 0 ? 0 : var5);
+	var5 = (var5 > 419430400 ? 419430400 : var5);
+	humidity = (uint32_t)(var5 >> 12);
+
+	if (humidity > HUMIDITY_MAX) humidity = HUMIDITY_MAX;
+
+	return humidity;
+}
+
+/****************************************************************************/
+/*      pressure x 1/256 Pa by Bosch 64-bit formula, 0 if division by zero	*/
+/****************************************************************************/
+#if BME280_COMPENSATION_INT64
+uint32_t bme280_compensate_P_int64(const BME280_CALIB *cal, int32_t adc_P, int32_t t_fine)
+{
+	int64_t var1, var2, p;
+
+	var1 = ((int64_t)t_fine) - 128000;
+	var2 = var1 * var1 * (int64_t)cal->P6;
+	var2 = var2 + ((var1 * (int64_t)cal->P5x2) << 16);
+	var2 = var2 + (((int64_t)cal->P4x65536) << 19);
+	var1 = ((var1 * var1 * (int64_t)cal->P3) >> 8) + ((var1 * (int64_t)cal->P2) << 12);
+	var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)cal->P1) >> 33;
+
+	if (var1 == 0) return 0;
+
+	p = 1048576 - adc_P;
+	p = (((p << 31) - var2) * 3125) / var1;
+	var1 = (((int64_t)cal->P9) * (p >> 13) * (p >> 13)) >> 25;
+	var2 = (((int64_t)cal->P8) * p) >> 19;
+	p = ((p + var1 + var2) >> 8) + (((int64_t)cal->P7) << 4);
+
+	return (uint32_t)p;
+}
+#endif
+
+/****************************************************************************/
+/*      Bosch floating point formulas in single precision			        */
+/****************************************************************************/
+#if BME280_COMPENSATION_FLOAT
+float bme280_compensate_T_float(const BME280_CALIB *cal, int32_t adc_T, int32_t *t_fine)
+{
+	float var1, var2, temperature;
+
+	var1 = ((float)adc_T / 16384.0f - (float)cal->T1 / 1024.0f) * (float)cal->T2;
+	var2 = (float)adc_T / 131072.0f - (float)cal->T1 / 8192.0f;
+	var2 = var2 * var2 * (float)cal->T3;
+	*t_fine = (int32_t)(var1 + var2);
+	temperature = (var1 + var2) / 5120.0f;
+
+	if      (temperature < TEMPERATURE_MIN / 100.0f) temperature = TEMPERATURE_MIN / 100.0f;
+	else if (temperature > TEMPERATURE_MAX / 100.0f) temperature = TEMPERATURE_MAX / 100.0f;
+
+	return temperature;
+}
+
+float bme280_compensate_P_float(const BME280_CALIB *cal, int32_t adc_P, int32_t t_fine)
+{
+	float var1, var2, p;
+
+	var1 = (float)t_fine / 2.0f - 64000.0f;
+	var2 = var1 * var1 * (float)cal->P6 / 32768.0f;
+	var2 = var2 + var1 * (float)cal->P5x2;
+	var2 = var2 / 4.0f + (float)cal->P4x65536;
+	var1 = ((float)cal->P3 * var1 * var1 / 524288.0f + (float)cal->P2 * var1) / 524288.0f;
+	var1 = (1.0f + var1 / 32768.0f) * (float)cal->P1;
+
+	if (var1 == 0.0f) return 0.0f;
+
+	p = 1048576.0f - (float)adc_P;
+	p = (p - var2 / 4096.0f) * 6250.0f / var1;
+	var1 = (float)cal->P9 * p * p / 2147483648.0f;
+	var2 = p * (float)cal->P8 / 32768.0f;
+	p = p + (var1 + var2 + (float)cal->P7) / 16.0f;
+
+	// raw values out of range give any float (also negative or over 2^24 Pa), its conversion to uint32_t x 256 would be undefined
+	if      (p < (float)PRESSURE_MIN) p = (float)PRESSURE_MIN;
+	else if (p > (float)PRESSURE_MAX) p = (float)PRESSURE_MAX;
+
+	return p;
+}
+
+float bme280_compensate_H_float(const BME280_CALIB *cal, int32_t adc_H, int32_t t_fine)
+{
+	float var_H;
+
+	var_H = (float)t_fine - 76800.0f;
+	var_H = ((float)adc_H - ((float)cal->H4x1048576 / 16384.0f + (float)cal->H5 / 16384.0f * var_H)) *
+			((float)cal->H2 / 65536.0f * (1.0f + (float)cal->H6 / 67108864.0f * var_H * (1.0f + (float)cal->H3 / 67108864.0f * var_H)));
+	var_H = var_H * (1.0f - (float)cal->H1 * var_H / 524288.0f);
+
+	if      (var_H > 100.0f) var_H = 100.0f;
+	else if (var_H < 0.0f)   var_H = 0.0f;
+
+	return var_H;
+}
+#endif
+
+/****************************************************************************/
+/*      compensate one sample by selected back end, result is in common		*/
+/*      fixed-point format, back end which isn't included is replaced		*/
+/*      by int32															*/
+/****************************************************************************/
+uint8_t bme280_compensate(uint8_t backend, const BME280_CALIB *cal, int32_t adc_T, int32_t adc_P, int32_t adc_H, BME280_TPH *out)
+{
+	int32_t t_fine;
+
+#if BME280_COMPENSATION_FLOAT
+	if (backend == BME280_BACKEND_FLOAT)
+	{
+		float temperature, pressure;
+
+		PROFILE_BEGIN(start);
+		temperature		 = bme280_compensate_T_float(cal, adc_T, &t_fine) * 100.0f;
+		out->temperature = (int32_t)(temperature + ((temperature < 0.0f) ? -0.5f : 0.5f));
+		PROFILE_END(PROFILE_TEMPERATURE, start);
+
+		PROFILE_RESTART(start);
+		out->humidity	 = (uint32_t)(bme280_compensate_H_float(cal, adc_H, t_fine) * 1024.0f + 0.5f);
+		PROFILE_END(PROFILE_HUMIDITY, start);
+
+		PROFILE_RESTART(start);
+		pressure = bme280_compensate_P_float(cal, adc_P, t_fine);
+		out->pressure	 = (uint32_t)(pressure * 256.0f + 0.5f);
+		PROFILE_END(PROFILE_PRESSURE, start);
+		return (pressure == 0.0f) ? 1 : 0;
+	}
+#endif
+
+	PROFILE_BEGIN(stage_start);
+	out->temperature = bme280_compensate_T(cal, adc_T, &t_fine);
+	PROFILE_END(PROFILE_TEMPERATURE, stage_start);
+
+	PROFILE_RESTART(stage_start);
+	out->humidity	 = bme280_compensate_H(cal, adc_H, t_fine);
+	PROFILE_END(PROFILE_HUMIDITY, stage_start);
+
+	PROFILE_RESTART(stage_start);
+#if BME280_COMPENSATION_INT64
+	if (backend == BME280_BACKEND_INT64)
+	{
+		out->pressure = bme280_compensate_P_int64(cal, adc_P, t_fine);
+		PROFILE_END(PROFILE_PRESSURE, stage_start);
+		return (out->pressure == 0) ? 1 : 0;
+	}
+#endif
+
+	out->pressure = bme280_compensate_P(cal, adc_P, t_fine) << 8;
+	PROFILE_END(PROFILE_PRESSURE, stage_start);
+	return (out->pressure == 0) ? 1 : 0;
+}
+
+/****************************************************************************/
+/*      compensate count samples in one pass, prepared calibration is		*/
+/*      copied to locals once, so it stays in registers and isn't reloaded	*/
+/*      after every store to output arrays. Results are equal to			*/
+/*      single-sample functions above										*/
+/****************************************************************************/
+uint16_t BME280_Compensate_Batch(const BME280_CALIB *calib, const BME280_RAW_BATCH *raw, BME280_TPH_BATCH *out, uint16_t count)
+{
+	const BME280_CALIB cal = *calib;
+
+	int32_t var1, var2, var3, var4, var5, t_fine, temperature;
+	uint32_t p, humidity;
+	uint16_t errors = 0;
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		// ----- temperature -----
+		var1 = (((raw->adc_T[i] >> 3) - cal.T1x2) * cal.T2) >> 11;
+		var2 = (raw->adc_T[i] >> 4) - cal.T1;
+		var2 = (((var2 * var2) >> 12) * cal.T3) >> 14;
+		t_fine = var1 + var2;
+		temperature = (t_fine * 5 + 128) >> 8;
+
+		if      (temperature < TEMPERATURE_MIN) temperature = TEMPERATURE_MIN;
+		else if (temperature > TEMPERATURE_MAX) temperature = TEMPERATURE_MAX;
+		out->temperature[i] = temperature;
+
+		// ----- pressure -----
+		var1 = (t_fine >> 1) - (int32_t)64000;
+		var2 = (((var1 >> 2) * (var1 >> 2)) >> 11 ) * cal.P6;
+		var2 = var2 + var1 * cal.P5x2;
+		var2 = (var2 >> 2) + cal.P4x65536;
+		var1 = (((cal.P3 * (((var1 >> 2) * (var1 >> 2)) >> 13 )) >> 3) + ((cal.P2 * var1) >> 1)) >> 18;
+		var1 = ((32768 + var1) * cal.P1) >> 15;
+
+		if (var1 == 0)
+		{
+			out->pressure[i] = 0;
+			errors++;
+		}
+		else
+		{
+			p = (((uint32_t)(((int32_t)1048576) - raw->adc_P[i]) - (var2 >> 12))) * 3125;
+
+			if (p < 0x80000000) p = (p << 1) / ((uint32_t)var1);
+			else				p = (p / (uint32_t)var1) * 2;
+
+			var1 = (cal.P9 * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+			var2 = (((int32_t)(p >> 2)) * cal.P8) >> 13;
+			out->pressure[i] = (uint32_t)((int32_t)p + ((var1 + var2 + cal.P7) >> 4));
+		}
+
+		// ----- humidity -----
+		var1 = t_fine - ((int32_t)76800);
+		var5 = (((raw->adc_H[i] << 14) - cal.H4x1048576 - cal.H5 * var1) + (int32_t)16384) >> 15;
+		var2 = (var1 * cal.H6) >> 10;
+		var3 = (var1 * cal.H3) >> 11;
+		var4 = ((var2 * (var3 + (int32_t)32768)) >> 10) + (int32_t)2097152;
+		var2 = ((var4 * cal.H2) + 8192) >> 14;
+		var3 = var5 * var2;
+		var4 = ((var3 >> 15) * (var3 >> 15)) >> 7;
+		var5 = var3 - ((var4 * cal.H1) >> 4);
+		var5 = (var5 < 0 ? 0 : var5);
+		var5 = (var5 > 419430400 ? 419430400 : var5);
+		humidity = (uint32_t)(var5 >> 12);
+
+		out->humidity[i] = (humidity > HUMIDITY_MAX) ? HUMIDITY_MAX : humidity;
+	}
+
+	return errors;
+}
+
+/****************************************************************************/
+/*      table of p0/p factors of Babinet formula for given altitude [m]:	*/
+/*      p0 = p * (1 + k) / (1 - k), k = h / (16000 * (1 + 0.004 * t_m)),	*/
+/*      t_m is mean temperature of air column between sensor and sea		*/
+/*      level (gradient 0,65 degree / 100 m). Computed once, not per sample	*/
+/****************************************************************************/
+void bme280_prepare_sea_level(int32_t altitude, uint32_t *table)
+{
+	float t, t_m, k;
+
+	for (uint8_t i = 0; i < BME280_SEA_TABLE_SIZE; i++)
+	{
+		t	= (float)(BME280_SEA_T_MIN + (i << BME280_SEA_T_SHIFT)) / 100.0f;
+		t_m	= t + 0.00325f * (float)altitude;
+		k	= (float)altitude / (16000.0f * (1.0f + 0.004f * t_m));
+
+		table[i] = (uint32_t)((1.0f + k) / (1.0f - k) * 1048576.0f + 0.5f);
+	}
+}
+
+/****************************************************************************/
+/*      pressure reduced to sea level: factor is interpolated from table	*/
+/*      and pressure is multiplied by it, no division is used				*/
+/****************************************************************************/
+uint32_t bme280_sea_level_pressure(const uint32_t *table, int32_t temperature, uint32_t pressure)
+{
+	uint32_t pos, index, frac, factor;
+
+	if (temperature < BME280_SEA_T_MIN) temperature = BME280_SEA_T_MIN;
+
+	pos		= (uint32_t)(temperature - BME280_SEA_T_MIN);
+	index	= pos >> BME280_SEA_T_SHIFT;
+	frac	= pos & ((1 << BME280_SEA_T_SHIFT) - 1);
+
+	if (index >= BME280_SEA_TABLE_SIZE - 1)
+	{
+		index	= BME280_SEA_TABLE_SIZE - 2;
+		frac	= 1 << BME280_SEA_T_SHIFT;
+	}
+
+	factor = table[index] + (((int32_t)(table[index + 1] - table[index]) * (int32_t)frac) >> BME280_SEA_T_SHIFT);
+
+	return (uint32_t)(((uint64_t)pressure * factor + (1 << 19)) >> 20);
+}
+
+// altitude [x 0,01 m] = 4433077 * (1 - (p / p_ref)^0,190263) for ratio ALT_RATIO_MIN + (i << ALT_RATIO_SHIFT)
+static const int32_t altitude_table[ALT_TABLE_SIZE] = {
+	1027776, 1007780, 988270, 969218, 950602, 932401, 914593, 897161,
+	880087, 863356, 846952, 830861, 815070, 799567, 784341, 769380,
+	754675, 740216, 725994, 712000, 698227, 684667, 671312, 658156,
+	645193, 632415, 619818, 607396, 595142, 583053, 571124, 559349,
+	547725, 536246, 524910, 513713, 502649, 491717, 480912, 470231,
+	459672, 449231, 438904, 428691, 418587, 408590, 398697, 388907,
+	379217, 369624, 360126, 350722, 341410, 332186, 323050, 314000,
+	305033, 296149, 287345, 278620, 269972, 261400, 252903, 244478,
+	236124, 227841, 219627, 211480, 203400, 195385, 187434, 179546,
+	171719, 163953, 156247, 148600, 141010, 133477, 126000, 118577,
+	111208, 103893, 96630, 89418, 82257, 75145, 68083, 61069,
+	54102, 47183, 40309, 33481, 26698, 19959, 13263, 6610,
+	0, -6569, -13096, -19583, -26030, -32438, -38807, -45137,
+	-51430, -57685, -63903, -70085, -76231, -82342, -88418, -94459,
+	-100466
+};
+
+/****************************************************************************/
+/*      reciprocal of reference pressure, called once when it is set		*/
+/****************************************************************************/
+uint32_t bme280_prepare_altitude_reference(uint32_t pressure)
+{
+	if (!pressure) return 0;
+
+	return (uint32_t)((((uint64_t)1 << 40) + (pressure >> 1)) / pressure);
+}
+
+/****************************************************************************/
+/*      altitude from pressure: ratio to reference pressure is computed by	*/
+/*      multiplication with reciprocal and altitude is interpolated from	*/
+/*      table, pow() and division are not used								*/
+/****************************************************************************/
+int32_t bme280_altitude(uint32_t reference_inv, uint32_t pressure_fine)
+{
+	uint32_t ratio, index, frac;
+
+	ratio = (uint32_t)(((uint64_t)pressure_fine * reference_inv) >> 24);		// Q8.24, (p x 2^8) x (2^40 / p_ref) / 2^24
+
+	if (ratio < ALT_RATIO_MIN) return altitude_table[0];
+
+	index	= (ratio - ALT_RATIO_MIN) >> ALT_RATIO_SHIFT;
+	frac	= (ratio - ALT_RATIO_MIN) & ((1UL << ALT_RATIO_SHIFT) - 1);
+
+	if (index >= ALT_TABLE_SIZE - 1) return altitude_table[ALT_TABLE_SIZE - 1];
+
+	return altitude_table[index] + (int32_t)(((int64_t)(altitude_table[index + 1] - altitude_table[index]) * frac) >> ALT_RATIO_SHIFT);
+}
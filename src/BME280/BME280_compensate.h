@@ -0,0 +1,63 @@
+/*
+ * BME280_compensate.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef BME280_BME280_COMPENSATE_H_
+#define BME280_BME280_COMPENSATE_H_
+
+#include "BME280.h"
+
+// --------------------------------------------------------- //
+// Compensation of raw ADC values without bus access, strings and averaging.
+// Batch functions work on struct of arrays, so raw samples captured in bursts
+// can be compensated later in one pass with calibration terms loaded once.
+// All functions use calibration prepared by bme280_prepare_calibration (bme->calib).
+
+// raw samples, arrays of count elements
+typedef struct {
+	const int32_t *adc_T;
+	const int32_t *adc_P;
+	const int32_t *adc_H;
+} BME280_RAW_BATCH;
+
+// compensated values, arrays of count elements
+typedef struct {
+	int32_t  *temperature;		// x 0,01 degree
+	uint32_t *pressure;			// Pa, 0 if compensation divides by zero
+	uint32_t *humidity;			// x 1/1024 %
+} BME280_TPH_BATCH;
+
+// result of any back end in common fixed-point format
+typedef struct {
+	int32_t  temperature;		// x 0,01 degree
+	uint32_t pressure;			// x 1/256 Pa (Q24.8)
+	uint32_t humidity;			// x 1/1024 % (Q22.10)
+} BME280_TPH;
+
+void bme280_unpack_raw(const uint8_t *regs, int32_t *adc_T, int32_t *adc_P, int32_t *adc_H);	// split data registers 0xF7 - 0xFE
+void bme280_prepare_calibration(const TCOEF *coef, BME280_CALIB *cal);							// compute terms which depend only on calibration
+int32_t bme280_compensate_T(const BME280_CALIB *cal, int32_t adc_T, int32_t *t_fine);					// temperature x 0,01 degree, t_fine for P and H
+uint32_t bme280_compensate_P(const BME280_CALIB *cal, int32_t adc_P, int32_t t_fine);					// pressure in Pa, 0 if division by zero
+uint32_t bme280_compensate_H(const BME280_CALIB *cal, int32_t adc_H, int32_t t_fine);					// humidity x 1/1024 %
+
+#if BME280_COMPENSATION_INT64
+uint32_t bme280_compensate_P_int64(const BME280_CALIB *cal, int32_t adc_P, int32_t t_fine);			// pressure x 1/256 Pa, 0 if division by zero
+#endif
+#if BME280_COMPENSATION_FLOAT
+float bme280_compensate_T_float(const BME280_CALIB *cal, int32_t adc_T, int32_t *t_fine);			// temperature in degrees
+float bme280_compensate_P_float(const BME280_CALIB *cal, int32_t adc_P, int32_t t_fine);				// pressure in Pa clamped to 300 - 1100 hPa, 0 if division by zero
+float bme280_compensate_H_float(const BME280_CALIB *cal, int32_t adc_H, int32_t t_fine);				// humidity in %
+#endif
+uint8_t bme280_compensate(uint8_t backend, const BME280_CALIB *cal, int32_t adc_T, int32_t adc_P, int32_t adc_H, BME280_TPH *out);	// return 1 if division by zero
+
+void bme280_prepare_sea_level(int32_t altitude, uint32_t *table);								// table of p0/p for altitude [m], BME280_SEA_TABLE_SIZE entries
+uint32_t bme280_sea_level_pressure(const uint32_t *table, int32_t temperature, uint32_t pressure);	// pressure reduced to sea level, division-free
+uint32_t bme280_prepare_altitude_reference(uint32_t pressure);									// 2^40 / reference pressure [Pa]
+int32_t bme280_altitude(uint32_t reference_inv, uint32_t pressure_fine);							// altitude x 0,01 m from pressure x 1/256 Pa, division-free
+
+uint16_t BME280_Compensate_Batch(const BME280_CALIB *cal, const BME280_RAW_BATCH *raw, BME280_TPH_BATCH *out, uint16_t count);	// return number of samples with pressure = 0
+
+#endif /* BME280_BME280_COMPENSATE_H_ */
@@ -0,0 +1,254 @@
+/*
+ * BME280_sim.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "BME280_sim.h"
+
+#if BME280_USE_SIM
+
+// calibration of simulated sensor: temperature and pressure coefficients are taken
+// from example of datasheet, humidity coefficients are typical values of real sensor
+static const uint8_t sim_calib1[BME280_CALIB1_SIZE] = {		// 0x88 - 0xA1
+	0x70, 0x6B,		// dig_T1 = 27504
+	0x43, 0x67,		// dig_T2 = 26435
+	0x18, 0xFC,		// dig_T3 = -1000
+	0x7D, 0x8E,		// dig_P1 = 36477
+	0x43, 0xD6,		// dig_P2 = -10685
+	0xD0, 0x0B,		// dig_P3 = 3024
+	0x27, 0x0B,		// dig_P4 = 2855
+	0x8C, 0x00,		// dig_P5 = 140
+	0xF9, 0xFF,		// dig_P6 = -7
+	0x8C, 0x3C,		// dig_P7 = 15500
+	0xF8, 0xC6,		// dig_P8 = -14600
+	0x70, 0x17,		// dig_P9 = 6000
+	0x00,			// 0xA0 - not used
+	0x4B,			// dig_H1 = 75
+};
+
+static const uint8_t sim_calib2[BME280_CALIB2_SIZE] = {		// 0xE1 - 0xE7
+	0x72, 0x01,		// dig_H2 = 370
+	0x00,			// dig_H3 = 0
+	0x13, 0x29,		// dig_H4 = 313 (0xE4 = H4[11:4], 0xE5[3:0] = H4[3:0])
+	0x03,			// dig_H5 = 50  (0xE5[7:4] = H5[3:0], 0xE6 = H5[11:4])
+	0x1E,			// dig_H6 = 30
+};
+
+// sample published when trace isn't given: 25.08 C, ~1006.5 hPa (datasheet example)
+static const BME280_SIM_SAMPLE sim_default_sample = {519888, 415148, 27000};
+
+// t_standby for t_sb setting: 0.5, 62.5, 125, 250, 500, 1000, 10, 20 ms
+static const uint32_t sim_standby_us[8] = {500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000};
+
+static void sim_reset(BME280_SIM *sim, uint32_t now);
+static void sim_update(BME280_SIM *sim, uint32_t now);
+static void sim_start(BME280_SIM *sim, uint32_t start);
+static void sim_publish(BME280_SIM *sim);
+static uint32_t sim_measure_time(BME280_SIM *sim);
+static void sim_read(BME280 *bme, uint8_t register_addr, uint8_t size, uint8_t *Data);
+static void sim_write(BME280 *bme, const BME280_REG *regs, uint8_t count);
+
+const BME280_TRANSPORT bme280_sim_transport = {
+	sim_read,
+	sim_write,
+	0,								// reads are done immediately
+};
+
+
+void BME280_Sim_Init(BME280_SIM *sim, const BME280_SIM_SAMPLE *trace, uint16_t trace_len, uint32_t (*clock)(void))
+{
+	memset(sim, 0, sizeof(BME280_SIM));
+
+	sim->clock		= clock ? clock : get_time_us;
+	sim->trace		= trace;
+	sim->trace_len	= trace ? trace_len : 0;
+
+	sim_reset(sim, sim->clock());
+}
+
+void BME280_Init_Sim(BME280 *bme, BME280_SIM *sim)
+{
+	BME280_Init_Transport(bme, &bme280_sim_transport, sim);
+}
+
+/****************************************************************************/
+/*      power-on values of registers								        */
+/****************************************************************************/
+static void sim_reset(BME280_SIM *sim, uint32_t now)
+{
+	memset(sim->regs, 0, sizeof(sim->regs));
+
+	memcpy(&sim->regs[0x88], sim_calib1, BME280_CALIB1_SIZE);
+	memcpy(&sim->regs[0xE1], sim_calib2, BME280_CALIB2_SIZE);
+	sim->regs[0xD0] = BME280_SIM_CHIP_ID;
+
+	// data registers after reset: 0x80000 for pressure and temperature, 0x8000 for humidity
+	sim->regs[0xF7] = 0x80;
+	sim->regs[0xFA] = 0x80;
+	sim->regs[0xFD] = 0x80;
+
+	sim->osrs_h		= 0;
+	sim->measuring	= 0;
+	sim->reset_end	= now + BME280_SIM_RESET_US;
+}
+
+/****************************************************************************/
+/*      move state of sensor up to given time						        */
+/****************************************************************************/
+static void sim_update(BME280_SIM *sim, uint32_t now)
+{
+	uint32_t cycle, lost;
+
+	for (;;)
+	{
+		if (sim->measuring)
+		{
+			if ((int32_t)(now - sim->conv_end) < 0) break;
+
+			sim_publish(sim);
+			sim->measuring = 0;
+
+			if ((sim->regs[0xF4] & 0x03) == BME280_NORMALMODE)
+			{
+				sim->next_start = sim->conv_end + sim_standby_us[sim->regs[0xF5] >> 5];
+			}
+			else
+			{
+				sim->regs[0xF4] &= ~0x03;		// forced mode: sensor goes back to sleep
+				break;
+			}
+		}
+		else if (((sim->regs[0xF4] & 0x03) == BME280_NORMALMODE) && ((int32_t)(now - sim->next_start) >= 0))
+		{
+			// after long time without access whole cycles are skipped at once
+			cycle = sim_measure_time(sim) + sim_standby_us[sim->regs[0xF5] >> 5];
+			lost = (now - sim->next_start) / cycle;
+			if (lost)
+			{
+				sim->next_start  += lost * cycle;
+				sim->conversions += lost;
+				if (sim->trace_len) sim->trace_index = (sim->trace_index + lost) % sim->trace_len;
+			}
+			sim_start(sim, sim->next_start);
+		}
+		else break;
+	}
+}
+
+static void sim_start(BME280_SIM *sim, uint32_t start)
+{
+	sim->measuring	= 1;
+	sim->conv_end	= start + sim_measure_time(sim);
+}
+
+static uint32_t sim_measure_time(BME280_SIM *sim)
+{
+	CONF conf;
+
+	conf.bt[0] = sim->osrs_h;
+	conf.bt[1] = sim->regs[0xF4];
+	conf.bt[2] = sim->regs[0xF5];
+
+	return bme280_compute_measure_time_us(typical_time, &conf);
+}
+
+/****************************************************************************/
+/*      copy next sample of trace to data registers, skipped channels		*/
+/*      get reset values											        */
+/****************************************************************************/
+static void sim_publish(BME280_SIM *sim)
+{
+	const BME280_SIM_SAMPLE *sample = &sim_default_sample;
+	uint32_t adc_T, adc_P;
+	uint16_t adc_H;
+
+	if (sim->trace_len)
+	{
+		sample = &sim->trace[sim->trace_index];
+		if (++sim->trace_index >= sim->trace_len) sim->trace_index = 0;
+	}
+
+	adc_P = ((sim->regs[0xF4] >> 2) & 0x07) ? sample->adc_P : 0x80000;
+	adc_T = ((sim->regs[0xF4] >> 5) & 0x07) ? sample->adc_T : 0x80000;
+	adc_H = sim->osrs_h ? sample->adc_H : 0x8000;
+
+	sim->regs[0xF7] = adc_P >> 12;
+	sim->regs[0xF8] = adc_P >> 4;
+	sim->regs[0xF9] = (adc_P & 0x0F) << 4;
+	sim->regs[0xFA] = adc_T >> 12;
+	sim->regs[0xFB] = adc_T >> 4;
+	sim->regs[0xFC] = (adc_T & 0x0F) << 4;
+	sim->regs[0xFD] = adc_H >> 8;
+	sim->regs[0xFE] = adc_H;
+
+	sim->conversions++;
+}
+
+/****************************************************************************/
+/*      transport: read consecutive registers, address is incremented       */
+/****************************************************************************/
+static void sim_read(BME280 *bme, uint8_t register_addr, uint8_t size, uint8_t *Data)
+{
+	BME280_SIM *sim = (BME280_SIM *)bme->transport_ctx;
+	uint32_t now = sim->clock();
+
+	sim_update(sim, now);
+
+	sim->regs[0xF3] = (sim->measuring ? BMP280_MEASURING_STATUS : 0) |
+					  (((int32_t)(now - sim->reset_end) < 0) ? BMP280_IM_UPDATE_STATUS : 0);
+
+	for (uint8_t i = 0; i < size; i++)
+	{
+		Data[i] = sim->regs[(uint8_t)(register_addr + i)];
+	}
+
+	sim->reads++;
+	sim->bytes += size + 1;
+}
+
+/****************************************************************************/
+/*      transport: write (register, value) pairs, only writable				*/
+/*      registers are changed										        */
+/****************************************************************************/
+static void sim_write(BME280 *bme, const BME280_REG *regs, uint8_t count)
+{
+	BME280_SIM *sim = (BME280_SIM *)bme->transport_ctx;
+	uint32_t now = sim->clock();
+	uint8_t mode;
+
+	sim_update(sim, now);
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		switch (regs[i].reg)
+		{
+		case 0xE0:
+			if (regs[i].value == BME280_SOFTWARE_RESET) sim_reset(sim, now);
+			break;
+
+		case 0xF2:
+			sim->regs[0xF2] = regs[i].value & 0x07;
+			break;
+
+		case 0xF4:
+			sim->regs[0xF4] = regs[i].value;
+			sim->osrs_h = sim->regs[0xF2];				// ctrl_hum is applied after write to ctrl_meas
+
+			mode = regs[i].value & 0x03;
+			if (mode == BME280_SLEEPMODE)		sim->measuring = 0;
+			else if (!sim->measuring)			sim_start(sim, now);		// forced (1 or 2) or first conversion of normal mode
+			break;
+
+		case 0xF5:
+			sim->regs[0xF5] = regs[i].value & 0xFD;		// bit 1 is reserved
+			break;
+		}
+	}
+
+	sim->writes++;
+	sim->bytes += 2 * count;
+}
+
+#endif /* BME280_USE_SIM */
@@ -0,0 +1,59 @@
+/*
+ * BME280_sim.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef BME280_BME280_SIM_H_
+#define BME280_BME280_SIM_H_
+
+#include "BME280.h"
+
+#if BME280_USE_SIM
+
+// --------------------------------------------------------- //
+// Register-level model of BME280 used as transport of driver:
+// chip id, soft reset, ctrl_hum / ctrl_meas / config registers, status bits,
+// calibration NVM and data registers. Conversions take typical measurement
+// time of active configuration, in normal mode they are repeated every
+// measurement time + standby time. Every conversion publishes next sample of
+// trace (raw ADC values), trace is replayed in loop.
+// IIR filter isn't modelled - samples of trace are published as they are.
+#define BME280_SIM_CHIP_ID		0x60
+#define BME280_SIM_RESET_US		2000	// time of NVM copying after reset (im_update bit is set)
+
+typedef struct {
+	uint32_t adc_T;			// raw temperature, 20 bit
+	uint32_t adc_P;			// raw pressure, 20 bit
+	uint16_t adc_H;			// raw humidity, 16 bit
+} BME280_SIM_SAMPLE;
+
+typedef struct {
+	uint8_t regs[256];					// register map
+	uint8_t osrs_h;						// humidity oversampling latched by write to ctrl_meas
+	uint8_t measuring;					// set "1" during conversion
+	uint32_t conv_end;					// end of current conversion [us]
+	uint32_t next_start;				// start of next conversion in normal mode [us]
+	uint32_t reset_end;					// end of NVM copying after reset [us]
+	uint32_t (*clock)(void);			// time source [us]
+
+	const BME280_SIM_SAMPLE *trace;		// samples published by conversions
+	uint16_t trace_len;
+	uint16_t trace_index;
+
+	// ----- statistics -----
+	uint32_t conversions;				// finished conversions
+	uint32_t reads;						// read transactions
+	uint32_t writes;					// write transactions
+	uint32_t bytes;						// bytes transferred in both directions
+} BME280_SIM;
+
+extern const BME280_TRANSPORT bme280_sim_transport;
+
+void BME280_Sim_Init(BME280_SIM *sim, const BME280_SIM_SAMPLE *trace, uint16_t trace_len, uint32_t (*clock)(void));	// power-on state, trace can be 0 -> constant sample
+void BME280_Init_Sim(BME280 *bmp, BME280_SIM *sim);		// prepare context of sensor connected to simulator
+
+#endif /* BME280_USE_SIM */
+
+#endif /* BME280_BME280_SIM_H_ */
@@ -0,0 +1,133 @@
+/*
+ * CLOCK.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "CLOCK.h"
+
+static volatile uint64_t clock_base;		// microseconds of all finished counter periods (and STOP mode time)
+static volatile uint64_t wakeup_time;		// requested wake-up [us]
+static volatile uint8_t wakeup_armed;
+
+static void clock_arm_compare(void);		// enable compare if wake-up is in current counter period
+
+
+void CLOCK_Conf(void)
+{
+	TIM_TimeBaseInitTypeDef TIM_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+
+	TIM_TimeBaseStructInit(&TIM_InitStructure);
+	TIM_InitStructure.TIM_Prescaler = CLOCK_TIM_CLOCK / 1000000 - 1;		// 1 tick = 1 us
+	TIM_InitStructure.TIM_Period = 0xFFFF;
+	TIM_InitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+	TIM_TimeBaseInit(TIM3, &TIM_InitStructure);
+
+	// TIM_TimeBaseInit generates update event to load prescaler, so flag have to be cleared
+	TIM_ClearITPendingBit(TIM3, TIM_IT_Update | TIM_IT_CC1);
+	TIM_ITConfig(TIM3, TIM_IT_Update, ENABLE);
+
+	NVIC_InitStructure.NVIC_IRQChannel = TIM3_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = CLOCK_IRQ_PRIORITY;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	TIM_Cmd(TIM3, ENABLE);
+}
+
+/****************************************************************************/
+/*      base of finished periods + counter; overflow which isn't served		*/
+/*      yet (interrupts masked) is added here								*/
+/****************************************************************************/
+uint64_t CLOCK_Now_us(void)
+{
+	uint64_t first, base;
+	uint16_t count;
+
+	do
+	{
+		first = clock_base;
+		base = first;
+		count = TIM3->CNT;
+
+		if (TIM3->SR & TIM_SR_UIF)
+		{
+			count = TIM3->CNT;		// value after overflow
+			base += 0x10000;
+		}
+	}
+	while (first != clock_base);	// overflow interrupt occurred in the meantime
+
+	return base + count;
+}
+
+uint32_t CLOCK_Now_ms(void)
+{
+	return (uint32_t)(CLOCK_Now_us() / 1000);
+}
+
+/****************************************************************************/
+/*      wake-up later than one counter period is armed by overflow			*/
+/*      interrupt of the period in which it is								*/
+/****************************************************************************/
+void CLOCK_Set_Wakeup(uint64_t time_us)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	wakeup_time = time_us;
+	wakeup_armed = 1;
+	clock_arm_compare();
+	__set_PRIMASK(primask);
+}
+
+void CLOCK_Advance(uint64_t time_us)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	clock_base += time_us;
+	__set_PRIMASK(primask);
+}
+
+/****************************************************************************/
+/*      called with interrupts masked or from TIM3 interrupt				*/
+/****************************************************************************/
+static void clock_arm_compare(void)
+{
+	uint64_t now;
+
+	TIM_ITConfig(TIM3, TIM_IT_CC1, DISABLE);
+	if (!wakeup_armed) return;
+
+	now = CLOCK_Now_us();
+	if (wakeup_time >= now + 0x10000) return;		// not in this period, overflow interrupt checks it again
+
+	TIM3->CCR1 = (uint16_t)(wakeup_time - clock_base);	// base isn't multiple of period after STOP mode (CLOCK_Advance)
+	TIM_ClearITPendingBit(TIM3, TIM_IT_CC1);
+	TIM_ITConfig(TIM3, TIM_IT_CC1, ENABLE);
+
+	if (wakeup_time <= now + 2) TIM_GenerateEvent(TIM3, TIM_EventSource_CC1);	// compare value could be passed already
+}
+
+__attribute__((interrupt)) void TIM3_IRQHandler(void)
+{
+	if (TIM_GetITStatus(TIM3, TIM_IT_Update) != RESET)
+	{
+		TIM_ClearITPendingBit(TIM3, TIM_IT_Update);
+		clock_base += 0x10000;
+		clock_arm_compare();
+	}
+
+	if (TIM_GetITStatus(TIM3, TIM_IT_CC1) != RESET)
+	{
+		TIM_ClearITPendingBit(TIM3, TIM_IT_CC1);
+		TIM_ITConfig(TIM3, TIM_IT_CC1, DISABLE);
+		wakeup_armed = 0;
+	}
+}
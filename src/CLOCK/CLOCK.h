@@ -0,0 +1,34 @@
+/*
+ * CLOCK.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef CLOCK_CLOCK_H_
+#define CLOCK_CLOCK_H_
+
+#include "stm32f10x.h"
+
+// --------------------------------------------------------- //
+// Monotonic time base: TIM3 counts microseconds and its 16-bit counter is
+// extended by number of overflows (interrupt every 65,5 ms) to 64 bits.
+// Channel 1 compare of TIM3 gives wake-up at any time in the future, so in
+// tickless mode the 1 ms SysTick interrupt isn't needed: scheduler timers
+// are counted from this clock and CPU is woken up for the nearest one.
+// Overflow interrupt still wakes CPU from WFI about 15 times per second
+// even when nothing is to do, so idle isn't fully tickless.
+// CLOCK_Conf() has to be called after NVIC_PriorityGroupConfig(): NVIC_Init
+// encodes priority by the current group and with reset value of group
+// CLOCK_IRQ_PRIORITY is lost (priority 0).
+#define CLOCK_TICKLESS		1			// 1 -> no periodic SysTick, 0 -> SysTick every 1 ms counts scheduler timers
+#define CLOCK_TIM_CLOCK		72000000	// TIM3 clock (PCLK1 = 36 MHz, timer clock is doubled)
+#define CLOCK_IRQ_PRIORITY	1			// overflow has to be counted before the next one (65,5 ms)
+
+void CLOCK_Conf(void);
+uint64_t CLOCK_Now_us(void);				// microseconds from CLOCK_Conf()
+uint32_t CLOCK_Now_ms(void);				// milliseconds from CLOCK_Conf()
+void CLOCK_Set_Wakeup(uint64_t time_us);	// TIM3 interrupt at time_us (only wakes CPU up), previous one is cancelled
+void CLOCK_Advance(uint64_t time_us);		// add time when TIM3 was stopped (STOP mode)
+
+#endif /* CLOCK_CLOCK_H_ */
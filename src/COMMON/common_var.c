@@ -23,3 +23,19 @@ uint32_t my_abs_uint(uint32_t x)
 {
     return x < 0 ? -x : x;
 }
+
+/****************************************************************************/
+/*      system time in microseconds (lower part of 64-bit clock of TIM3)    */
+/****************************************************************************/
+uint32_t get_time_us(void)
+{
+	return (uint32_t)CLOCK_Now_us();
+}
+
+/****************************************************************************/
+/*      system time in milliseconds								            */
+/****************************************************************************/
+uint32_t get_time_ms(void)
+{
+	return CLOCK_Now_ms();
+}
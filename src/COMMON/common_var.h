@@ -9,13 +9,19 @@
 #define COMMON_VAR_H_
 
 #include "stm32f10x.h"
-
-uint32_t source_time;
-
-
+#include "../CLOCK/CLOCK.h"
 
 
 int my_abs(int x);
 uint32_t my_abs_uint(uint32_t x);
+uint32_t get_time_us(void);		// system time in microseconds, wraps after 71 minutes
+uint32_t get_time_ms(void);		// system time in milliseconds
+
+// division by 100 as multiplication by reciprocal (UMULL + shift instead of UDIV),
+// exact for whole uint32_t range
+static inline uint32_t udiv100(uint32_t x)
+{
+	return (uint32_t)(((uint64_t)x * 0x51EB851FULL) >> 37);
+}
 
 #endif /* COMMON_VAR_H_ */
@@ -0,0 +1,37 @@
+/*
+ * FILTER.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "FILTER.h"
+
+/****************************************************************************/
+/*      prepare empty window, buffer has to contain at least size samples	*/
+/****************************************************************************/
+void moving_avg_init(MOVING_AVG *filter, int32_t *buffer, uint16_t size)
+{
+	filter->samples = buffer;
+	filter->size	= size ? size : 1;
+	filter->index	= 0;
+	filter->count	= 0;
+	filter->sum		= 0;
+}
+
+/****************************************************************************/
+/*      add sample and return average of window								*/
+/*      the oldest sample is replaced, so only one subtraction is needed	*/
+/****************************************************************************/
+int32_t moving_avg_update(MOVING_AVG *filter, int32_t sample)
+{
+	if (filter->count < filter->size)	filter->count++;
+	else								filter->sum -= filter->samples[filter->index];
+
+	filter->samples[filter->index] = sample;
+	filter->sum += sample;
+
+	if (++filter->index == filter->size) filter->index = 0;
+
+	return filter->sum / filter->count;
+}
@@ -0,0 +1,29 @@
+/*
+ * FILTER.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef FILTER_FILTER_H_
+#define FILTER_FILTER_H_
+
+#include "stm32f10x.h"
+
+// --------------------------------------------------------- //
+// running-window average: samples are kept in circular buffer
+// and sum of the window is updated, so one update costs O(1)
+// independently of window size.
+// Sum of the whole window have to fit into int32_t.
+typedef struct {
+	int32_t  *samples;		// circular buffer of samples, provided by caller
+	uint16_t size;			// window size (number of samples used for average)
+	uint16_t index;			// position of the oldest sample (next one to overwrite)
+	uint16_t count;			// number of collected samples, up to size
+	int32_t  sum;			// sum of samples in window
+} MOVING_AVG;
+
+void moving_avg_init(MOVING_AVG *filter, int32_t *buffer, uint16_t size);	// prepare empty window
+int32_t moving_avg_update(MOVING_AVG *filter, int32_t sample);				// add sample and return average of window
+
+#endif /* FILTER_FILTER_H_ */
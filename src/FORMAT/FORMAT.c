@@ -0,0 +1,124 @@
+/*
+ * FORMAT.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "FORMAT.h"
+
+// two ASCII digits for every value 0 .. 99
+static const char digit_pairs[200] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static const uint32_t powers_of_10[9] = {10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+static uint8_t count_digits(uint32_t value);					// number of decimal digits of value
+static char *put_digits(char *end, uint32_t value);			// write value backward from end, return its first character
+
+
+/****************************************************************************/
+/*      number of decimal digits, comparisons only							*/
+/****************************************************************************/
+static uint8_t count_digits(uint32_t value)
+{
+	uint8_t n = 1;
+
+	while (n < 10 && value >= powers_of_10[n - 1]) n++;
+
+	return n;
+}
+
+/****************************************************************************/
+/*      write value backward from end: two digits per udiv100				*/
+/****************************************************************************/
+static char *put_digits(char *end, uint32_t value)
+{
+	uint32_t q, pair;
+
+	while (value >= 100)
+	{
+		q		= udiv100(value);
+		pair	= (value - q * 100) << 1;
+		*--end	= digit_pairs[pair + 1];
+		*--end	= digit_pairs[pair];
+		value	= q;
+	}
+
+	if (value >= 10)
+	{
+		pair	= value << 1;
+		*--end	= digit_pairs[pair + 1];
+		*--end	= digit_pairs[pair];
+	}
+	else
+	{
+		*--end	= '0' + value;
+	}
+
+	return end;
+}
+
+/****************************************************************************/
+/*      integer as "[-]I", buffer of FORMAT_INT_MAX bytes is always enough	*/
+/****************************************************************************/
+uint8_t FORMAT_Int(char *buf, int32_t value)
+{
+	uint32_t abs_value = (value < 0) ? -(uint32_t)value : (uint32_t)value;
+	uint8_t len = count_digits(abs_value) + (value < 0);
+
+	buf[len] = '\0';
+	put_digits(&buf[len], abs_value);
+	if (value < 0) buf[0] = '-';
+
+	return len;
+}
+
+/****************************************************************************/
+/*      unsigned integer as "I", buffer of FORMAT_UINT_MAX bytes			*/
+/****************************************************************************/
+uint8_t FORMAT_Uint(char *buf, uint32_t value)
+{
+	uint8_t len = count_digits(value);
+
+	buf[len] = '\0';
+	put_digits(&buf[len], value);
+
+	return len;
+}
+
+/****************************************************************************/
+/*      fixed-point value x 0,01 as "[-]I,FF", at least one integer digit,	*/
+/*      left padded with spaces up to width characters; buffer has to		*/
+/*      contain max(width + 1, FORMAT_FIXED2_MAX) bytes						*/
+/****************************************************************************/
+uint8_t FORMAT_Fixed2(char *buf, int32_t value, uint8_t width)
+{
+	uint32_t abs_value, integer, pair;
+	uint8_t len, pad, total;
+	char *p;
+
+	abs_value	= (value < 0) ? -(uint32_t)value : (uint32_t)value;
+	integer		= udiv100(abs_value);
+	pair		= (abs_value - integer * 100) << 1;
+
+	len = count_digits(integer) + 3 + (value < 0);
+	pad = (width > len) ? width - len : 0;
+	total = pad + len;
+
+	p = &buf[total];
+	*p		= '\0';
+	*--p	= digit_pairs[pair + 1];
+	*--p	= digit_pairs[pair];
+	*--p	= ',';
+	p = put_digits(p, integer);
+	if (value < 0) *--p = '-';
+
+	while (pad) buf[--pad] = ' ';
+
+	return total;
+}
@@ -0,0 +1,27 @@
+/*
+ * FORMAT.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef FORMAT_FORMAT_H_
+#define FORMAT_FORMAT_H_
+
+#include "stm32f10x.h"
+#include "../COMMON/common_var.h"
+
+// --------------------------------------------------------- //
+// decimal formatting of integers and fixed-point values x 0,01 into buffer
+// given by caller: no libc, no allocation, two digits are produced per
+// multiplication by reciprocal of 100 (no division instructions).
+// Every function writes terminating zero and returns length without it.
+#define FORMAT_INT_MAX		12		// "-2147483648" + zero
+#define FORMAT_UINT_MAX		11		// "4294967295" + zero
+#define FORMAT_FIXED2_MAX	13		// "-21474836,48" + zero
+
+uint8_t FORMAT_Int(char *buf, int32_t value);							// value as "[-]I"
+uint8_t FORMAT_Uint(char *buf, uint32_t value);							// value as "I", whole range of uint32_t
+uint8_t FORMAT_Fixed2(char *buf, int32_t value, uint8_t width);		// value x 0,01 as "[-]I,FF", padded with spaces to width
+
+#endif /* FORMAT_FORMAT_H_ */
@@ -0,0 +1,108 @@
+/*
+ * HISTOGRAM.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "HISTOGRAM.h"
+#include <string.h>
+#include "../FORMAT/FORMAT.h"
+
+static void histogram_print_value(void (*print)(const char *str), const char *label, uint32_t value);
+
+
+void histogram_reset(HISTOGRAM *hist)
+{
+	memset(hist, 0, sizeof(*hist));
+}
+
+/****************************************************************************/
+/*      bin is number of significant bits of value							*/
+/****************************************************************************/
+void histogram_add(HISTOGRAM *hist, uint32_t value)
+{
+	uint8_t bin = value ? 32 - __builtin_clz(value) : 0;
+
+	if (bin >= HISTOGRAM_BINS) bin = HISTOGRAM_BINS - 1;
+	hist->bins[bin]++;
+
+	if (!hist->count || value < hist->min) hist->min = value;
+	if (value > hist->max) hist->max = value;
+	hist->sum += value;
+	hist->count++;
+}
+
+/****************************************************************************/
+/*      value below which per_mille of samples are, with resolution			*/
+/*      of bin (upper bound of bin is returned)								*/
+/****************************************************************************/
+uint32_t histogram_percentile(const HISTOGRAM *hist, uint16_t per_mille)
+{
+	uint32_t rank, sum = 0, bound;
+
+	if (!hist->count) return 0;
+
+	rank = (uint32_t)(((uint64_t)hist->count * per_mille + 999) / 1000);
+	if (!rank) rank = 1;
+
+	for (uint8_t i = 0; i < HISTOGRAM_BINS - 1; i++)
+	{
+		sum += hist->bins[i];
+		if (sum < rank) continue;
+
+		bound = (1UL << i) - 1;
+		return (bound < hist->max) ? bound : hist->max;
+	}
+	return hist->max;
+}
+
+/****************************************************************************/
+/*      name  count / min / mean / max / jitter / p50 / p99					*/
+/*        <2^k:count for every not empty bin								*/
+/****************************************************************************/
+void histogram_report(const HISTOGRAM *hist, const char *name, void (*print)(const char *str))
+{
+	char buf[FORMAT_INT_MAX];
+
+	print(name);
+	histogram_print_value(print, "", hist->count);
+	if (hist->count)
+	{
+		histogram_print_value(print, " / ", hist->min);
+		histogram_print_value(print, " / ", (uint32_t)(hist->sum / hist->count));
+		histogram_print_value(print, " / ", hist->max);
+		histogram_print_value(print, " / ", hist->max - hist->min);
+		histogram_print_value(print, " / ", histogram_percentile(hist, 500));
+		histogram_print_value(print, " / ", histogram_percentile(hist, 990));
+	}
+	print("\n\r ");
+
+	for (uint8_t i = 0; i < HISTOGRAM_BINS; i++)
+	{
+		if (!hist->bins[i]) continue;
+
+		if (i < HISTOGRAM_BINS - 1)
+		{
+			FORMAT_Int(buf, i);
+			print(" <2^");
+		}
+		else
+		{
+			FORMAT_Int(buf, i - 1);		// the last bin has no upper bound
+			print(" >=2^");
+		}
+		print(buf);
+		histogram_print_value(print, ":", hist->bins[i]);
+	}
+	print("\n\r");
+}
+
+static void histogram_print_value(void (*print)(const char *str), const char *label, uint32_t value)
+{
+	char buf[FORMAT_UINT_MAX];
+
+	print(label);
+	FORMAT_Uint(buf, value);
+	print(buf);
+}
@@ -0,0 +1,34 @@
+/*
+ * HISTOGRAM.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef HISTOGRAM_HISTOGRAM_H_
+#define HISTOGRAM_HISTOGRAM_H_
+
+#include "stm32f10x.h"
+
+// --------------------------------------------------------- //
+// histogram of times with logarithmic bins: bin 0 counts 0 us, bin k counts
+// values from 2^(k-1) to 2^k - 1 us, the last bin counts everything above.
+// Bin is the position of the highest set bit, so one sample costs O(1)
+// (one CLZ instruction) and memory is fixed. Count, min, max and sum are kept
+// exactly, so mean and jitter (max - min) don't depend on bin width.
+#define HISTOGRAM_BINS	26		// the last bin: >= 2^24 us (16,8 s)
+
+typedef struct {
+	uint32_t bins[HISTOGRAM_BINS];
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+} HISTOGRAM;
+
+void histogram_reset(HISTOGRAM *hist);
+void histogram_add(HISTOGRAM *hist, uint32_t value);
+uint32_t histogram_percentile(const HISTOGRAM *hist, uint16_t per_mille);		// upper bound of bin with given percentile (limited to max)
+void histogram_report(const HISTOGRAM *hist, const char *name, void (*print)(const char *str));	// summary line and line of not empty bins
+
+#endif /* HISTOGRAM_HISTOGRAM_H_ */
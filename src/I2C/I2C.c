@@ -1,5 +1,33 @@
 #include "I2C.h"
 
+#if BME280_I2C
+	typedef enum {
+		i2c_idle,			// no transaction in progress
+		i2c_start,			// waiting for SB, next: device address for write
+		i2c_addr_w,			// waiting for ADDR, next: register address
+		i2c_reg_sent,		// waiting for BTF of register address, next: repeated START
+		i2c_restart,		// waiting for SB, next: device address for read
+		i2c_addr_r,			// waiting for ADDR, next: receiving data
+		i2c_data_r,			// receiving data bytes (RXNE)
+		i2c_data_w,			// sending data bytes (TXE)
+		i2c_stop_w			// waiting for BTF of last byte, next: STOP
+	} I2C_STATE;
+
+	static I2C_TRANSACTION i2c_queue[I2C_QUEUE_SIZE];
+	static volatile uint8_t i2c_head;		// index of first free slot
+	static volatile uint8_t i2c_tail;		// index of transaction in progress
+	static volatile I2C_STATE i2c_state;
+	static uint8_t i2c_index;				// number of transferred data bytes
+	static uint16_t i2c_speed;				// SCK speed saved for reinitialization after bus recovery
+
+	static void I2C_Start_Next(void);
+	static void I2C_Finish(I2C_STATUS status);
+	static void I2C_Bus_Recovery(void);
+	static I2C_STATUS I2C_Wait(volatile I2C_STATUS *status);
+	void I2C1_EV_IRQHandler(void);
+	void I2C1_ER_IRQHandler(void);
+#endif
+
 #if BME280_I2C
 	void I2C_Conf(uint16_t SCK_speed)
 	{
@@ -33,88 +61,369 @@
 
 		I2C_Init(I2C1, &I2CInit);
 		I2C_Cmd(I2C1, ENABLE);
+
+		i2c_speed = SCK_speed;
+
+		// Event and error interrupts drive transactions
+		NVIC_InitTypeDef NVIC_InitStructure;
+		NVIC_InitStructure.NVIC_IRQChannel = I2C1_EV_IRQn;
+		NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+		NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+		NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+		NVIC_Init(&NVIC_InitStructure);
+
+		NVIC_InitStructure.NVIC_IRQChannel = I2C1_ER_IRQn;
+		NVIC_Init(&NVIC_InitStructure);
 	}
 #endif
 
 #if BME280_I2C
-	//Ustawienie adresu pamici
-	void I2C_ADDRES(uint8_t SLA, uint32_t addr)
+
+	#define I2C_RECOVERY_DELAY	60		// half period of SCL during bus recovery (about 5 us)
+
+	/****************************************************************************/
+	/*      Put transaction into queue and start it if bus is free				*/
+	/****************************************************************************/
+	static I2C_STATUS I2C_Queue(uint8_t SLA, uint8_t addr, uint8_t read, uint8_t size, uint8_t *data,
+								void (*callback)(I2C_STATUS status), volatile I2C_STATUS *status)
 	{
-	 //Rozpoczcie komunikacji
-	 I2C_GenerateSTART(I2C1, ENABLE);
-	 //Czekanie a polecenie zostanie wykonane
-	 while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT) != SUCCESS);
-	 //W tym kroku wysany jest identyfikator ukadu
-	 I2C_Send7bitAddress(I2C1, SLA, I2C_Direction_Transmitter);
-	 //Odczekanie na odpowied
-	 while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED) != SUCCESS);
-
-	 //Wysanie adresu komrki pamici do/z jakiej bd zapisywane/odczytywane dane.
-	 I2C_SendData(I2C1, addr);
-	 while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTING) != SUCCESS);
+		I2C_TRANSACTION *t;
+		uint8_t tmp_head;
+		uint32_t primask;
+
+		if ((size == 0) || (!read && (size > I2C_WRITE_BUF_SIZE))) return i2c_invalid;
 
+		// slot is reserved and filled in one critical section, transactions are queued also from interrupts
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		tmp_head = (i2c_head + 1) % I2C_QUEUE_SIZE;
+		if (tmp_head == i2c_tail)
+		{
+			__set_PRIMASK(primask);
+			return i2c_queue_full;
+		}
+
+		t = &i2c_queue[i2c_head];
+		t->SLA		= SLA;
+		t->addr		= addr;
+		t->read		= read;
+		t->size		= size;
+		t->data		= data;
+		t->status	= status;
+		t->callback = callback;
+		if (!read) memcpy(t->wbuf, data, size);
+
+		i2c_head = tmp_head;
+		if (i2c_state == i2c_idle) I2C_Start_Next();
+
+		__set_PRIMASK(primask);
+
+		return i2c_ok;
 	}
-#endif
 
-#if BME280_I2C
-	//Odczyt z pamici
-	void I2C_READ(uint8_t SLA, uint32_t addr,  int size, void* data)
+	/****************************************************************************/
+	/*      Queue write transaction, callback is called from interrupt			*/
+	/****************************************************************************/
+	I2C_STATUS I2C_WRITE_IT(uint8_t SLA, uint8_t addr, uint8_t size, const uint8_t *data, void (*callback)(I2C_STATUS status))
 	{
-		  //Deklaracja zmiennych
-		  int i;
-		  uint8_t* buffer = (uint8_t*)data;
-
-		  //Wybr adresu urzdzenia
-		  I2C_ADDRES(SLA, addr);
-
-		  //Wysanie sygnau start, nastpnie czekanie na odpowied
-		  I2C_GenerateSTART(I2C1, ENABLE);
-		  while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT) != SUCCESS);
-
-		  //Odbir tylko jednego bajtu, wlacz potwierdzenie
-		  I2C_AcknowledgeConfig(I2C1, ENABLE);
-		  //Wysanie adresu ukadu, ustawienie i2c jako master w trybie received mode
-		  I2C_Send7bitAddress(I2C1, SLA, I2C_Direction_Receiver);
-		  //Odczekanie na EV6
-		  while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED) != SUCCESS);
-
-		  for (i = 0; i < size - 1; i++)
-		  {
-		   while(I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_RECEIVED) != SUCCESS);
-		   buffer[i] = I2C_ReceiveData(I2C1);
-		  }
-		  //Odbir pojedyczego bajtu
-		  I2C_AcknowledgeConfig(I2C1, DISABLE);
-
-		  //Wygenerowanie sygnau stop
-		  I2C_GenerateSTOP(I2C1, ENABLE);
-		  //Odczekanie na sygna
-		  while(I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_RECEIVED) != SUCCESS);
-		  //Odczytaj dane z rejestru
-		  buffer[i] = I2C_ReceiveData(I2C1);
+		return I2C_Queue(SLA, addr, 0, size, (uint8_t *)data, callback, 0);
 	}
-#endif
 
+	/****************************************************************************/
+	/*      Queue read transaction, callback is called from interrupt			*/
+	/****************************************************************************/
+	I2C_STATUS I2C_READ_IT(uint8_t SLA, uint8_t addr, uint8_t size, uint8_t *data, void (*callback)(I2C_STATUS status))
+	{
+		return I2C_Queue(SLA, addr, 1, size, data, callback, 0);
+	}
 
-#if BME280_I2C
-	//Zapis do pamici
-	void I2C_WRITE(uint8_t SLA, uint32_t addr, int size, const void* data)
+	/****************************************************************************/
+	/*      Blocking write, waiting is limited by I2C_TIMEOUT_MS				*/
+	/****************************************************************************/
+	I2C_STATUS I2C_WRITE(uint8_t SLA, uint32_t addr, int size, const void* data)
+	{
+		volatile I2C_STATUS status = i2c_busy;
+		I2C_STATUS result;
+
+		do result = I2C_Queue(SLA, addr, 0, size, (uint8_t *)data, 0, &status);
+		while (result == i2c_queue_full);
+
+		if (result != i2c_ok) return result;
+
+		return I2C_Wait(&status);
+	}
+
+	/****************************************************************************/
+	/*      Blocking read, waiting is limited by I2C_TIMEOUT_MS					*/
+	/****************************************************************************/
+	I2C_STATUS I2C_READ(uint8_t SLA, uint32_t addr,  int size, void* data)
+	{
+		volatile I2C_STATUS status = i2c_busy;
+		I2C_STATUS result;
+
+		do result = I2C_Queue(SLA, addr, 1, size, (uint8_t *)data, 0, &status);
+		while (result == i2c_queue_full);
+
+		if (result != i2c_ok) return result;
+
+		return I2C_Wait(&status);
+	}
+
+	/****************************************************************************/
+	/*      Wait for end of blocking transaction. Deadline is checked here,		*/
+	/*      not only by SysTick, and when I2C interrupts can't preempt the		*/
+	/*      caller (interrupts masked or caller is an interrupt handler) the		*/
+	/*      state machine is driven by polling of its handlers					*/
+	/****************************************************************************/
+	static I2C_STATUS I2C_Wait(volatile I2C_STATUS *status)
+	{
+		uint32_t primask;
+		uint8_t polling;
+
+		while (*status == i2c_busy)
+		{
+			primask = __get_PRIMASK();
+			polling = primask || (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk);
+
+			__disable_irq();
+			if (polling && (i2c_state != i2c_idle))
+			{
+				if (I2C1->SR1 & (I2C_SR1_AF | I2C_SR1_ARLO | I2C_SR1_BERR | I2C_SR1_OVR)) I2C1_ER_IRQHandler();
+				else I2C1_EV_IRQHandler();
+			}
+			I2C_Timeout_Check();
+			__set_PRIMASK(primask);
+		}
+		return *status;
+	}
+
+	/****************************************************************************/
+	/*      Abort transaction which passed its deadline and recover the bus		*/
+	/****************************************************************************/
+	void I2C_Timeout_Check(void)
+	{
+		if (i2c_state == i2c_idle) return;
+		if ((int32_t)(get_time_ms() - i2c_queue[i2c_tail].deadline) < 0) return;
+
+		I2C_Bus_Recovery();
+		I2C_Finish(i2c_timeout);
+	}
+
+	/****************************************************************************/
+	/*      Start first transaction from queue									*/
+	/****************************************************************************/
+	static void I2C_Start_Next(void)
 	{
-	  int i;
-	  const uint8_t* buffer = (uint8_t*)data;
-
-	  //Wybr adresu urzdzenia
-	  I2C_ADDRES(SLA, addr);
-
-	  //Przejcie przez cay buffor z danymi
-	  for (i = 0; i < size; i++)
-	  {
-	   I2C_SendData(I2C1, buffer[i]);
-	   //while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTING) != SUCCESS);
-	   while (I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED) != SUCCESS);
-	  }
-	  //Wygenerowanie sygnau Stop
-	  I2C_GenerateSTOP(I2C1, ENABLE);
+		if (i2c_tail == i2c_head) return;
+
+		// transfer time of address, register, repeated START and data bytes (9 bits each) at SCK = 100 * i2c_speed Hz
+		i2c_queue[i2c_tail].deadline = get_time_ms() + I2C_TIMEOUT_MS + (uint32_t)(i2c_queue[i2c_tail].size + 3) * 9 * 10 / i2c_speed;
+		i2c_index = 0;
+		i2c_state = i2c_start;
+
+		I2C_AcknowledgeConfig(I2C1, ENABLE);
+		I2C_ITConfig(I2C1, I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+		I2C_GenerateSTART(I2C1, ENABLE);
+	}
+
+	/****************************************************************************/
+	/*      Finish transaction in progress and start next one					*/
+	/****************************************************************************/
+	static void I2C_Finish(I2C_STATUS status)
+	{
+		volatile I2C_STATUS *result = i2c_queue[i2c_tail].status;
+		void (*callback)(I2C_STATUS status) = i2c_queue[i2c_tail].callback;
+
+		I2C_ITConfig(I2C1, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
+		i2c_state = i2c_idle;
+		i2c_tail = (i2c_tail + 1) % I2C_QUEUE_SIZE;
+
+		if (result)   *result = status;
+		if (callback) callback(status);
+
+		I2C_Start_Next();
+	}
+
+	/****************************************************************************/
+	/*      Release slave which holds SDA low and reinitialize I2C1				*/
+	/****************************************************************************/
+	static void I2C_Bus_Recovery(void)
+	{
+		GPIO_InitTypeDef GPIOInit;
+		volatile uint16_t delay;
+		uint8_t i;
+
+		I2C_ITConfig(I2C1, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
+		I2C_Cmd(I2C1, DISABLE);
+
+		// SCL and SDA as GPIO open-drain outputs, both released
+		GPIO_SetBits(GPIOB, GPIO_Pin_6 | GPIO_Pin_7);
+		GPIOInit.GPIO_Pin = GPIO_Pin_6 | GPIO_Pin_7;
+		GPIOInit.GPIO_Mode = GPIO_Mode_Out_OD;
+		GPIOInit.GPIO_Speed = GPIO_Speed_50MHz;
+		GPIO_Init(GPIOB, &GPIOInit);
+
+		// up to 9 clock pulses, slave releases SDA after it finishes interrupted byte
+		for (i = 0; i < 9; i++)
+		{
+			if (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_7)) break;
+
+			GPIO_ResetBits(GPIOB, GPIO_Pin_6);
+			for (delay = 0; delay < I2C_RECOVERY_DELAY; delay++);
+			GPIO_SetBits(GPIOB, GPIO_Pin_6);
+			for (delay = 0; delay < I2C_RECOVERY_DELAY; delay++);
+		}
+
+		// STOP condition: SDA goes high while SCL is high
+		GPIO_ResetBits(GPIOB, GPIO_Pin_7);
+		for (delay = 0; delay < I2C_RECOVERY_DELAY; delay++);
+		GPIO_SetBits(GPIOB, GPIO_Pin_7);
+		for (delay = 0; delay < I2C_RECOVERY_DELAY; delay++);
+
+		// software reset clears BUSY flag latched by peripheral
+		I2C_SoftwareResetCmd(I2C1, ENABLE);
+		I2C_SoftwareResetCmd(I2C1, DISABLE);
+
+		I2C_Conf(i2c_speed);
+	}
+
+	/****************************************************************************/
+	/*      Event interrupt -> state machine of transaction in progress			*/
+	/****************************************************************************/
+	__attribute__((interrupt)) void I2C1_EV_IRQHandler(void)
+	{
+		I2C_TRANSACTION *t = &i2c_queue[i2c_tail];
+		uint16_t sr1 = I2C1->SR1;
+
+		switch (i2c_state)
+		{
+		case i2c_start:
+			if (sr1 & I2C_SR1_SB)
+			{
+				I2C_Send7bitAddress(I2C1, t->SLA, I2C_Direction_Transmitter);
+				i2c_state = i2c_addr_w;
+			}
+			break;
+
+		case i2c_addr_w:
+			if (sr1 & I2C_SR1_ADDR)
+			{
+				(void)I2C1->SR2;					// reading SR2 after SR1 clears ADDR
+				I2C_SendData(I2C1, t->addr);
+
+				if (t->read)
+				{
+					i2c_state = i2c_reg_sent;
+				}
+				else
+				{
+					i2c_state = i2c_data_w;
+					I2C_ITConfig(I2C1, I2C_IT_BUF, ENABLE);
+				}
+			}
+			break;
+
+		case i2c_reg_sent:
+			if (sr1 & I2C_SR1_BTF)
+			{
+				I2C_GenerateSTART(I2C1, ENABLE);
+				i2c_state = i2c_restart;
+			}
+			break;
+
+		case i2c_restart:
+			if (sr1 & I2C_SR1_SB)
+			{
+				I2C_Send7bitAddress(I2C1, t->SLA, I2C_Direction_Receiver);
+				i2c_state = i2c_addr_r;
+			}
+			break;
+
+		case i2c_addr_r:
+			if (sr1 & I2C_SR1_ADDR)
+			{
+				if (t->size == 1)
+				{
+					// single byte: NACK and STOP have to be set before ADDR is cleared
+					I2C_AcknowledgeConfig(I2C1, DISABLE);
+					(void)I2C1->SR2;
+					I2C_GenerateSTOP(I2C1, ENABLE);
+				}
+				else
+				{
+					(void)I2C1->SR2;
+				}
+				i2c_state = i2c_data_r;
+				I2C_ITConfig(I2C1, I2C_IT_BUF, ENABLE);
+			}
+			break;
+
+		case i2c_data_r:
+			if (sr1 & I2C_SR1_RXNE)
+			{
+				t->data[i2c_index++] = I2C_ReceiveData(I2C1);
+
+				if ((t->size - i2c_index) == 1)
+				{
+					// last byte is being received -> answer with NACK and finish with STOP
+					I2C_AcknowledgeConfig(I2C1, DISABLE);
+					I2C_GenerateSTOP(I2C1, ENABLE);
+				}
+				else if (i2c_index == t->size)
+				{
+					I2C_Finish(i2c_ok);
+				}
+			}
+			break;
+
+		case i2c_data_w:
+			if (sr1 & I2C_SR1_TXE)
+			{
+				if (i2c_index < t->size)
+				{
+					I2C_SendData(I2C1, t->wbuf[i2c_index++]);
+				}
+				else
+				{
+					// all bytes are in shift register, wait for BTF before STOP
+					I2C_ITConfig(I2C1, I2C_IT_BUF, DISABLE);
+					i2c_state = i2c_stop_w;
+				}
+			}
+			break;
+
+		case i2c_stop_w:
+			if (sr1 & I2C_SR1_BTF)
+			{
+				I2C_GenerateSTOP(I2C1, ENABLE);
+				I2C_Finish(i2c_ok);
+			}
+			break;
+
+		default:
+			I2C_ITConfig(I2C1, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
+			break;
+		}
+	}
+
+	/****************************************************************************/
+	/*      Error interrupt -> NACK, arbitration lost, bus error				*/
+	/****************************************************************************/
+	__attribute__((interrupt)) void I2C1_ER_IRQHandler(void)
+	{
+		uint16_t sr1 = I2C1->SR1;
+		I2C_STATUS status = i2c_bus_error;
+
+		if (sr1 & I2C_SR1_AF)	status = i2c_nack;
+		if (sr1 & I2C_SR1_ARLO) status = i2c_arbitration_lost;
+
+		I2C_ClearITPendingBit(I2C1, I2C_IT_AF | I2C_IT_ARLO | I2C_IT_BERR | I2C_IT_OVR);
+
+		// after arbitration loss interface is switched to slave mode, so STOP isn't generated
+		if (status != i2c_arbitration_lost) I2C_GenerateSTOP(I2C1, ENABLE);
+
+		if (i2c_state != i2c_idle) I2C_Finish(status);
 	}
 
 #endif
@@ -11,10 +11,33 @@
 #include "../BME280/BME280.h"
 
 #if BME280_I2C
+	#define I2C_QUEUE_SIZE		4		// number of transactions waiting for the bus
+	#define I2C_WRITE_BUF_SIZE	16		// maximum number of data bytes in one write transaction
+	#define I2C_TIMEOUT_MS		5		// margin over transfer time of one transaction at configured speed [ms]
+
+	typedef enum {i2c_ok = 0, i2c_busy = 1, i2c_nack = 2, i2c_arbitration_lost = 3, i2c_bus_error = 4, i2c_timeout = 5, i2c_queue_full = 6, i2c_invalid = 7} I2C_STATUS;
+
+	typedef struct {
+		uint8_t  SLA;								// device address
+		uint8_t  addr;								// register address
+		uint8_t  read;								// "1" - read transaction, "0" - write transaction
+		uint8_t  size;								// number of data bytes
+		uint8_t  *data;								// destination buffer of read transaction
+		uint8_t  wbuf[I2C_WRITE_BUF_SIZE];			// copy of data bytes of write transaction
+		uint32_t deadline;							// transaction is aborted when get_time_ms() passes this value
+		volatile I2C_STATUS *status;				// if not 0, final status is saved here
+		void (*callback)(I2C_STATUS status);		// if not 0, called from interrupt when transaction is finished
+	} I2C_TRANSACTION;
+
 	void I2C_Conf(uint16_t SCK_speed);
-	void I2C_ADDRES(uint8_t SLA, uint32_t addr);
-	void I2C_WRITE(uint8_t SLA, uint32_t addr, int size, const void* data);
-	void I2C_READ(uint8_t SLA, uint32_t addr,  int size, void* data);
+	// blocking calls are bounded by transfer time + I2C_TIMEOUT_MS per transaction and can be used also from interrupts
+	// or with interrupts masked (state machine is polled then)
+	I2C_STATUS I2C_WRITE(uint8_t SLA, uint32_t addr, int size, const void* data);		// blocking write
+	I2C_STATUS I2C_READ(uint8_t SLA, uint32_t addr,  int size, void* data);			// blocking read
+
+	I2C_STATUS I2C_WRITE_IT(uint8_t SLA, uint8_t addr, uint8_t size, const uint8_t *data, void (*callback)(I2C_STATUS status));	// queue write transaction
+	I2C_STATUS I2C_READ_IT(uint8_t SLA, uint8_t addr, uint8_t size, uint8_t *data, void (*callback)(I2C_STATUS status));			// queue read transaction
+	void I2C_Timeout_Check(void);	// abort transaction which passed its deadline and recover the bus, call it every 1 ms
 #endif
 
 #endif /* I2C_H_ */
@@ -0,0 +1,367 @@
+/*
+ * MEASURE.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "MEASURE.h"
+
+static BME280 *measure_sensors[MEASURE_MAX_SENSORS];
+static uint8_t measure_count;
+static volatile uint8_t measure_index;		// next sensor to read
+static volatile uint8_t measure_busy;
+static void (*measure_callback)(BME280 *bme);	// data of sensor are ready
+
+static MEASURE_LATENCY measure_latency[MEASURE_MAX_SENSORS];
+static uint32_t measure_trigger_time;		// time of MEASURE_Start() [us]
+static uint32_t measure_read_time;			// start of current read [us]
+#if PROFILE_ENABLE
+static uint32_t measure_read_ticks;			// start of current read for PROFILE_READ
+#endif
+static uint32_t measure_last_data[MEASURE_MAX_SENSORS];	// time of previous sample [us]
+static uint8_t measure_has_data;			// bit n - sensor n has previous sample
+static uint8_t measure_retries;				// retries of current sensor
+static MEASURE_STATS measure_stats;
+
+typedef enum {stream_off = 0, stream_sync = 1, stream_run = 2} STREAM_STATE;
+
+#define STREAM_READ_REG		0xF3			// status register, data registers follow it
+#define STREAM_READ_SIZE	(0xFF - STREAM_READ_REG)
+#define STREAM_DATA			(0xF7 - STREAM_READ_REG)	// offset of data registers in read burst
+
+static struct {
+	BME280 *bme;
+	volatile uint8_t state;
+	uint8_t status;							// status register read during phase search
+	uint8_t measuring;						// previous state of measuring bit
+	uint8_t regs[STREAM_READ_SIZE];			// status, control and data registers read in current cycle
+	uint8_t synced;							// the first read after phase search, its conversion is new
+	uint16_t since_sync;					// samples from last phase search
+	uint32_t read_offset;					// end of conversion -> read [us], middle of standby time
+	uint8_t index;							// index of sensor in latency table, MEASURE_MAX_SENSORS if it isn't registered
+	MEASURE_STREAM_STATS stats;
+} stream;
+
+static void measure_read_next(void);		// start reading of next sensor, called from interrupts
+static void measure_read_done(void);		// data of current sensor are ready
+static void stream_sync_start(void);		// start search of end of conversion
+static void stream_poll(void);				// read status register
+static void stream_poll_done(void);			// check measuring bit
+static void stream_read(void);				// read data registers
+static void stream_read_done(void);			// check and publish read data
+static void measure_sample_latency(uint8_t index, uint32_t now);	// read duration and interval of new sample
+
+
+void MEASURE_Conf(void)
+{
+	TIMER_Conf();
+}
+
+uint8_t MEASURE_Register(BME280 *bme)
+{
+	if (measure_count >= MEASURE_MAX_SENSORS) return 1;
+
+	measure_sensors[measure_count++] = bme;
+	return 0;
+}
+
+void MEASURE_Set_Callback(void (*callback)(BME280 *bme))
+{
+	measure_callback = callback;
+}
+
+/****************************************************************************/
+/*      trigger all sensors and arm timer for the longest conversion		*/
+/****************************************************************************/
+uint8_t MEASURE_Start(void)
+{
+	uint32_t time, longest = 0;
+
+	if (measure_busy) return 1;
+	measure_busy = 1;
+
+	for (uint8_t i = 0; i < measure_count; i++)
+	{
+		if (measure_sensors[i]->err_conf) continue;
+
+		time = BME280_Trigger(measure_sensors[i]);
+		if (time > longest) longest = time;
+	}
+
+	measure_index = 0;
+	measure_retries = 0;
+	measure_stats.cycles++;
+	measure_trigger_time = get_time_us();
+	TIMER_Start_Oneshot(longest, measure_read_next);
+	return 0;
+}
+
+uint8_t MEASURE_Busy(void)
+{
+	return measure_busy;
+}
+
+uint32_t MEASURE_Cycle_Time(void)
+{
+	uint32_t time, longest = 0;
+
+	for (uint8_t i = 0; i < measure_count; i++)
+	{
+		time = bme280_compute_measure_time_us(max_time, &measure_sensors[i]->conf);
+		if (time > longest) longest = time;
+	}
+	return longest;
+}
+
+uint8_t MEASURE_Sensors(void)
+{
+	return measure_count;
+}
+
+/****************************************************************************/
+/*      copy of latency histograms of sensor, with reset the next			*/
+/*      snapshot contains only samples collected after this one				*/
+/****************************************************************************/
+uint8_t MEASURE_Latency(uint8_t sensor, MEASURE_LATENCY *copy, uint8_t reset)
+{
+	if (sensor >= measure_count) return 1;
+
+	__disable_irq();
+	*copy = measure_latency[sensor];
+	if (reset)
+	{
+		histogram_reset(&measure_latency[sensor].trigger_to_data);
+		histogram_reset(&measure_latency[sensor].read);
+		histogram_reset(&measure_latency[sensor].interval);
+	}
+	__enable_irq();
+	return 0;
+}
+
+/****************************************************************************/
+/*      copy of counters, with reset the next copy contains only cycles		*/
+/*      started after this one												*/
+/****************************************************************************/
+void MEASURE_Stats(MEASURE_STATS *stats, uint8_t reset)
+{
+	__disable_irq();
+	*stats = measure_stats;
+	if (reset) memset(&measure_stats, 0, sizeof(measure_stats));
+	__enable_irq();
+}
+
+/****************************************************************************/
+/*      sensors are read one after another, each read is started from		*/
+/*      completion interrupt of previous one. Busy bus postpones read of	*/
+/*      the same sensor by MEASURE_RETRY_US (timer interrupt)				*/
+/****************************************************************************/
+static void measure_read_next(void)
+{
+	BME280 *bme;
+
+	while (measure_index < measure_count)
+	{
+		bme = measure_sensors[measure_index++];
+		if (bme->err_conf) continue;
+
+		measure_read_time = get_time_us();
+		PROFILE_RESTART(measure_read_ticks);
+		if (BME280_read_data_async(bme, 0xF7, BME280_DATA_SIZE, bme->raw, measure_read_done) == 0) return;
+
+		if (measure_retries < MEASURE_READ_RETRIES)
+		{
+			measure_retries++;
+			measure_stats.retries++;
+			measure_index--;
+			TIMER_Start_Oneshot(MEASURE_RETRY_US, measure_read_next);
+			return;
+		}
+
+		measure_stats.missed++;			// bus is still busy, next sensor is tried
+		measure_retries = 0;
+	}
+	measure_busy = 0;
+}
+
+static void measure_read_done(void)
+{
+	uint8_t index = measure_index - 1;
+	BME280 *bme = measure_sensors[index];
+	uint32_t now = get_time_us();
+
+	PROFILE_END(PROFILE_READ, measure_read_ticks);
+	measure_retries = 0;
+	measure_stats.reads++;
+	histogram_add(&measure_latency[index].trigger_to_data, now - measure_trigger_time);
+	measure_sample_latency(index, now);
+
+	bme->data_ready = 1;
+	if (measure_callback) measure_callback(bme);
+	measure_read_next();
+}
+
+/****************************************************************************/
+/*      start streaming of sensor working in normal mode					*/
+/****************************************************************************/
+uint8_t MEASURE_Stream_Start(BME280 *bme)
+{
+	if (bme->conf.mode != BME280_NORMALMODE || bme->err_conf) return 1;
+	if (measure_busy) return 1;
+	measure_busy = 1;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.bme = bme;
+	for (stream.index = 0; stream.index < measure_count; stream.index++)
+	{
+		if (measure_sensors[stream.index] == bme) break;
+	}
+	if (stream.index == measure_count) stream.index = MEASURE_MAX_SENSORS;
+	stream.stats.cycle_us = BME280_Cycle_Time_us(bme);
+	stream.read_offset = (stream.stats.cycle_us - bme280_compute_measure_time_us(typical_time, &bme->conf)) / 2;
+
+	stream_sync_start();
+	return 0;
+}
+
+void MEASURE_Stream_Stop(void)
+{
+	stream.state = stream_off;
+	TIMER_Stop();
+	measure_busy = 0;
+}
+
+void MEASURE_Stream_Stats(MEASURE_STREAM_STATS *stats)
+{
+	__disable_irq();
+	*stats = stream.stats;
+	__enable_irq();
+}
+
+uint32_t MEASURE_Stream_ODR(const MEASURE_STREAM_STATS *stats)
+{
+	uint32_t elapsed = stats->last_read - stats->first_read;
+
+	if (stats->samples < 2 || elapsed == 0) return 0;
+
+	return (uint32_t)((uint64_t)(stats->samples - 1) * 1000000000ULL / elapsed);
+}
+
+/****************************************************************************/
+/*      phase search: status register is polled up to falling edge of		*/
+/*      measuring bit, which is the end of conversion						*/
+/****************************************************************************/
+static void stream_sync_start(void)
+{
+	stream.state = stream_sync;
+	stream.measuring = 0;
+	stream.stats.resyncs++;
+
+	TIMER_Start_Oneshot(MEASURE_POLL_US, stream_poll);
+}
+
+static void stream_poll(void)
+{
+	if (stream.state != stream_sync) return;
+
+	if (BME280_read_data_async(stream.bme, 0xF3, 1, &stream.status, stream_poll_done))
+		TIMER_Start_Oneshot(MEASURE_POLL_US, stream_poll);		// bus is busy, try later
+}
+
+static void stream_poll_done(void)
+{
+	uint8_t measuring = (stream.status & BMP280_MEASURING_STATUS) ? 1 : 0;
+
+	if (stream.state != stream_sync) return;
+
+	if (stream.measuring && !measuring)
+	{
+		// conversion has just finished, its data are valid up to the end of next conversion
+		stream.state = stream_run;
+		stream.since_sync = 0;
+		stream.synced = 1;
+		TIMER_Start_Oneshot(stream.read_offset, stream_read);
+		return;
+	}
+
+	stream.measuring = measuring;
+	TIMER_Start_Oneshot(MEASURE_POLL_US, stream_poll);
+}
+
+/****************************************************************************/
+/*      data registers are read every cycle in the middle of standby		*/
+/*      time, as far as possible from both conversions						*/
+/****************************************************************************/
+static void stream_read(void)
+{
+	if (stream.state != stream_run) return;
+
+	TIMER_Start_Oneshot(stream.stats.cycle_us, stream_read);	// next read, period doesn't depend on bus latency
+
+	measure_read_time = get_time_us();
+	PROFILE_RESTART(measure_read_ticks);
+	if (BME280_read_data_async(stream.bme, STREAM_READ_REG, STREAM_READ_SIZE, stream.regs, stream_read_done))
+		stream.stats.skipped++;									// bus is busy, this conversion is lost
+}
+
+static void stream_read_done(void)
+{
+	MEASURE_STREAM_STATS *stats = &stream.stats;
+	uint32_t now = get_time_us();
+	uint32_t periods = 1;
+
+	if (stream.state != stream_run) return;
+	PROFILE_END(PROFILE_READ, measure_read_ticks);
+
+	if (stream.regs[0] & (BMP280_MEASURING_STATUS | BMP280_IM_UPDATE_STATUS))
+	{
+		// read has drifted from the middle of cycle to conversion: data registers hold
+		// the previous conversion, which can be the one already published -> not used
+		stats->drifts++;
+		stream_sync_start();
+		return;
+	}
+
+	if (stats->samples && !stream.synced)
+	{
+		// conversions which ended between reads, rounded to nearest number of cycles
+		periods = (now - stats->last_read + stats->cycle_us / 2) / stats->cycle_us;
+		if (periods == 0)
+		{
+			// read came in the same cycle as previous one -> data are not new
+			stats->duplicates++;
+			stream_sync_start();
+			return;
+		}
+	}
+
+	if (!stats->samples) stats->first_read = now;
+	else if (periods > 1) stats->skipped += periods - 1;
+	stream.synced = 0;
+
+	stats->last_read = now;
+	stats->samples++;
+
+	if (stream.index < MEASURE_MAX_SENSORS) measure_sample_latency(stream.index, now);
+
+	memcpy(stream.bme->raw, &stream.regs[STREAM_DATA], BME280_DATA_SIZE);
+	stream.bme->data_ready = 1;
+	if (measure_callback) measure_callback(stream.bme);
+
+	if (++stream.since_sync >= MEASURE_RESYNC_SAMPLES) stream_sync_start();
+}
+
+/****************************************************************************/
+/*      duration of read and time from previous sample of sensor,			*/
+/*      called from interrupt when data are read							*/
+/****************************************************************************/
+static void measure_sample_latency(uint8_t index, uint32_t now)
+{
+	MEASURE_LATENCY *latency = &measure_latency[index];
+
+	histogram_add(&latency->read, now - measure_read_time);
+
+	if (measure_has_data & (1 << index)) histogram_add(&latency->interval, now - measure_last_data[index]);
+	measure_last_data[index] = now;
+	measure_has_data |= 1 << index;
+}
@@ -0,0 +1,90 @@
+/*
+ * MEASURE.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef MEASURE_MEASURE_H_
+#define MEASURE_MEASURE_H_
+
+#include "stm32f10x.h"
+#include "../BME280/BME280.h"
+#include "../TIMER/TIMER.h"
+#include "../HISTOGRAM/HISTOGRAM.h"
+
+// --------------------------------------------------------- //
+// Forced-mode pipeline: all registered sensors are triggered at once,
+// TIM2 is armed for the longest conversion time computed from their
+// configuration and data registers are read from the timer interrupt.
+// When raw data of sensor are copied to bme->raw, bme->data_ready is set,
+// callback given by MEASURE_Set_Callback() is called (from interrupt)
+// and values can be calculated by BME280_Calculate() in main loop.
+#define MEASURE_MAX_SENSORS	4
+
+// When the bus is busy (transfer started by other code) read of sensor is
+// tried again after MEASURE_RETRY_US, up to MEASURE_READ_RETRIES times,
+// after that the sensor is counted as missed in this cycle.
+#define MEASURE_RETRY_US		100
+#define MEASURE_READ_RETRIES	20
+
+typedef struct {
+	uint32_t cycles;		// MEASURE_Start() calls which started a cycle
+	uint32_t reads;			// finished reads of data registers
+	uint32_t retries;		// reads postponed because bus was busy
+	uint32_t missed;		// sensors not read in their cycle (bus busy after all retries)
+} MEASURE_STATS;
+
+// --------------------------------------------------------- //
+// Streaming in normal mode: sensor converts by itself every cycle
+// (measurement time + standby time). End of conversion is found by polling
+// of measuring bit, after that data registers are read every cycle in the
+// middle of standby time, so each conversion is read once even if read is
+// a bit late.
+// New conversion is recognised by time from previous read (whole cycles,
+// rounded), not by values, so a constant signal is published every cycle.
+// Status register is read in the same burst as data: measuring or im_update
+// bit during the read means the phase has drifted to conversion -> data
+// aren't used (they can be the conversion already published) and phase is
+// searched again, as well as after a read in the same cycle as previous one.
+#define MEASURE_POLL_US			250		// polling period of status register while phase is searched
+#define MEASURE_RESYNC_SAMPLES	64		// phase is searched again after this number of samples
+
+typedef struct {
+	uint32_t samples;		// number of new conversions read
+	uint32_t duplicates;	// reads in the same conversion cycle as previous read
+	uint32_t skipped;		// conversions which weren't read
+	uint32_t resyncs;		// number of phase searches
+	uint32_t drifts;		// reads which found sensor converting (phase drifted), not used
+	uint32_t cycle_us;		// expected period of conversions [us]
+	uint32_t first_read;	// time of first sample [us]
+	uint32_t last_read;		// time of last sample [us]
+} MEASURE_STREAM_STATS;
+
+// --------------------------------------------------------- //
+// Latency of every registered sensor [us], updated from interrupts:
+// trigger-to-data is age of sample (MEASURE_Start() -> data in bme->raw,
+// forced mode only), read is duration of bus transfer of data registers,
+// interval is time between two samples of the sensor.
+typedef struct {
+	HISTOGRAM trigger_to_data;
+	HISTOGRAM read;
+	HISTOGRAM interval;
+} MEASURE_LATENCY;
+
+void MEASURE_Conf(void);
+uint8_t MEASURE_Register(BME280 *bmp);		// add sensor to pipeline, return 1 if there is no place
+void MEASURE_Set_Callback(void (*callback)(BME280 *bmp));	// called from interrupt when data of sensor are ready
+uint8_t MEASURE_Start(void);				// trigger conversion of all sensors, return 1 if previous cycle isn't finished
+uint8_t MEASURE_Busy(void);					// 1 from MEASURE_Start() up to reading of last sensor
+uint32_t MEASURE_Cycle_Time(void);			// maximum conversion time of registered sensors [us]
+uint8_t MEASURE_Sensors(void);				// number of registered sensors
+uint8_t MEASURE_Latency(uint8_t sensor, MEASURE_LATENCY *copy, uint8_t reset);	// snapshot (and reset) of histograms, return 1 if sensor isn't registered
+void MEASURE_Stats(MEASURE_STATS *stats, uint8_t reset);	// copy (and reset) of counters of forced-mode cycles
+
+uint8_t MEASURE_Stream_Start(BME280 *bmp);	// sensor has to be configured in normal mode, return 1 if it isn't or pipeline is busy
+void MEASURE_Stream_Stop(void);
+void MEASURE_Stream_Stats(MEASURE_STREAM_STATS *stats);	// copy of counters
+uint32_t MEASURE_Stream_ODR(const MEASURE_STREAM_STATS *stats);	// effective output data rate [mHz]
+
+#endif /* MEASURE_MEASURE_H_ */
@@ -0,0 +1,222 @@
+/*
+ * POWER.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "POWER.h"
+
+static POWER_STATS stats;
+static uint64_t last_wakeup;		// time of the last wake-up [us]
+
+#if POWER_USE_STOP
+static uint32_t rtc_remainder;		// part of ms which was lost in conversion of RTC ticks
+
+static uint8_t power_stop_allowed(uint32_t *ms);	// nothing is in progress and timer is far enough
+static void power_stop(uint32_t ms);				// sleep in STOP mode up to RTC alarm
+static void power_clock_restore(void);				// HSE + PLL as after RCC_Conf()
+#endif
+
+
+/****************************************************************************/
+/*      clock of PWR; RTC on LSE and its alarm on EXTI line 17 for STOP		*/
+/****************************************************************************/
+void POWER_Conf(void)
+{
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);
+
+#if POWER_USE_STOP
+	EXTI_InitTypeDef EXTI_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+
+	PWR_BackupAccessCmd(ENABLE);
+
+	RCC_LSEConfig(RCC_LSE_ON);
+	while(RCC_GetFlagStatus(RCC_FLAG_LSERDY) == RESET);
+
+	RCC_RTCCLKConfig(RCC_RTCCLKSource_LSE);
+	RCC_RTCCLKCmd(ENABLE);
+
+	RTC_WaitForSynchro();
+	RTC_WaitForLastTask();
+	RTC_SetPrescaler(POWER_RTC_PRESCALER - 1);
+	RTC_WaitForLastTask();
+	RTC_ITConfig(RTC_IT_ALR, ENABLE);
+	RTC_WaitForLastTask();
+
+	// RTC alarm is connected to EXTI line 17, only EXTI can wake up from STOP mode
+	EXTI_ClearITPendingBit(EXTI_Line17);
+	EXTI_InitStructure.EXTI_Line = EXTI_Line17;
+	EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+	EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
+	EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+	EXTI_Init(&EXTI_InitStructure);
+
+	NVIC_InitStructure.NVIC_IRQChannel = RTCAlarm_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+#endif
+
+	last_wakeup = CLOCK_Now_us();
+}
+
+/****************************************************************************/
+/*      nothing to do: sleep up to the next interrupt; interrupts are		*/
+/*      masked, so pending one wakes up CPU but is served after return		*/
+/****************************************************************************/
+void POWER_Idle(void)
+{
+	uint64_t sleep_start, now;
+#if POWER_USE_STOP
+	uint32_t ms;
+#endif
+#if CLOCK_TICKLESS
+	uint64_t clock_now;
+	uint32_t next;
+
+	// no tick wakes CPU up, so TIM3 compare is set to the nearest timer
+	clock_now = CLOCK_Now_us();
+	next = SCHEDULER_Next_Timeout();
+	if (next == 0) return;
+	if (next != 0xFFFFFFFF) CLOCK_Set_Wakeup(clock_now - (clock_now % 1000) + (uint64_t)next * 1000);
+#endif
+
+	sleep_start = CLOCK_Now_us();
+	stats.awake_us += sleep_start - last_wakeup;
+
+#if POWER_USE_STOP
+	if (power_stop_allowed(&ms))
+	{
+		power_stop(ms);
+		stats.stops++;
+	}
+	else
+#endif
+	{
+		__WFI();
+		stats.sleeps++;
+	}
+
+	__enable_irq();			// serve interrupt which woke up CPU (e.g. SysTick), so time is up to date
+	__disable_irq();
+
+	now = CLOCK_Now_us();
+	stats.sleep_us += now - sleep_start;
+	last_wakeup = now;
+}
+
+void POWER_Stats(POWER_STATS *copy)
+{
+	__disable_irq();
+	*copy = stats;
+	__enable_irq();
+}
+
+void POWER_Reset_Stats(void)
+{
+	__disable_irq();
+	memset(&stats, 0, sizeof(stats));
+	last_wakeup = CLOCK_Now_us();
+	__enable_irq();
+}
+
+/****************************************************************************/
+/*      awake time in 0,1 % (1000 - CPU never slept)						*/
+/****************************************************************************/
+uint16_t POWER_Duty_Cycle(const POWER_STATS *copy)
+{
+	uint64_t total = copy->awake_us + copy->sleep_us;
+
+	if (!total) return 0;
+	return (uint16_t)((copy->awake_us * 1000) / total);
+}
+
+#if POWER_USE_STOP
+/****************************************************************************/
+/*      STOP mode is allowed if no transfer or conversion is in progress	*/
+/*      and the next timer of scheduler is far enough						*/
+/****************************************************************************/
+static uint8_t power_stop_allowed(uint32_t *ms)
+{
+	if (MEASURE_Busy() || TIMER_Busy() || uart_tx_busy()) return 0;
+	if (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET) return 0;	// the last byte is still sent
+
+	*ms = SCHEDULER_Next_Timeout();
+	if (*ms < POWER_STOP_MIN_MS) return 0;
+
+	if (*ms > 60000) *ms = 60000;		// no timer runs - wake up at least once per minute
+	return 1;
+}
+
+/****************************************************************************/
+/*      sleep in STOP mode for ms: SysTick and TIM3 are stopped, RTC		*/
+/*      counts sleep time, after wake-up clock and timers are moved by it	*/
+/****************************************************************************/
+static void power_stop(uint32_t ms)
+{
+	uint32_t ticks, slept;
+
+	ticks = (ms * POWER_RTC_HZ) / 1000;
+
+#if !CLOCK_TICKLESS || BME280_I2C
+	SysTick->CTRL &= ~(SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk);
+#endif
+
+	RTC_WaitForLastTask();
+	RTC_SetCounter(0);
+	RTC_WaitForLastTask();
+	RTC_SetAlarm(ticks);
+	RTC_WaitForLastTask();
+	RTC_ClearFlag(RTC_FLAG_ALR);
+	EXTI_ClearITPendingBit(EXTI_Line17);
+
+	PWR_EnterSTOPMode(PWR_Regulator_LowPower, PWR_STOPEntry_WFI);
+
+	power_clock_restore();
+
+	// woken up by alarm or by other EXTI line, so time is read from RTC
+	RTC_WaitForSynchro();
+	slept = RTC_GetCounter() * 1000 + rtc_remainder;
+	rtc_remainder = slept % POWER_RTC_HZ;
+	slept /= POWER_RTC_HZ;
+
+	CLOCK_Advance((uint64_t)slept * 1000);
+#if !CLOCK_TICKLESS
+	SCHEDULER_Advance(slept);			// in tickless mode timers are counted from the clock
+#endif
+
+#if !CLOCK_TICKLESS || BME280_I2C
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk;
+#endif
+}
+
+/****************************************************************************/
+/*      after STOP mode HSI is the clock: HSE and PLL are started again,	*/
+/*      dividers and flash latency are kept from RCC_Conf()					*/
+/****************************************************************************/
+static void power_clock_restore(void)
+{
+	RCC_HSEConfig(RCC_HSE_ON);
+	if (RCC_WaitForHSEStartUp() != SUCCESS) return;
+
+	RCC_PLLCmd(ENABLE);
+	while(RCC_GetFlagStatus(RCC_FLAG_PLLRDY) == RESET);
+
+	RCC_SYSCLKConfig(RCC_SYSCLKSource_PLLCLK);
+	while(RCC_GetSYSCLKSource() != 0x08);
+}
+
+/****************************************************************************/
+/*      RTC alarm only wakes up from STOP mode								*/
+/****************************************************************************/
+__attribute__((interrupt)) void RTCAlarm_IRQHandler(void)
+{
+	EXTI_ClearITPendingBit(EXTI_Line17);
+	RTC_ClearITPendingBit(RTC_IT_ALR);
+	RTC_WaitForLastTask();
+}
+#endif
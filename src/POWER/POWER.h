@@ -0,0 +1,48 @@
+/*
+ * POWER.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef POWER_POWER_H_
+#define POWER_POWER_H_
+
+#include "stm32f10x.h"
+#include "../COMMON/common_var.h"
+#include "../CLOCK/CLOCK.h"
+#include "../SCHEDULER/SCHEDULER.h"
+#include "../MEASURE/MEASURE.h"
+#include "../UART/UART.h"
+
+// --------------------------------------------------------- //
+// Idle policy of scheduler: when no event is pending CPU sleeps by WFI
+// (clocks of peripherals and DMA are running, any interrupt wakes up).
+// With POWER_USE_STOP = 1 the whole MCU enters STOP mode if nothing is in
+// progress (measure, UART transmit, TIM2) and the next timer of scheduler is
+// at least POWER_STOP_MIN_MS away; it is woken up by RTC alarm (LSE 32768 Hz),
+// clock is restored to HSE + PLL and time and timers are moved by sleep time.
+// In STOP mode SysTick, TIM2, TIM3 and UART don't work - received data are lost.
+// With CLOCK_TICKLESS WFI is woken up by TIM3 compare at the nearest timer.
+// The sensor works in forced mode, so it also sleeps between measures.
+#ifndef POWER_USE_STOP
+#define POWER_USE_STOP		0		// 1 -> STOP mode when it is possible, 0 -> only WFI
+#endif
+#define POWER_STOP_MIN_MS	5		// the shortest sleep in STOP mode [ms]
+#define POWER_RTC_PRESCALER	32		// RTC tick = 32768 Hz / 32 = 1024 Hz
+#define POWER_RTC_HZ		(32768 / POWER_RTC_PRESCALER)
+
+typedef struct {
+	uint64_t awake_us;		// time when CPU was running (32 bits would overflow after 71 minutes)
+	uint64_t sleep_us;		// time in WFI or STOP mode
+	uint32_t sleeps;		// number of WFI
+	uint32_t stops;			// number of STOP mode entries
+} POWER_STATS;
+
+void POWER_Conf(void);								// has to be called after clock configuration
+void POWER_Idle(void);								// idle hook of scheduler, called with interrupts masked
+void POWER_Stats(POWER_STATS *stats);				// copy of counters
+void POWER_Reset_Stats(void);
+uint16_t POWER_Duty_Cycle(const POWER_STATS *stats);	// awake time in 0,1 % of whole time
+
+#endif /* POWER_POWER_H_ */
@@ -0,0 +1,136 @@
+/*
+ * PROFILE.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "PROFILE.h"
+
+#if PROFILE_ENABLE
+#include <string.h>
+#include "../FORMAT/FORMAT.h"
+
+static PROFILE_STAT stats[PROFILE_STAGES];
+static uint32_t overhead;		// time of empty probe pair, subtracted from every sample
+
+static const char * const stage_names[PROFILE_STAGES] = {
+	"read        ",
+	"boundaries  ",
+	"temperature ",
+	"pressure    ",
+	"humidity    ",
+	"average     ",
+	"sea level   ",
+	"altitude    ",
+	"string      ",
+	"calculate   ",
+};
+
+static void profile_print_value(void (*print)(const char *str), const char *label, uint32_t value);
+
+
+/****************************************************************************/
+/*      enable DWT cycle counter (also without debugger) and measure		*/
+/*      how long the probe itself takes										*/
+/****************************************************************************/
+void PROFILE_Conf(void)
+{
+	uint32_t start, min = 0xFFFFFFFF;
+
+#if defined(__arm__)
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT_CYCCNT = 0;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		start = PROFILE_Ticks();
+		start = PROFILE_Ticks() - start;
+		if (start < min) min = start;
+	}
+	overhead = min;
+
+	PROFILE_Reset();
+}
+
+/****************************************************************************/
+/*      add one execution time of stage, may be called from interrupt		*/
+/****************************************************************************/
+void PROFILE_Add(PROFILE_STAGE stage, uint32_t ticks)
+{
+	PROFILE_STAT *stat = &stats[stage];
+#if defined(__arm__)
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+#endif
+
+	ticks = (ticks > overhead) ? ticks - overhead : 0;
+
+	if (!stat->count || ticks < stat->min) stat->min = ticks;
+	if (ticks > stat->max) stat->max = ticks;
+	stat->sum += ticks;
+	stat->count++;
+
+#if defined(__arm__)
+	__set_PRIMASK(primask);
+#endif
+}
+
+void PROFILE_Get(PROFILE_STAGE stage, PROFILE_STAT *stat)
+{
+#if defined(__arm__)
+	__disable_irq();
+	*stat = stats[stage];
+	__enable_irq();
+#else
+	*stat = stats[stage];
+#endif
+}
+
+void PROFILE_Reset(void)
+{
+#if defined(__arm__)
+	__disable_irq();
+	memset(stats, 0, sizeof(stats));
+	__enable_irq();
+#else
+	memset(stats, 0, sizeof(stats));
+#endif
+}
+
+/****************************************************************************/
+/*      one line per executed stage: count, min, mean, max					*/
+/****************************************************************************/
+void PROFILE_Report(void (*print)(const char *str))
+{
+	PROFILE_STAT stat;
+
+	print("\n\rstage        count / min / mean / max [" PROFILE_UNIT "]\n\r");
+
+	for (uint8_t i = 0; i < PROFILE_STAGES; i++)
+	{
+		PROFILE_Get(i, &stat);
+		if (!stat.count) continue;
+
+		print(stage_names[i]);
+		profile_print_value(print, "", stat.count);
+		profile_print_value(print, " / ", stat.min);
+		profile_print_value(print, " / ", (uint32_t)(stat.sum / stat.count));
+		profile_print_value(print, " / ", stat.max);
+		print("\n\r");
+	}
+}
+
+static void profile_print_value(void (*print)(const char *str), const char *label, uint32_t value)
+{
+	char buf[FORMAT_UINT_MAX];
+
+	print(label);
+	FORMAT_Uint(buf, value);
+	print(buf);
+}
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * PROFILE.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef PROFILE_PROFILE_H_
+#define PROFILE_PROFILE_H_
+
+#include "stm32f10x.h"
+
+// --------------------------------------------------------- //
+// Execution time of driver stages. Every probe pair reads a free-running
+// counter and the difference is added to statistics of the stage
+// (count, min, max, sum for mean). On Cortex-M3 the counter is DWT CYCCNT
+// (CPU cycles), in a host build (not __arm__) it is CLOCK_MONOTONIC in ns,
+// so the same report can be printed off-target.
+// With PROFILE_ENABLE = 0 probes are empty macros - no code and no data.
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE	1		// 1 -> probes are compiled in, 0 -> no probes
+#endif
+
+// stages of BME280_ReadTPH() / BME280_Calculate()
+typedef enum {
+	PROFILE_READ,				// bus read of data registers by MEASURE: start of transfer -> completion interrupt
+	PROFILE_BOUNDARIES,			// check of raw values
+	PROFILE_TEMPERATURE,		// compensation of temperature
+	PROFILE_PRESSURE,			// compensation of pressure
+	PROFILE_HUMIDITY,			// compensation of humidity
+	PROFILE_AVERAGE,			// running average of one value (up to 3 per sample)
+	PROFILE_SEA_LEVEL,			// reduction of pressure to sea level
+	PROFILE_ALTITUDE,			// altitude from pressure
+	PROFILE_STRING,				// formatting of one string (up to 3 per sample)
+	PROFILE_CALCULATE,			// whole BME280_Calculate()
+	PROFILE_STAGES
+} PROFILE_STAGE;
+
+typedef struct {
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+} PROFILE_STAT;
+
+#if PROFILE_ENABLE
+
+#if defined(__arm__)
+#define PROFILE_UNIT	"cycles"
+#define DWT_CTRL		(*(volatile uint32_t *)0xE0001000)		// not defined in CMSIS of this device
+#define DWT_CYCCNT		(*(volatile uint32_t *)0xE0001004)
+#define DWT_CTRL_CYCCNTENA	0x00000001
+
+static inline uint32_t PROFILE_Ticks(void)
+{
+	return DWT_CYCCNT;
+}
+#else
+#include <time.h>
+#define PROFILE_UNIT	"ns"
+
+static inline uint32_t PROFILE_Ticks(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)ts.tv_sec * 1000000000u + (uint32_t)ts.tv_nsec;
+}
+#endif
+
+// start of stage: var is declared in current block (or reused by RESTART), end of stage: its time is added
+#define PROFILE_BEGIN(var)			uint32_t var = PROFILE_Ticks()
+#define PROFILE_RESTART(var)		var = PROFILE_Ticks()
+#define PROFILE_END(stage, var)		PROFILE_Add((stage), PROFILE_Ticks() - (var))
+
+void PROFILE_Conf(void);										// start counter and measure overhead of probe pair
+void PROFILE_Add(PROFILE_STAGE stage, uint32_t ticks);
+void PROFILE_Get(PROFILE_STAGE stage, PROFILE_STAT *stat);		// copy of statistics of one stage
+void PROFILE_Reset(void);
+void PROFILE_Report(void (*print)(const char *str));			// table of all stages which were executed
+
+#else
+
+#define PROFILE_BEGIN(var)
+#define PROFILE_RESTART(var)
+#define PROFILE_END(stage, var)
+
+#define PROFILE_Conf()
+#define PROFILE_Reset()
+
+#endif
+
+#endif /* PROFILE_PROFILE_H_ */
@@ -0,0 +1,260 @@
+/*
+ * SCHEDULER.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "SCHEDULER.h"
+
+typedef struct {
+	uint32_t period;		// 0 - timer is stopped
+	uint32_t remaining;		// ms up to next post
+	uint32_t events;
+	uint8_t priority;
+} SCHEDULER_TIMER;
+
+typedef struct {
+	SCHEDULER_WORK work;
+	void *arg;
+} SCHEDULER_ITEM;
+
+static SCHEDULER_TASK tasks[SCHEDULER_MAX_TASKS];
+static volatile uint32_t pending[SCHEDULER_MAX_TASKS];		// events of every task
+static volatile uint32_t ready;								// bit n - task of priority n has events
+
+static SCHEDULER_TIMER timers[SCHEDULER_MAX_TIMERS];
+
+static SCHEDULER_ITEM queue[SCHEDULER_QUEUE_SIZE];
+static volatile uint8_t queue_head;							// next free item
+static volatile uint8_t queue_tail;							// oldest item
+
+static void (*idle_hook)(void);
+static SCHEDULER_STATS stats;
+
+static uint32_t (*time_source)(void);						// ms clock in tickless mode, 0 -> SCHEDULER_Tick() is used
+static uint32_t time_last;									// time when timers were counted last
+
+static void scheduler_update_time(void);
+
+
+uint8_t SCHEDULER_Register(uint8_t priority, SCHEDULER_TASK task)
+{
+	if (priority >= SCHEDULER_MAX_TASKS || tasks[priority]) return 1;
+
+	tasks[priority] = task;
+	return 0;
+}
+
+/****************************************************************************/
+/*      set events of task, may be called from any interrupt				*/
+/****************************************************************************/
+void SCHEDULER_Post(uint8_t priority, uint32_t events)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	if (priority >= SCHEDULER_MAX_TASKS || !events) return;
+
+	__disable_irq();
+	pending[priority] |= events;
+	ready |= 1UL << priority;
+	__set_PRIMASK(primask);
+}
+
+/****************************************************************************/
+/*      queue function with argument to be called from main loop			*/
+/****************************************************************************/
+uint8_t SCHEDULER_Defer(SCHEDULER_WORK work, void *arg)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint8_t head;
+
+	__disable_irq();
+	head = (queue_head + 1) & (SCHEDULER_QUEUE_SIZE - 1);
+	if (head == queue_tail)
+	{
+		stats.work_dropped++;
+		__set_PRIMASK(primask);
+		return 1;
+	}
+
+	queue[queue_head].work	= work;
+	queue[queue_head].arg	= arg;
+	queue_head = head;
+	__set_PRIMASK(primask);
+	return 0;
+}
+
+uint8_t SCHEDULER_Timer_Start(uint8_t timer, uint8_t priority, uint32_t events, uint32_t period_ms)
+{
+	if (timer >= SCHEDULER_MAX_TIMERS) return 1;
+
+	scheduler_update_time();		// period is counted from now, not from the last update
+
+	__disable_irq();
+	timers[timer].priority	= priority;
+	timers[timer].events	= events;
+	timers[timer].remaining	= period_ms;
+	timers[timer].period	= period_ms;
+	__enable_irq();
+	return 0;
+}
+
+void SCHEDULER_Timer_Stop(uint8_t timer)
+{
+	if (timer < SCHEDULER_MAX_TIMERS) timers[timer].period = 0;
+}
+
+/****************************************************************************/
+/*      count software timers, called from SysTick interrupt every 1 ms	*/
+/****************************************************************************/
+void SCHEDULER_Tick(void)
+{
+	for (uint8_t i = 0; i < SCHEDULER_MAX_TIMERS; i++)
+	{
+		if (!timers[i].period) continue;
+
+		if (--timers[i].remaining == 0)
+		{
+			timers[i].remaining = timers[i].period;
+			SCHEDULER_Post(timers[i].priority, timers[i].events);
+		}
+	}
+}
+
+/****************************************************************************/
+/*      time up to the nearest timer post, used by low-power idle			*/
+/****************************************************************************/
+uint32_t SCHEDULER_Next_Timeout(void)
+{
+	uint32_t nearest = 0xFFFFFFFF;
+
+	scheduler_update_time();
+	if (ready) return 0;			// timer has just expired
+
+	for (uint8_t i = 0; i < SCHEDULER_MAX_TIMERS; i++)
+	{
+		if (timers[i].period && timers[i].remaining < nearest) nearest = timers[i].remaining;
+	}
+	return nearest;
+}
+
+/****************************************************************************/
+/*      count timers by ms which passed while SysTick was stopped,			*/
+/*      every expired timer posts its events once							*/
+/****************************************************************************/
+void SCHEDULER_Advance(uint32_t ms)
+{
+	uint32_t passed;
+
+	for (uint8_t i = 0; i < SCHEDULER_MAX_TIMERS; i++)
+	{
+		if (!timers[i].period || !ms) continue;
+
+		if (ms < timers[i].remaining)
+		{
+			timers[i].remaining -= ms;
+			continue;
+		}
+
+		passed = (ms - timers[i].remaining) % timers[i].period;		// time from the last missed expiry
+		timers[i].remaining = timers[i].period - passed;
+		SCHEDULER_Post(timers[i].priority, timers[i].events);
+	}
+}
+
+/****************************************************************************/
+/*      run one deferred work item or the ready task with the highest		*/
+/*      priority, return 0 if nothing was ready								*/
+/****************************************************************************/
+uint8_t SCHEDULER_Dispatch(void)
+{
+	SCHEDULER_ITEM item;
+	uint32_t events;
+	uint8_t priority;
+
+	scheduler_update_time();
+
+	if (queue_tail != queue_head)
+	{
+		item = queue[queue_tail];
+		queue_tail = (queue_tail + 1) & (SCHEDULER_QUEUE_SIZE - 1);
+
+		item.work(item.arg);
+		stats.work_done++;
+		return 1;
+	}
+
+	if (!ready) return 0;
+
+	priority = __builtin_ctz(ready);		// the lowest set bit is the highest priority
+
+	__disable_irq();
+	events = pending[priority];
+	pending[priority] = 0;
+	ready &= ~(1UL << priority);
+	__enable_irq();
+
+	if (tasks[priority]) tasks[priority](events);
+	stats.dispatched++;
+	return 1;
+}
+
+void SCHEDULER_Set_Idle(void (*idle)(void))
+{
+	idle_hook = idle;
+}
+
+/****************************************************************************/
+/*      tickless mode: timers are counted from ms clock by main loop		*/
+/*      instead of SCHEDULER_Tick() in SysTick interrupt					*/
+/****************************************************************************/
+void SCHEDULER_Set_Time_Source(uint32_t (*now_ms)(void))
+{
+	time_source = now_ms;
+	if (time_source) time_last = time_source();
+}
+
+/****************************************************************************/
+/*      count timers by ms which passed from the last call					*/
+/****************************************************************************/
+static void scheduler_update_time(void)
+{
+	uint32_t now;
+
+	if (!time_source) return;
+
+	now = time_source();
+	if (now == time_last) return;
+
+	SCHEDULER_Advance(now - time_last);
+	time_last = now;
+}
+
+/****************************************************************************/
+/*      dispatch forever; idle hook is called with interrupts masked,		*/
+/*      so event posted just before it can't be missed (WFI wakes up		*/
+/*      also on masked interrupt)											*/
+/****************************************************************************/
+void SCHEDULER_Run(void)
+{
+	while (1)
+	{
+		if (SCHEDULER_Dispatch()) continue;
+
+		__disable_irq();
+		if (!ready && queue_tail == queue_head)
+		{
+			stats.idle_loops++;
+			if (idle_hook) idle_hook();
+		}
+		__enable_irq();
+	}
+}
+
+void SCHEDULER_Stats(SCHEDULER_STATS *copy)
+{
+	__disable_irq();
+	*copy = stats;
+	__enable_irq();
+}
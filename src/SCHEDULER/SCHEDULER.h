@@ -0,0 +1,52 @@
+/*
+ * SCHEDULER.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef SCHEDULER_SCHEDULER_H_
+#define SCHEDULER_SCHEDULER_H_
+
+#include "stm32f10x.h"
+
+// --------------------------------------------------------- //
+// Run-to-completion event scheduler. Every task has its own priority
+// (0 - the highest) and a mask of pending events. Interrupts only post
+// events (or deferred work) and the main loop dispatches them: the ready
+// task with the highest priority is called with all its pending events,
+// runs to the end and is never preempted by another task.
+// Deferred work (function + argument queued from interrupt) is executed
+// before any task.
+// Software timers are counted by SCHEDULER_Tick() called every 1 ms or,
+// in tickless mode, from ms clock given by SCHEDULER_Set_Time_Source()
+// every time the main loop dispatches or goes to idle.
+#define SCHEDULER_MAX_TASKS		8		// number of priorities, one task per priority
+#define SCHEDULER_MAX_TIMERS	4
+#define SCHEDULER_QUEUE_SIZE	16		// deferred work items, power of 2
+
+typedef void (*SCHEDULER_TASK)(uint32_t events);		// called with pending events, they are cleared before call
+typedef void (*SCHEDULER_WORK)(void *arg);
+
+typedef struct {
+	uint32_t dispatched;	// number of task calls
+	uint32_t work_done;		// number of executed deferred work items
+	uint32_t work_dropped;	// deferred work items lost because queue was full
+	uint32_t idle_loops;	// number of calls of idle hook
+} SCHEDULER_STATS;
+
+uint8_t SCHEDULER_Register(uint8_t priority, SCHEDULER_TASK task);				// return 1 if priority is used or out of range
+void SCHEDULER_Post(uint8_t priority, uint32_t events);							// set events of task, allowed in interrupts
+uint8_t SCHEDULER_Defer(SCHEDULER_WORK work, void *arg);							// queue work for main loop, return 1 if queue is full
+uint8_t SCHEDULER_Timer_Start(uint8_t timer, uint8_t priority, uint32_t events, uint32_t period_ms);	// post events every period, return 1 if timer is out of range
+void SCHEDULER_Timer_Stop(uint8_t timer);
+void SCHEDULER_Tick(void);														// count timers, called from SysTick every 1 ms
+uint32_t SCHEDULER_Next_Timeout(void);											// ms up to the nearest timer post, 0 if event is ready, 0xFFFFFFFF if no timer runs
+void SCHEDULER_Advance(uint32_t ms);											// count timers by ms at once (after SysTick was stopped)
+uint8_t SCHEDULER_Dispatch(void);												// run one work item or task, return 0 if nothing was ready
+void SCHEDULER_Set_Idle(void (*idle)(void));									// called with interrupts masked when nothing is ready
+void SCHEDULER_Set_Time_Source(uint32_t (*now_ms)(void));						// tickless mode: timers are counted from this clock, 0 -> SCHEDULER_Tick()
+void SCHEDULER_Run(void);														// dispatch forever
+void SCHEDULER_Stats(SCHEDULER_STATS *stats);									// copy of counters
+
+#endif /* SCHEDULER_SCHEDULER_H_ */
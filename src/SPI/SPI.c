@@ -60,6 +60,10 @@
 
 		SELECT();
 		DESELECT();
+
+	#if BME280_SPI_DMA
+		SPI_DMA_Conf();
+	#endif
 	}
 #endif
 
@@ -83,6 +87,47 @@
 	}
 #endif
 
+	/****************************************************************************/
+	/*      Configure pin as chip select of additional slave					*/
+	/****************************************************************************/
+#if BME280_SPI
+	void SPI_CS_Conf (GPIO_TypeDef *port, uint16_t pin)
+	{
+		GPIO_InitTypeDef GPIO_InitStructure;
+
+		if 		(port == GPIOA) RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+		else if (port == GPIOB) RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+		else if (port == GPIOC) RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC, ENABLE);
+
+		GPIO_SetBits(port, pin);	// slave is not selected after configuration
+
+		GPIO_InitStructure.GPIO_Pin = pin;
+		GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+		GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+		GPIO_Init(port, &GPIO_InitStructure);
+	}
+#endif
+
+	/****************************************************************************/
+	/*      Select slave connected to given pin									*/
+	/****************************************************************************/
+#if BME280_SPI
+	void SPI_Select (GPIO_TypeDef *port, uint16_t pin)
+	{
+		GPIO_ResetBits(port, pin);
+	}
+#endif
+
+	/****************************************************************************/
+	/*      Deselect slave connected to given pin								*/
+	/****************************************************************************/
+#if BME280_SPI
+	void SPI_Deselect (GPIO_TypeDef *port, uint16_t pin)
+	{
+		GPIO_SetBits(port, pin);
+	}
+#endif
+
 	/****************************************************************************/
 	/*      Send a few data by SPI        										*/
 	/****************************************************************************/
@@ -136,3 +181,144 @@
 	}
 
 #endif
+
+#if BME280_SPI_DMA
+
+	static uint8_t spi_dma_tx_buf[SPI_DMA_BUF_SIZE];	// bytes clocked out to the slave
+	static uint8_t spi_dma_rx_buf[SPI_DMA_BUF_SIZE];	// bytes clocked in from the slave
+	static volatile uint8_t spi_dma_busy;				// set "1" while transfer is in progress
+	static uint8_t *spi_dma_rx_dest;					// destination of received data (can be 0)
+	static uint8_t spi_dma_rx_offset;					// index of the first received byte copied to destination
+	static uint8_t spi_dma_rx_size;						// number of received bytes copied to destination
+	static void (*spi_dma_callback)(void);				// called from interrupt when transfer is finished
+	static GPIO_TypeDef *spi_dma_cs_port;				// chip select of slave taking part in transfer
+	static uint16_t spi_dma_cs_pin;
+
+	/****************************************************************************/
+	/*      Configuration of DMA1 channel 2 (SPI1_RX) and channel 3 (SPI1_TX)	*/
+	/****************************************************************************/
+	void SPI_DMA_Conf(void)
+	{
+		DMA_InitTypeDef  DMA_InitStructure;
+		NVIC_InitTypeDef NVIC_InitStructure;
+
+		RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+		// Channel 2: SPI1->DR -> spi_dma_rx_buf
+		DMA_DeInit(DMA1_Channel2);
+		DMA_StructInit(&DMA_InitStructure);
+		DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&SPI1->DR;
+		DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)spi_dma_rx_buf;
+		DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+		DMA_InitStructure.DMA_BufferSize = 1;
+		DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+		DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+		DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+		DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+		DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+		DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;		// Rx must be served before Tx to avoid overrun
+		DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+		DMA_Init(DMA1_Channel2, &DMA_InitStructure);
+
+		// Channel 3: spi_dma_tx_buf -> SPI1->DR
+		DMA_DeInit(DMA1_Channel3);
+		DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)spi_dma_tx_buf;
+		DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+		DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+		DMA_Init(DMA1_Channel3, &DMA_InitStructure);
+
+		// The last received byte finishes the transfer, so only Rx channel generates interrupt
+		DMA_ITConfig(DMA1_Channel2, DMA_IT_TC, ENABLE);
+
+		NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel2_IRQn;
+		NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+		NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+		NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+		NVIC_Init(&NVIC_InitStructure);
+
+		spi_dma_busy = 0;
+	}
+
+	/****************************************************************************/
+	/*      Start full-duplex transfer in one chip-select window:				*/
+	/*      tx_size bytes are sent and next rx_size bytes are received			*/
+	/****************************************************************************/
+	uint8_t SPI_DMA_Transfer(GPIO_TypeDef *cs_port, uint16_t cs_pin, const uint8_t *tx, uint8_t tx_size,
+							 uint8_t *rx, uint8_t rx_size, void (*callback)(void))
+	{
+		uint8_t size = tx_size + rx_size;
+		uint32_t primask;
+
+		if((size == 0) || (size > SPI_DMA_BUF_SIZE)) return 2;
+
+		// main loop and interrupts start transfers, so busy is tested and set in one critical section
+		primask = __get_PRIMASK();
+		__disable_irq();
+		if(spi_dma_busy)
+		{
+			__set_PRIMASK(primask);
+			return 1;
+		}
+		spi_dma_busy = 1;
+		__set_PRIMASK(primask);
+
+		memcpy(spi_dma_tx_buf, tx, tx_size);
+		memset(&spi_dma_tx_buf[tx_size], 0, rx_size);	// dummy bytes for clocking data from slave
+
+		spi_dma_rx_dest   = rx;
+		spi_dma_rx_offset = tx_size;
+		spi_dma_rx_size   = rx_size;
+		spi_dma_callback  = callback;
+		spi_dma_cs_port   = cs_port;
+		spi_dma_cs_pin    = cs_pin;
+
+		DMA_Cmd(DMA1_Channel2, DISABLE);
+		DMA_Cmd(DMA1_Channel3, DISABLE);
+		DMA_SetCurrDataCounter(DMA1_Channel2, size);
+		DMA_SetCurrDataCounter(DMA1_Channel3, size);
+		DMA_ClearFlag(DMA1_FLAG_GL2 | DMA1_FLAG_GL3);
+
+		SPI_I2S_ReceiveData(SPI1);						// drop stale byte, if any
+
+		SPI_Select(cs_port, cs_pin);
+
+		DMA_Cmd(DMA1_Channel2, ENABLE);
+		DMA_Cmd(DMA1_Channel3, ENABLE);
+		SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+
+		return 0;
+	}
+
+	/****************************************************************************/
+	/*      Return 1 if transfer is in progress									*/
+	/****************************************************************************/
+	uint8_t SPI_DMA_Busy(void)
+	{
+		return spi_dma_busy;
+	}
+
+	/****************************************************************************/
+	/*      End of transfer -> all bytes were received							*/
+	/****************************************************************************/
+	__attribute__((interrupt)) void DMA1_Channel2_IRQHandler(void)
+	{
+		if(DMA_GetITStatus(DMA1_IT_TC2) != RESET)
+		{
+			DMA_ClearITPendingBit(DMA1_IT_GL2);
+			DMA_ClearFlag(DMA1_FLAG_GL3);
+
+			SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+			DMA_Cmd(DMA1_Channel2, DISABLE);
+			DMA_Cmd(DMA1_Channel3, DISABLE);
+
+			SPI_Deselect(spi_dma_cs_port, spi_dma_cs_pin);
+
+			if(spi_dma_rx_dest) memcpy(spi_dma_rx_dest, &spi_dma_rx_buf[spi_dma_rx_offset], spi_dma_rx_size);
+
+			spi_dma_busy = 0;
+
+			if(spi_dma_callback) spi_dma_callback();
+		}
+	}
+
+#endif
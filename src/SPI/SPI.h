@@ -15,9 +15,21 @@
 	void SPI_Conf(void);
 	void SELECT (void);
 	void DESELECT (void);
+	void SPI_CS_Conf (GPIO_TypeDef *port, uint16_t pin);	// configure pin as chip select of additional slave
+	void SPI_Select (GPIO_TypeDef *port, uint16_t pin);		// CS in low state
+	void SPI_Deselect (GPIO_TypeDef *port, uint16_t pin);	// CS in high state
 
 	void SPI_SendData (uint8_t address, uint8_t *Data, uint8_t size);  		// sending a few data
 	void SPI_ReceiveData (uint8_t address, uint8_t *Data, uint8_t size);	//Receiving a few data from external device
 #endif
 
+#if BME280_SPI_DMA
+	#define SPI_DMA_BUF_SIZE 40		// maximum number of bytes clocked in one chip-select window
+
+	void SPI_DMA_Conf(void);
+	uint8_t SPI_DMA_Transfer(GPIO_TypeDef *cs_port, uint16_t cs_pin, const uint8_t *tx, uint8_t tx_size,
+							 uint8_t *rx, uint8_t rx_size, void (*callback)(void));							// start transfer, return 1 if DMA is busy
+	uint8_t SPI_DMA_Busy(void);																						// return 1 if transfer is in progress
+#endif
+
 #endif /* SPI_H_ */
@@ -0,0 +1,108 @@
+/*
+ * TIMER.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "TIMER.h"
+
+static void (*volatile timer_callback)(void);
+static volatile uint32_t timer_remaining;		// ticks left after current period, for delays longer than one period
+
+static void timer_arm(void);
+
+
+void TIMER_Conf(void)
+{
+	TIM_TimeBaseInitTypeDef TIM_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+
+	TIM_TimeBaseStructInit(&TIM_InitStructure);
+	TIM_InitStructure.TIM_Prescaler = (TIMER_CLOCK / 1000000) * TIMER_TICK_US - 1;
+	TIM_InitStructure.TIM_Period = 0xFFFF;
+	TIM_InitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+	TIM_TimeBaseInit(TIM2, &TIM_InitStructure);
+
+	// counter stops itself at update event
+	TIM_SelectOnePulseMode(TIM2, TIM_OPMode_Single);
+
+	// TIM_TimeBaseInit generates update event to load prescaler, so flag have to be cleared
+	TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+	TIM_ITConfig(TIM2, TIM_IT_Update, ENABLE);
+
+	NVIC_InitStructure.NVIC_IRQChannel = TIM2_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = TIMER_IRQ_PRIORITY;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+}
+
+/****************************************************************************/
+/*      arm timer, time is rounded up to TIMER_TICK_US						*/
+/****************************************************************************/
+void TIMER_Start_Oneshot(uint32_t time_us, void (*callback)(void))
+{
+	uint32_t ticks = (time_us + TIMER_TICK_US - 1) / TIMER_TICK_US;
+
+	if (ticks < 2) ticks = 2;								// counter is blocked when auto-reload is 0
+
+	TIM_Cmd(TIM2, DISABLE);
+	timer_callback = callback;
+	timer_remaining = ticks;
+
+	timer_arm();
+}
+
+/****************************************************************************/
+/*      start next period, at most 0x10000 ticks							*/
+/****************************************************************************/
+static void timer_arm(void)
+{
+	uint32_t ticks = timer_remaining;
+
+	if (ticks > 0x10000) ticks = 0x10000;
+	if ((timer_remaining - ticks) == 1) ticks--;			// don't leave single tick for the last period
+	timer_remaining -= ticks;
+
+	TIM_SetCounter(TIM2, 0);
+	TIM_SetAutoreload(TIM2, (uint16_t)(ticks - 1));
+	TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+
+	TIM_Cmd(TIM2, ENABLE);
+}
+
+void TIMER_Stop(void)
+{
+	TIM_Cmd(TIM2, DISABLE);
+	TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+	timer_callback = 0;
+	timer_remaining = 0;
+}
+
+uint8_t TIMER_Busy(void)
+{
+	return ((TIM2->CR1 & TIM_CR1_CEN) || timer_remaining) ? 1 : 0;
+}
+
+__attribute__((interrupt)) void TIM2_IRQHandler(void)
+{
+	void (*callback)(void);
+
+	if (TIM_GetITStatus(TIM2, TIM_IT_Update) != RESET)
+	{
+		TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+
+		if (timer_remaining)
+		{
+			timer_arm();									// long delay isn't finished yet
+			return;
+		}
+
+		callback = timer_callback;
+		timer_callback = 0;
+		if (callback) callback();
+	}
+}
@@ -0,0 +1,27 @@
+/*
+ * TIMER.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef TIMER_TIMER_H_
+#define TIMER_TIMER_H_
+
+#include "stm32f10x.h"
+
+// --------------------------------------------------------- //
+// TIM2 works as one-shot timer: after given time the callback
+// is called from TIM2 interrupt and the timer stops.
+// Delays longer than one counter period are counted in several periods.
+#define TIMER_CLOCK			72000000	// TIM2 clock (PCLK1 = 36 MHz, timer clock is doubled)
+#define TIMER_TICK_US		10			// resolution of one-shot timer [us]
+#define TIMER_PERIOD_US		((uint32_t)0x10000 * TIMER_TICK_US)	// longest period of counter -> 655 ms, longer delays are split
+#define TIMER_IRQ_PRIORITY	2			// below bus interrupts (I2C -> 0, SPI DMA -> 1)
+
+void TIMER_Conf(void);
+void TIMER_Start_Oneshot(uint32_t time_us, void (*callback)(void));	// call callback after time_us, previous request is cancelled
+void TIMER_Stop(void);													// cancel pending request
+uint8_t TIMER_Busy(void);												// 1 if request is pending
+
+#endif /* TIMER_TIMER_H_ */
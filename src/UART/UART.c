@@ -13,19 +13,26 @@
 volatile uint8_t ascii_line;
 
 
-// Definition of UART_RxBuf receiving buffer
+// Definition of UART_RxBuf receiving buffer, filled by DMA1 channel 5 in circular mode
 volatile char UART_RxBuf[UART_RX_BUF_SIZE];
 // Index definition which determine the amount of data in buffer
-volatile uint8_t UART_RxHead; // Index which determine the "head of snake"
-volatile uint8_t UART_RxTail; // Index which determine the "tail of snake"
+volatile uint16_t UART_RxHead; // Index of the next byte written by DMA, taken over in interrupt ("head of snake")
+volatile uint16_t UART_RxTail; // Index of the next byte to read ("tail of snake")
+volatile uint32_t UART_RxOverruns; // Number of times buffer was flushed because reading was too slow
 
+static void uart_rx_dma_update(void);	// take over data written by DMA since last call
 
 
-// Definition of UART_TxBuf transmit buffer
+
+// Definition of UART_TxBuf transmit buffer, data between tail and head are sent by DMA1 channel 4
 volatile char UART_TxBuf[UART_TX_BUF_SIZE];
 // Index definition which determine the amount of data in buffer
-volatile uint8_t UART_TxHead; // Index which determine the "head of snake"
-volatile uint8_t UART_TxTail; // Index which determine the "tail of snake"
+volatile uint16_t UART_TxHead; // Index of the next free byte ("head of snake")
+volatile uint16_t UART_TxTail; // Index of the oldest byte which isn't sent yet ("tail of snake")
+volatile uint16_t UART_TxDmaLen; // Number of bytes of the current DMA transfer (0 - DMA is idle)
+volatile uint32_t UART_TxDropped; // Number of bytes dropped because buffer was full
+
+static void uart_tx_dma_start(void);	// send next contiguous span of buffer, called with interrupts masked
 
 
 // a pointer to a callback for the event UART_RX_STR_EVENT()
@@ -38,6 +45,14 @@ void register_uart_str_rx_event_callback(void (*callback)(char * pBuf)) {
 }
 
 
+// a pointer to a callback called from interrupt when line is received (e.g. to post event of main loop)
+static void (*uart_rx_line_callback)(void);
+
+void register_uart_rx_line_callback(void (*callback)(void)) {
+	uart_rx_line_callback = callback;
+}
+
+
 void UART_Conf(uint32_t BaudRate)
 {
 
@@ -76,7 +91,46 @@ void UART_Conf(uint32_t BaudRate)
 	USARTInit.USART_WordLength = USART_WordLength_8b;
 
 	USART_Init(USART1, &USARTInit);
-	USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);
+	USART_ITConfig(USART1, USART_IT_IDLE, ENABLE);
+	USART_DMACmd(USART1, USART_DMAReq_Rx | USART_DMAReq_Tx, ENABLE);
+
+
+	//*******************************************************************
+	// DMA1 channel 4 (USART1_TX): memory -> USART1->DR, length and address set per transfer
+	//*******************************************************************
+	DMA_InitTypeDef DMA_InitStructure;
+
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+	DMA_DeInit(DMA1_Channel4);
+	DMA_StructInit(&DMA_InitStructure);
+	DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&USART1->DR;
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)UART_TxBuf;
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+	DMA_InitStructure.DMA_BufferSize = 1;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_Low;		// SPI transfers of sensor have precedence
+	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+	DMA_Init(DMA1_Channel4, &DMA_InitStructure);
+	DMA_ITConfig(DMA1_Channel4, DMA_IT_TC, ENABLE);
+
+	//*******************************************************************
+	// DMA1 channel 5 (USART1_RX): USART1->DR -> circular receive buffer, runs all the time
+	//*******************************************************************
+	DMA_DeInit(DMA1_Channel5);
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)UART_RxBuf;
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+	DMA_InitStructure.DMA_BufferSize = UART_RX_BUF_SIZE;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;	// received byte has to be taken before the next one
+	DMA_Init(DMA1_Channel5, &DMA_InitStructure);
+	DMA_ITConfig(DMA1_Channel5, DMA_IT_HT | DMA_IT_TC, ENABLE);
+	DMA_Cmd(DMA1_Channel5, ENABLE);
+
 	USART_Cmd(USART1, ENABLE);
 
 
@@ -95,72 +149,126 @@ void UART_Conf(uint32_t BaudRate)
   	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
   	NVIC_Init(&NVIC_InitStructure);
 
+  	// Enabling interrupt from half and end of receive buffer, the same priority as USART1, so they don't preempt each other
+  	NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel5_IRQn;
+  	NVIC_Init(&NVIC_InitStructure);
+
+  	// Enabling interrupt from end of DMA transfer
+  	NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel4_IRQn;
+  	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = UART_TX_IRQ_PRIORITY;
+  	NVIC_Init(&NVIC_InitStructure);
+
 }
 
 //***********************************************************************************************
   __attribute__((interrupt)) void USART1_IRQHandler (void)
 {
 
-	  if(USART_GetFlagStatus(USART1, USART_IT_RXNE) != RESET)
+	  // line is idle after frame: take over received data without waiting for half of buffer
+	  if(USART_GetITStatus(USART1, USART_IT_IDLE) != RESET)
 	  {
-		  register uint8_t tmp_head;
-		  register char data;
-
-		  data = (char)USART_ReceiveData(USART1);
-
-		  // calculation a new indeks of "head snake"
-		  tmp_head = ( UART_RxHead + 1) & UART_RX_BUF_MASK;
-
-		  // check that the snake will not start to eat its own tail
-		  if ( tmp_head == UART_RxTail )
-		  {
-			  // here we can handle the error caused in some way convenient for us
-			  // trying to overwrite data in the buffer, it could get to a situation where
-			  // our snake would start to eat its own tail
-			  // one of the most obvious solutions is e.g. immediate
-			  // reset the ascii_line variable or control the hardware line
-			  // buffer busy
-			  UART_RxHead = UART_RxTail;
-		  } else
-		  {
-			  switch( data )
-			  {
-				  case 0:					// ignore byte = 0
-				  case 10: break;			// ignore byte LF
-				  case 13: ascii_line++;	// signal the presence of the next line in the buffer
-				  default : UART_RxHead = tmp_head; UART_RxBuf[tmp_head] = data;
-
-				  uart_putc(UART_RxBuf[tmp_head]);
-			  }
-		  }
-
-		  USART_ClearFlag(USART1, USART_IT_RXNE);
+		  USART_ReceiveData(USART1);		// IDLE flag is cleared by reading SR and then DR
+		  uart_rx_dma_update();
 	  }
 
-	  if(USART_GetFlagStatus(USART1, USART_SR_TXE) != RESET)
+}
+//***********************************************************************************************
+  // half or end of receive buffer: take over data of long frames before DMA wraps over them
+  __attribute__((interrupt)) void DMA1_Channel5_IRQHandler(void)
+  {
+	  if(DMA_GetITStatus(DMA1_IT_HT5 | DMA1_IT_TC5) != RESET)
 	  {
-		  // we check if the indexes are different
-		  if ( UART_TxHead != UART_TxTail )
-		  {
-			  // we calculate and remember the new index of the snake's tail (it can align with the head)
-			  UART_TxTail = (UART_TxTail + 1) & UART_TX_BUF_MASK;
-			  // we return the byte downloaded from the buffer as the result of the function
-			  #ifdef UART_DE_PORT
-			  UART_DE_NADAWANIE;
-			  #endif
-
-			  USART_SendData(USART1, UART_TxBuf[UART_TxTail]);
-			  while(USART_GetFlagStatus(USART1, USART_SR_TC) == RESET);
-			  USART_ClearFlag(USART1, USART_SR_TC);
-		  }
-		  else
-		  {
-			// reset the interrupt flag that occurs when the buffer is empty
-			  USART_ITConfig(USART1, USART_IT_TXE, DISABLE);
-		  }
+		  DMA_ClearITPendingBit(DMA1_IT_GL5);
+		  uart_rx_dma_update();
 	  }
+  }
 
-}
+  //***********************************************************************************************
+  // position of DMA gives the new head, lines are counted by CR
+  static void uart_rx_dma_update(void)
+  {
+	  uint16_t head, pos, received, unread;
+	  uint8_t lines = 0;
+
+	  head = UART_RxHead;
+	  pos = (UART_RX_BUF_SIZE - DMA_GetCurrDataCounter(DMA1_Channel5)) & UART_RX_BUF_MASK;
+	  received = (pos - head) & UART_RX_BUF_MASK;
+	  unread = (head - UART_RxTail) & UART_RX_BUF_MASK;
+
+	  if( !received ) return;
+
+	  // check that the snake will not start to eat its own tail: DMA overwrote data which weren't read,
+	  // the whole buffer is dropped
+	  if( unread + received >= UART_RX_BUF_SIZE )
+	  {
+		  UART_RxOverruns++;
+		  ascii_line = 0;
+		  UART_RxTail = pos;
+		  UART_RxHead = pos;
+		  return;
+	  }
+
+	  #if UART_RX_ECHO
+	  if( pos > head ) uart_write((const char *)&UART_RxBuf[head], received);
+	  else
+	  {
+		  uart_write((const char *)&UART_RxBuf[head], UART_RX_BUF_SIZE - head);
+		  uart_write((const char *)UART_RxBuf, pos);
+	  }
+	  #endif
+
+	  while( head != pos )
+	  {
+		  if( UART_RxBuf[head] == 13 ) lines++;
+		  head = (head + 1) & UART_RX_BUF_MASK;
+	  }
+
+	  UART_RxHead = head;
+
+	  if( lines )
+	  {
+		  ascii_line += lines;		// signal the presence of the next line in the buffer
+		  if( uart_rx_line_callback ) uart_rx_line_callback();
+	  }
+  }
+//***********************************************************************************************
+  // end of DMA transfer: release sent span of buffer and send the next one
+  __attribute__((interrupt)) void DMA1_Channel4_IRQHandler(void)
+  {
+	  if(DMA_GetITStatus(DMA1_IT_TC4) != RESET)
+	  {
+		  uint32_t primask = __get_PRIMASK();
+
+		  DMA_ClearITPendingBit(DMA1_IT_GL4);
+
+		  __disable_irq();
+		  DMA_Cmd(DMA1_Channel4, DISABLE);
+		  UART_TxTail = (UART_TxTail + UART_TxDmaLen) & UART_TX_BUF_MASK;
+		  UART_TxDmaLen = 0;
+		  uart_tx_dma_start();
+		  __set_PRIMASK(primask);
+	  }
+  }
+
+  //***********************************************************************************************
+  // send next contiguous span: from tail up to head or up to end of buffer, at most UART_TX_DMA_CHUNK bytes
+  static void uart_tx_dma_start(void)
+  {
+	  uint16_t span;
+
+	  if( UART_TxDmaLen || (UART_TxHead == UART_TxTail) ) return;
+
+	  if( UART_TxHead > UART_TxTail ) span = UART_TxHead - UART_TxTail;
+	  else							span = UART_TX_BUF_SIZE - UART_TxTail;
+
+	  if( span > UART_TX_DMA_CHUNK ) span = UART_TX_DMA_CHUNK;
+
+	  UART_TxDmaLen = span;
+
+	  DMA1_Channel4->CMAR = (uint32_t)&UART_TxBuf[UART_TxTail];
+	  DMA_SetCurrDataCounter(DMA1_Channel4, span);
+	  DMA_Cmd(DMA1_Channel4, ENABLE);
+  }
 //***********************************************************************************************
   // An event to receive text string data from a circular buffer
   void UART_RX_STR_EVENT(char * rbuf)
@@ -170,7 +278,12 @@ void UART_Conf(uint32_t BaudRate)
   			uart_get_str( rbuf );
   			(*uart_rx_str_event_callback)( rbuf );
   		} else {
-  			UART_RxHead = UART_RxTail;
+  			// nobody takes lines: unread data and line counter are dropped together,
+  			// so while( ascii_line ) loop of caller ends
+  			__disable_irq();
+  			UART_RxTail = UART_RxHead;
+  			ascii_line = 0;
+  			__enable_irq();
   		}
   	}
   }
@@ -179,53 +292,113 @@ void UART_Conf(uint32_t BaudRate)
   // we define a function that adds one byte to the circular buffer
   void uart_putc( char data )
   {
-  	uint8_t tmp_head;
+	  uart_write(&data, 1);
+  }
+
+  //***********************************************************************************************
+  // adds block to the circular buffer and starts DMA if it is idle; never waits:
+  // if there is no space for the whole block, it is dropped and counted
+  uint16_t uart_write(const char *data, uint16_t len)
+  {
+	  uint32_t primask = __get_PRIMASK();
+	  uint16_t head, space, i;
+
+	  __disable_irq();		// producers are main loop and USART1 interrupt (echo)
+
+	  head = UART_TxHead;
+	  space = (UART_TxTail - head - 1) & UART_TX_BUF_MASK;
+
+	  if( len > space )
+	  {
+		  UART_TxDropped += len;
+		  __set_PRIMASK(primask);
+		  return 0;
+	  }
+
+	  for( i = 0; i < len; i++ )
+	  {
+		  UART_TxBuf[head] = data[i];
+		  head = (head + 1) & UART_TX_BUF_MASK;
+	  }
+	  UART_TxHead = head;
+
+	  uart_tx_dma_start();
 
-  		tmp_head  = (UART_TxHead + 1) & UART_TX_BUF_MASK;
+	  __set_PRIMASK(primask);
+	  return len;
+  }
 
-      // if there is no space in the circular buffer, the loop waits for subsequent characters
-      while ( tmp_head == UART_TxTail ){}
+  //***********************************************************************************************
+  uint16_t uart_tx_free(void)		// free space in transmit buffer
+  {
+	  return (UART_TxTail - UART_TxHead - 1) & UART_TX_BUF_MASK;
+  }
 
-      UART_TxBuf[tmp_head] = data;
-      UART_TxHead = tmp_head;
+  //***********************************************************************************************
+  uint32_t uart_tx_dropped(void)	// number of bytes dropped because transmit buffer was full
+  {
+	  return UART_TxDropped;
+  }
 
-      // initialize the interrupt that occurs when the buffer is empty, thanks
-             // what the procedure will take care of later on sending data
-             // interrupt handling
-      USART_ITConfig(USART1, USART_IT_TXE, ENABLE);
+  //***********************************************************************************************
+  uint8_t uart_tx_busy(void)		// return 1 if some data wait for sending
+  {
+	  return (UART_TxHead != UART_TxTail);
   }
 
   //***********************************************************************************************
-  void uart_puts(char *s)		// sends string from RAM to UART
+  void uart_puts(const char *s)		// sends string from RAM to UART
   {
-    register char c;
-    while ((c = *s++)) uart_putc(c);			// until you encounter 0 send a character
+    uint16_t len = 0;
+    while (s[len]) len++;			// until you encounter 0 count characters
+    uart_write(s, len);				// the whole string is sent in one block
   }
 
   //***********************************************************************************************
   void uart_putint(int value, int radix)	// sends text to the serial port
   {
   	char string[17];				// buffer for the result of itoa function
-  	itoa(value, string, radix);		// convert value to ASCII
+  	if (radix == 10) FORMAT_Int(string, value);	// decimal without division
+  	else itoa(value, string, radix);				// convert value to ASCII
   	uart_puts(string);				// send string to serial port
   }
 
+  //***********************************************************************************************
+  void uart_putfixed(int32_t value, uint8_t width)	// sends fixed-point value x 0,01 to the serial port
+  {
+  	char string[FORMAT_FIXED2_MAX + 8];			// value of any width up to FORMAT_FIXED2_MAX + 7 characters
+  	if (width > FORMAT_FIXED2_MAX + 7) width = FORMAT_FIXED2_MAX + 7;
+  	FORMAT_Fixed2(string, value, width);		// convert value to ASCII without itoa
+  	uart_puts(string);							// send string to serial port
+  }
+
   //***********************************************************************************************
   // we define a function that takes one byte from the circular buffer
   int uart_getc(void)
   {
-  	int data = -1;
+  	int data;
+
+  	do
+  	{
       // we check if the indexes are equal
-      if ( UART_RxHead == UART_RxTail ) return data;
+      if ( UART_RxHead == UART_RxTail ) return -1;
 
-      // we calculate and remember the new index of the "snake's tail" (it may align with the head)
-      UART_RxTail = (UART_RxTail + 1) & UART_RX_BUF_MASK;
       // we return the byte downloaded from the buffer as the result of the function
       data = UART_RxBuf[UART_RxTail];
+      // we calculate and remember the new index of the "snake's tail" (it may align with the head)
+      UART_RxTail = (UART_RxTail + 1) & UART_RX_BUF_MASK;
+  	}
+  	while( (data == 0) || (data == 10) );		// ignore byte = 0 and LF
 
       return data;
   }
 
+  //***********************************************************************************************
+  uint32_t uart_rx_overruns(void)	// number of times receive buffer was flushed because it was full
+  {
+	  return UART_RxOverruns;
+  }
+
   //***********************************************************************************************
   char * uart_get_str(char * buf)
   {
@@ -233,13 +406,15 @@ void UART_Conf(uint32_t BaudRate)
 	  char * wsk = buf;
 	  if( ascii_line )
 	  {
-		while( (c = uart_getc()) )
+		while( (c = uart_getc()) >= 0 )
 		{
-			if( 13 == c || c < 0) break;
+			if( 13 == c ) break;
   			*buf++ = c;
   		}
   		*buf=0;
+  		__disable_irq();			// ascii_line is incremented in interrupt
   		ascii_line--;
+  		__enable_irq();
 	  }
 	  return wsk;
   }
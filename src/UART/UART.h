@@ -12,6 +12,7 @@
 //#include "F103_lib.h"
 //#include "../CLOCK/clock.h"
 #include <stdlib.h>
+#include "../FORMAT/FORMAT.h"
 
 #define UART_RXB	128		/* Size of Rx buffer */
 #define UART_TXB	128		/* Size of Tx buffer */
@@ -20,24 +21,38 @@ void UART_Conf(uint32_t BaudRate);
 
 #define UART_BAUD 115200	// define the speed of interest to us
 
-#define UART_RX_BUF_SIZE 32	// we define a buffer of 32 bytes
+// receive: DMA1 channel 5 writes to circular buffer, new data are taken over in USART1 IDLE
+// interrupt (end of frame) and in DMA half/full transfer interrupts (long frames), not per byte
+#define UART_RX_BUF_SIZE 128	// size of receive buffer, power of 2
 #define UART_RX_BUF_MASK ( UART_RX_BUF_SIZE - 1)	// we define a mask for our buffer
+#define UART_RX_ECHO 1			// send received data back
 
-#define UART_TX_BUF_SIZE 2 // we define a buffer of 16 bytes
+// transmit: ring buffer is sent by DMA1 channel 4 in contiguous spans, writing to it never waits,
+// data which don't fit are dropped and counted
+#define UART_TX_BUF_SIZE 512	// size of transmit buffer, power of 2
 #define UART_TX_BUF_MASK ( UART_TX_BUF_SIZE - 1)	// we define a mask for our buffer
+#define UART_TX_DMA_CHUNK 64	// maximum length of one DMA transfer, space is released after every chunk
+#define UART_TX_IRQ_PRIORITY 3	// preemption priority of DMA1 channel 4 interrupt
 
 extern volatile uint8_t ascii_line;
 
 // declarations of public functions
 int uart_getc(void);
 void uart_putc( char data );
-void uart_puts(char *s);
+uint16_t uart_write(const char *data, uint16_t len);	// enqueue whole block or nothing, return number of enqueued bytes
+uint16_t uart_tx_free(void);							// free space in transmit buffer
+uint32_t uart_tx_dropped(void);							// number of bytes dropped because transmit buffer was full
+uint8_t uart_tx_busy(void);								// return 1 if some data wait for sending
+uint32_t uart_rx_overruns(void);						// number of times receive buffer was flushed because it was full
+void uart_puts(const char *s);
 void uart_putint(int value, int radix);
+void uart_putfixed(int32_t value, uint8_t width);	// sends value x 0,01 as "[-]I,FF" padded with spaces to width
 
 char * uart_get_str(char * buf);
 
 void UART_RX_STR_EVENT(char * rbuf);
 void register_uart_str_rx_event_callback(void (*callback)(char * pBuf));
+void register_uart_rx_line_callback(void (*callback)(void));	// called from interrupt when next line is received
 
 
 #endif /* UART_UART_H_ */
@@ -15,11 +15,45 @@
 #include "BME280/BME280.h"
 #include "COMMON/common_var.h"
 #include "SPI/SPI.h"
+#include "MEASURE/MEASURE.h"
+#include "BME280/BME280_sim.h"
+#include "SCHEDULER/SCHEDULER.h"
+#include "POWER/POWER.h"
+#include "PROFILE/PROFILE.h"
 
 
 ErrorStatus HSEStartUpStatus;
 #define F_PCLK2  72000000
 #define MEASURE_PERIOD 1000 // measure period in ms
+#define MEASURE_STREAM 0 // 1 -> sensor works in normal mode and every conversion is read, 0 -> forced measure every MEASURE_PERIOD
+
+// tasks of scheduler, number is priority (0 - the highest)
+#define TASK_MEASURE	0	// start of measure and calculation of values
+#define TASK_COMMAND	1	// commands received by UART
+#define TASK_OUTPUT		2	// printing of results
+
+// events of tasks
+#define EV_MEASURE_START	0x01	// measure period passed
+#define EV_MEASURE_DATA		0x02	// raw data of sensor are ready
+#define EV_MEASURE_VERIFY	0x04	// read back configuration registers
+#define EV_COMMAND_LINE		0x01	// line received by UART
+#define EV_OUTPUT_RESULT	0x01	// print calculated values or error of calculation
+#define EV_OUTPUT_CONF_ERR	0x02	// print configuration error
+#define EV_OUTPUT_STREAM	0x04	// print statistics of streaming
+#define EV_OUTPUT_MEASURE	0x08	// print counters of measure cycles
+#define EV_OUTPUT_POWER		0x10	// print awake time
+#define EV_OUTPUT_PROFILE	0x20	// print execution time of driver stages
+#define EV_OUTPUT_LATENCY	0x40	// print next latency histogram
+
+#define TIMER_MEASURE		0		// software timer of measure period
+#define TIMER_OUTPUT		1		// pace of printing of latency histograms
+#define TIMER_PROFILE		2		// pace of printing of profile report
+#define TIMER_VERIFY		3		// period of configuration readback
+
+#define LATENCY_PRINT_PERIOD	20		// histograms are printed one by one, so transmit buffer isn't overflowed [ms]
+#define LATENCY_TEXT_SIZE		704		// the longest histogram: header, summary line and all bins
+#define PROFILE_PRINT_PERIOD	20		// the rest of profile report which didn't fit into transmit buffer [ms]
+#define PROFILE_TEXT_SIZE		704		// report with all stages (~680 characters)
 
 
 
@@ -28,116 +62,468 @@ void GPIO_Conf(void);
 void NVIC_Conf(void);
 void SysTick_Conf(void);
 
-uint32_t allow_for_measure = 0;
-volatile uint8_t flag = 1;
+static void task_measure(uint32_t events);
+static void task_command(uint32_t events);
+static void task_output(uint32_t events);
+static void measure_ready(BME280 *bmp);		// called from interrupt
+static void line_received(void);			// called from interrupt
+static uint8_t latency_format_next(void);	// text of next histogram of latency snapshot, return 0 after the last one
+static void latency_append(const char *str);	// print function of histogram_report() into latency_text
+static uint8_t text_send(const char *text, uint16_t len, uint16_t *sent);	// whole lines which fit into transmit buffer, return 1 when all are sent
+#if PROFILE_ENABLE
+static void profile_append(const char *str);	// print function of PROFILE_Report() into profile_text
+#endif
+static void parse_command(char *line);
+
+BME280 bme;
+#if BME280_USE_SIM
+BME280_SIM bme_sim;
+#endif
+uint8_t result_BME_conf;
+uint8_t result_calculate;
 uint32_t start_measure = 0;
-uint16_t result_time = 0;
-char measure_time[15];
+uint32_t result_time = 0;		// duration of measure [us]
+char measure_time[FORMAT_UINT_MAX];
+char command_line[UART_RX_BUF_SIZE];
+#if MEASURE_STREAM
+MEASURE_STREAM_STATS stream_stats;
+#endif
+MEASURE_LATENCY latency_copy;
+uint8_t latency_step;		// sensor * 3 + histogram, which is printed next
+char latency_text[LATENCY_TEXT_SIZE];
+uint16_t latency_len;		// length of formatted histogram
+uint16_t latency_sent;		// part of it which is in transmit buffer
+#if PROFILE_ENABLE
+char profile_text[PROFILE_TEXT_SIZE];
+uint16_t profile_len;		// length of formatted report, 0 -> report has to be formatted
+uint16_t profile_sent;		// part of it which is in transmit buffer
+#endif
 
 int main(void)
 {
-
-	uint8_t result_BME_conf;
-	uint8_t result;
-
 	RCC_Conf();
-	SysTick_Conf();
+	NVIC_Conf();			// priority group before any NVIC_Init: it encodes priority by current group (reset value gives 0)
+	CLOCK_Conf();
+	PROFILE_Conf();
+#if !CLOCK_TICKLESS || BME280_I2C
+	SysTick_Conf();			// in tickless mode SysTick only checks timeout of I2C
+#endif
 	GPIO_Conf();
 	UART_Conf(UART_BAUD);
-	NVIC_Conf();
 
 #if BME280_I2C
 	I2C_Conf(400);
 #endif
 
-#if BME280_SPI
+#if BME280_USE_SIM
+	BME280_Sim_Init(&bme_sim, 0, 0, 0);
+	BME280_Init_Sim(&bme, &bme_sim);
+#elif BME280_SPI
 	SPI_Conf();
+	BME280_Init_SPI(&bme, GPIOA, GPIO_Pin_0);
+#else
+	BME280_Init_I2C(&bme, BME280_ADDR);
+#endif
+
+#if MEASURE_STREAM
+	BME280_Set_Normal_Mode(&bme, BME280_STANDBY_MS_500, BME280_FILTER_X4);
 #endif
 
 	do
 	{
-		result_BME_conf = BME280_Conf(&conf_BME280, &bme);
+		result_BME_conf = BME280_Conf(&bme);
 	}
 	while(result_BME_conf == 3);
 
-	while(1)
+	MEASURE_Conf();
+	MEASURE_Register(&bme);
+	MEASURE_Set_Callback(measure_ready);
+#if MEASURE_STREAM
+	if(!result_BME_conf) MEASURE_Stream_Start(&bme);
+#endif
+
+	SCHEDULER_Register(TASK_MEASURE, task_measure);
+	SCHEDULER_Register(TASK_COMMAND, task_command);
+	SCHEDULER_Register(TASK_OUTPUT, task_output);
+
+	register_uart_rx_line_callback(line_received);
+	register_uart_str_rx_event_callback(parse_command);
+
+	POWER_Conf();
+	SCHEDULER_Set_Idle(POWER_Idle);		// CPU sleeps when no event is pending
+#if CLOCK_TICKLESS
+	SCHEDULER_Set_Time_Source(get_time_ms);
+#endif
+
+	SCHEDULER_Timer_Start(TIMER_MEASURE, TASK_MEASURE, EV_MEASURE_START, MEASURE_PERIOD);
+	SCHEDULER_Post(TASK_MEASURE, EV_MEASURE_START);		// the first measure without waiting for period
+	SCHEDULER_Timer_Start(TIMER_VERIFY, TASK_MEASURE, EV_MEASURE_VERIFY, BME280_VERIFY_PERIOD);
+
+	SCHEDULER_Run();
+}
+
+/****************************************************************************/
+/*      start of measure every period and calculation of read data			*/
+/****************************************************************************/
+static void task_measure(uint32_t events)
+{
+	if(events & EV_MEASURE_START)
+	{
+		if(result_BME_conf)
+		{
+			SCHEDULER_Post(TASK_OUTPUT, EV_OUTPUT_CONF_ERR);
+		}
+		else
+		{
+#if MEASURE_STREAM
+			SCHEDULER_Post(TASK_OUTPUT, EV_OUTPUT_STREAM);
+#else
+			start_measure = get_time_us();
+			MEASURE_Start();
+#endif
+		}
+	}
+
+	if(events & EV_MEASURE_VERIFY)
+	{
+		if(BME280_Verify(&bme)) result_BME_conf = 2;		// measure stops, error is printed every period
+	}
+
+	if((events & EV_MEASURE_DATA) && bme.data_ready)
+	{
+		result_calculate = BME280_Calculate(&bme);
+		result_time = get_time_us() - start_measure;
+		SCHEDULER_Post(TASK_OUTPUT, EV_OUTPUT_RESULT);
+	}
+}
+
+/****************************************************************************/
+/*      every received line is one command									*/
+/****************************************************************************/
+static void task_command(uint32_t events)
+{
+	(void)events;
+	while(ascii_line) UART_RX_STR_EVENT(command_line);
+}
+
+/****************************************************************************/
+/*      commands:															*/
+/*          period <ms>  -> change measure period							*/
+/*          power        -> print awake time and reset its counters		*/
+/*          profile      -> print time of driver stages and reset it		*/
+/*          latency      -> print latency histograms and reset them			*/
+/*          measure      -> print reads, retries and missed reads of cycles	*/
+/*          reference <Pa> -> reference pressure of altitude (e.g. QNH)		*/
+/****************************************************************************/
+static void parse_command(char *line)
+{
+	int period, reference;
+
+	if(!strcmp(line, "power"))
+	{
+		SCHEDULER_Post(TASK_OUTPUT, EV_OUTPUT_POWER);
+		return;
+	}
+
+	if(!strcmp(line, "measure"))
+	{
+		SCHEDULER_Post(TASK_OUTPUT, EV_OUTPUT_MEASURE);
+		return;
+	}
+
+	if(!strcmp(line, "latency"))
+	{
+		latency_step = 0;
+		latency_len = latency_sent = 0;
+		SCHEDULER_Timer_Start(TIMER_OUTPUT, TASK_OUTPUT, EV_OUTPUT_LATENCY, LATENCY_PRINT_PERIOD);
+		SCHEDULER_Post(TASK_OUTPUT, EV_OUTPUT_LATENCY);
+		return;
+	}
+
+#if PROFILE_ENABLE
+	if(!strcmp(line, "profile"))
+	{
+		profile_len = profile_sent = 0;
+		SCHEDULER_Timer_Start(TIMER_PROFILE, TASK_OUTPUT, EV_OUTPUT_PROFILE, PROFILE_PRINT_PERIOD);
+		SCHEDULER_Post(TASK_OUTPUT, EV_OUTPUT_PROFILE);
+		return;
+	}
+#endif
+
+	if(!strncmp(line, "period ", 7))
+	{
+		period = atoi(&line[7]);
+		if(period > 0)
+		{
+			SCHEDULER_Timer_Start(TIMER_MEASURE, TASK_MEASURE, EV_MEASURE_START, period);
+			uart_puts("\n\rperiod = ");
+			uart_putint(period, 10);
+			uart_puts("ms\n\r");
+			return;
+		}
+	}
+
+	if(!strncmp(line, "reference ", 10))
+	{
+		reference = atoi(&line[10]);
+		if(BME280_Set_Reference_Pressure(&bme, reference))
+		{
+			uart_puts("\n\rreference out of range ");
+			uart_putint(BME280_REFERENCE_MIN, 10);
+			uart_puts("..");
+			uart_putint(BME280_REFERENCE_MAX, 10);
+			uart_puts("Pa\n\r");
+			return;
+		}
+		uart_puts("\n\rreference = ");
+		uart_putint(reference, 10);
+		uart_puts("Pa\n\r");
+		return;
+	}
+
+	uart_puts("\n\runknown command\n\r");
+}
+
+/****************************************************************************/
+/*      printing of results, the lowest priority							*/
+/****************************************************************************/
+static void task_output(uint32_t events)
+{
+	if(events & EV_OUTPUT_CONF_ERR)
+	{
+		uart_puts("Sensor configuration error:");
+		if(bme.err_conf == calib_reg)  uart_puts(" calibration coefficients includes zero value,");
+		if(bme.err_conf == config_reg) uart_puts(" configuration registers error,");
+		if(bme.err_conf == both) uart_puts(" calibration coefficients includes zero value and configuration registers error,");
+		uart_puts("\n\r");
+	}
+
+	if(events & EV_OUTPUT_POWER)
+	{
+		POWER_STATS power;
+		char number[FORMAT_UINT_MAX];
+
+		POWER_Stats(&power);
+		POWER_Reset_Stats();
+		uart_puts("\n\rawake = ");
+		FORMAT_Uint(number, (uint32_t)(power.awake_us / 1000));		// ms: 32 bits for 49 days
+		uart_puts(number);
+		uart_puts("ms  sleep = ");
+		FORMAT_Uint(number, (uint32_t)(power.sleep_us / 1000));
+		uart_puts(number);
+		uart_puts("ms  duty = ");
+		uart_putfixed(POWER_Duty_Cycle(&power) * 10, 0);
+		uart_puts("%  wakeups = ");
+		uart_putint(power.sleeps + power.stops, 10);
+		uart_puts("\n\r");
+	}
+
+	if(events & EV_OUTPUT_MEASURE)
+	{
+		MEASURE_STATS measure;
+
+		MEASURE_Stats(&measure, 1);
+		uart_puts("\n\rcycles = ");
+		uart_putint(measure.cycles, 10);
+		uart_puts("  reads = ");
+		uart_putint(measure.reads, 10);
+		uart_puts("  retries = ");
+		uart_putint(measure.retries, 10);
+		uart_puts("  missed = ");
+		uart_putint(measure.missed, 10);
+		uart_puts("\n\r");
+	}
+
+	if(events & EV_OUTPUT_LATENCY)
+	{
+		if(latency_sent == latency_len)		// previous histogram is sent, format the next one
+		{
+			latency_len = latency_sent = 0;
+			if(latency_format_next()) text_send(latency_text, latency_len, &latency_sent);
+		}
+		else text_send(latency_text, latency_len, &latency_sent);		// the rest of lines which didn't fit in the last period
+	}
+
+#if PROFILE_ENABLE
+	if(events & EV_OUTPUT_PROFILE)
+	{
+		if(!profile_len)					// report is longer than free space of transmit buffer, it is sent by lines
+		{
+			PROFILE_Report(profile_append);
+			PROFILE_Reset();
+		}
+		if(text_send(profile_text, profile_len, &profile_sent)) SCHEDULER_Timer_Stop(TIMER_PROFILE);
+	}
+#endif
+
+#if MEASURE_STREAM
+	if(events & EV_OUTPUT_STREAM)
+	{
+		MEASURE_Stream_Stats(&stream_stats);
+		uart_puts("ODR = ");
+		uart_putint(MEASURE_Stream_ODR(&stream_stats), 10);
+		uart_puts("mHz  duplicates = ");
+		uart_putint(stream_stats.duplicates, 10);
+		uart_puts("  skipped = ");
+		uart_putint(stream_stats.skipped, 10);
+		uart_puts("  drifts = ");
+		uart_putint(stream_stats.drifts, 10);
+		uart_puts("\n\r");
+	}
+#endif
+
+	if(events & EV_OUTPUT_RESULT)
 	{
-		if(flag)
+		switch(result_calculate)
 		{
-			flag = 0;
+		case 3:
+			switch(bme.err_boundaries_T)
+			{
+			case T_lower_limit:
+				uart_puts(" Measured raw value of temperature is lower than minimum value (0x00000),");
+				break;
+			case T_over_limit:
+				uart_puts(" Measured raw value of temperature is over than maximum value (0x800000),");
+				break;
+			}
 
-			if(result_BME_conf)
+			switch(bme.err_boundaries_P)
 			{
-				uart_puts("Sensor configuration error:");
-				if(bme.err_conf == calib_reg)  uart_puts(" calibration coefficients includes zero value,");
-				if(bme.err_conf == config_reg) uart_puts(" configuration registers error,");
-				if(bme.err_conf == both) uart_puts(" calibration coefficients includes zero value and configuration registers error,");
-				uart_puts("\n\r");
+			case P_lower_limit:
+				uart_puts(" Measured raw value of pressure is lower than minimum value (0x00000),");
+				break;
+			case P_over_limit:
+				uart_puts(" Measured raw value of pressure is over than maximum value (0x800000),");
+				break;
 			}
-			else
+
+			switch(bme.err_boundaries_H)
 			{
-				start_measure = source_time;
-				result = BME280_ReadTPH(&bme);
-
-				switch(result)
-				{
-				case 1:
-					uart_puts("Sensor error. Initialization phase didn't go properly.");
-					uart_puts("\n\r");
-					flag = 0;
-					break;
-
-				case 2:
-					break;
-
-				case 3:
-					switch(bme.err_boundaries_T)
-					{
-					case T_lower_limit:
-						uart_puts(" Measured raw value of temperature is lower than minimum value (0x00000),");
-						break;
-					case T_over_limit:
-						uart_puts(" Measured raw value of temperature is over than maximum value (0x800000),");
-						break;
-					}
-
-					switch(bme.err_boundaries_T)
-					{
-					case P_lower_limit:
-						uart_puts(" Measured raw value of pressure is lower than minimum value (0x00000),");
-						break;
-					case P_over_limit:
-						uart_puts(" Measured raw value of pressure is over than maximum value (0x800000),");
-						break;
-					}
-					break;
-				case 4:
-					uart_puts(" Try to divide by 0 (measuring is intermittent.)");
-					break;
-
-				default:
-					result_time = source_time - start_measure;
-
-					uart_puts(bme.temp2str);
-					uart_puts("C");
-					uart_puts("  ");
-					uart_puts(bme.pressure2str);
-					uart_puts("hPa");
-					uart_puts("  ");
-					uart_puts(bme.humi2str);
-					uart_puts("%");
-
-					uart_puts("  ");
-					itoa(result_time, measure_time,10);
-					uart_puts("measure take = ");
-					uart_puts(measure_time);
-					uart_puts("ms");
-					uart_puts("\n\r");
-				}
+			case H_lower_limit:
+				uart_puts(" Measured raw value of humidity is lower than minimum value (0x0000),");
+				break;
+			case H_over_limit:
+				uart_puts(" Measured raw value of humidity is over than maximum value (0x8000),");
+				break;
 			}
+			break;
+		case 4:
+			uart_puts(" Try to divide by 0 (measuring is intermittent.)");
+			break;
+
+		default:
+			uart_puts(BME280_Temp_Str(&bme));
+			uart_puts("C");
+			uart_puts("  ");
+			uart_puts(BME280_Pressure_Str(&bme));
+			uart_puts("hPa");
+			uart_puts("  ");
+			uart_puts(BME280_Humi_Str(&bme));
+			uart_puts("%");
+
+			uart_puts("  ");
+			FORMAT_Uint(measure_time, result_time);
+			uart_puts("measure take = ");
+			uart_puts(measure_time);
+			uart_puts("us");
+			uart_puts("\n\r");
+		}
 
+		GPIO_WriteBit(GPIOC, GPIO_Pin_13, (BitAction)!GPIO_ReadOutputDataBit(GPIOC, GPIO_Pin_13));	// led blinks once per sample
+	}
+}
+
+/****************************************************************************/
+/*      snapshot of sensor is taken (and reset) before its first histogram, */
+/*      printing stops after the last registered sensor						*/
+/****************************************************************************/
+static uint8_t latency_format_next(void)
+{
+	uint8_t sensor = latency_step / 3;
+	char number[FORMAT_UINT_MAX];
+
+	switch(latency_step % 3)
+	{
+	case 0:
+		if(MEASURE_Latency(sensor, &latency_copy, 1))
+		{
+			SCHEDULER_Timer_Stop(TIMER_OUTPUT);
+			return 0;
 		}
+		FORMAT_Uint(number, sensor);
+		latency_append("\n\rsensor ");
+		latency_append(number);
+		latency_append("      count / min / mean / max / jitter / p50 / p99 [us]\n\r");
+		histogram_report(&latency_copy.trigger_to_data, "trigger-to-data ", latency_append);
+		break;
+	case 1:
+		histogram_report(&latency_copy.read, "read            ", latency_append);
+		break;
+	default:
+		histogram_report(&latency_copy.interval, "interval        ", latency_append);
+		break;
+	}
+
+	latency_step++;
+	return 1;
+}
+
+static void latency_append(const char *str)
+{
+	uint16_t len = strlen(str);
+
+	if(len > LATENCY_TEXT_SIZE - latency_len) len = LATENCY_TEXT_SIZE - latency_len;
+	memcpy(&latency_text[latency_len], str, len);
+	latency_len += len;
+}
+
+#if PROFILE_ENABLE
+static void profile_append(const char *str)
+{
+	uint16_t len = strlen(str);
+
+	if(len > PROFILE_TEXT_SIZE - profile_len) len = PROFILE_TEXT_SIZE - profile_len;
+	memcpy(&profile_text[profile_len], str, len);
+	profile_len += len;
+}
+#endif
+
+/****************************************************************************/
+/*      every line is enqueued whole or not at all (uart_write), so output	*/
+/*      isn't cut when transmit buffer is full; the rest waits for the		*/
+/*      next period. Line ends by "\n\r", the longest one (all bins) fits	*/
+/*      into empty transmit buffer											*/
+/****************************************************************************/
+static uint8_t text_send(const char *text, uint16_t len, uint16_t *sent)
+{
+	uint16_t end;
+
+	while(*sent < len)
+	{
+		end = *sent;
+		while((end < len) && (text[end] != '\n')) end++;
+		end += 2;
+		if(end > len) end = len;
+
+		if(uart_tx_free() < end - *sent) return 0;		// the rest waits for the next period
+		if(!uart_write(&text[*sent], end - *sent)) return 0;
+		*sent = end;
 	}
+	return 1;
+}
+
+/****************************************************************************/
+/*      callbacks from interrupts only post events							*/
+/****************************************************************************/
+static void measure_ready(BME280 *bmp)
+{
+	(void)bmp;
+	SCHEDULER_Post(TASK_MEASURE, EV_MEASURE_DATA);
+}
+
+static void line_received(void)
+{
+	SCHEDULER_Post(TASK_COMMAND, EV_COMMAND_LINE);
 }
 
 
@@ -207,12 +593,15 @@ void NVIC_Conf(void)
 {
 
   NVIC_SetVectorTable(NVIC_VectTab_FLASH, 0x0);
+
+  // all 4 priority bits for pre-emption, so bus interrupts can preempt timer callbacks
+  NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
 }
 
 
 void GPIO_Conf(void)
 {
-	// Set pin PC13 as blinking led
+	// Set pin PC13 as led, it blinks once per sample
 	GPIO_InitTypeDef GPIOInit;
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC, ENABLE);
 
@@ -229,29 +618,11 @@ void GPIO_Conf(void)
 
 __attribute__((interrupt)) void SysTick_Handler(void)
 {
-	static uint16_t counter = 0;
-	static uint8_t status = 0;
-
-	if(counter == MEASURE_PERIOD)
-	{
-		allow_for_measure = source_time;
-		flag = 1;
-		counter = 0;
-	}
-	else
-	{
-		counter++;
-	}
-	source_time++;
+#if !CLOCK_TICKLESS
+	SCHEDULER_Tick();
+#endif
 
-	if(0 == status)
-	{
-		GPIO_ResetBits(GPIOC, GPIO_Pin_13);
-		status = 1;
-	}
-	else
-	{
-		GPIO_SetBits(GPIOC, GPIO_Pin_13);;
-		status = 0;
-	}
+#if BME280_I2C
+	I2C_Timeout_Check();
+#endif
 }
@@ -0,0 +1,54 @@
+/*
+ * bench_backends.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Cost of one sample (T + P + H) of every compensation back end called
+// through bme280_compensate(). Host cycles show only ratios: on
+// Cortex-M3 without FPU the float back end runs in software float and
+// 64-bit division of int64 back end is a library call, there the same
+// stages are measured by PROFILE probes.
+#include "test.h"
+#include "bench.h"
+
+#define SAMPLES		4096
+#define ROUNDS		200
+
+static BME280 bme;
+static int32_t adc_T[SAMPLES], adc_P[SAMPLES], adc_H[SAMPLES];
+
+int main(void)
+{
+	static const uint8_t backends[] = {BME280_BACKEND_INT32, BME280_BACKEND_INT64, BME280_BACKEND_FLOAT};
+	static const char *names[] = {"int32", "int64", "float"};
+	BENCH bench[3];
+	BME280_TPH tph;
+	uint32_t sum;
+
+	bench_sensor(&bme);
+	for (uint32_t i = 0; i < SAMPLES; i++) bench_raw(i, &adc_T[i], &adc_P[i], &adc_H[i]);
+
+	printf("back end  [ns/sample] [cycles]\n");
+	for (uint8_t b = 0; b < 3; b++)
+	{
+		sum = 0;
+		bench_start(&bench[b]);
+		for (uint32_t r = 0; r < ROUNDS; r++)
+		{
+			for (uint32_t i = 0; i < SAMPLES; i++)
+			{
+				sum += bme280_compensate(backends[b], &bme.calib, adc_T[i], adc_P[i], adc_H[i], &tph);
+				sum += tph.temperature + tph.pressure + tph.humidity;
+			}
+		}
+		bench_stop(&bench[b], ROUNDS * SAMPLES);
+		bench_sink = sum;
+
+		printf("%-8s %12.1f %9.1f\n", names[b], bench[b].ns, bench[b].cycles);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,98 @@
+/*
+ * bench_batch.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Samples per second of compensation: batch of raw samples in struct of
+// arrays (BME280_Compensate_Batch) against single-sample functions called
+// for every sample and against driver path BME280_Calculate() (unpacking of
+// data registers, boundaries, averaging, sea level and profiling probes)
+// for every sample. Batch results have to be equal to single-sample ones.
+#include "test.h"
+#include "bench.h"
+
+#define SAMPLES		4096
+#define ROUNDS		200
+
+static BME280 bme;
+static int32_t adc_T[SAMPLES], adc_P[SAMPLES], adc_H[SAMPLES];
+static uint8_t regs[SAMPLES][BME280_DATA_SIZE];
+static int32_t temperature[SAMPLES], single_T[SAMPLES];
+static uint32_t pressure[SAMPLES], humidity[SAMPLES], single_P[SAMPLES], single_H[SAMPLES];
+
+static void print_rate(const char *name, const BENCH *b)
+{
+	printf("%-24s %10.1f %9.1f %12.0f\n", name, b->ns, b->cycles, 1e9 / b->ns);
+}
+
+int main(void)
+{
+	const BME280_RAW_BATCH raw = {adc_T, adc_P, adc_H};
+	BME280_TPH_BATCH out = {temperature, pressure, humidity};
+	BENCH batch, single, calculate;
+	uint32_t mismatches = 0;
+	int32_t t_fine;
+
+	bench_sensor(&bme);
+	for (uint32_t i = 0; i < SAMPLES; i++)
+	{
+		bench_raw(i, &adc_T[i], &adc_P[i], &adc_H[i]);
+		bench_pack_raw(adc_T[i], adc_P[i], adc_H[i], regs[i]);
+	}
+
+	// ----- batch gives the same values as single-sample functions -----
+	CHECK_EQ(BME280_Compensate_Batch(&bme.calib, &raw, &out, SAMPLES), 0);
+	for (uint32_t i = 0; i < SAMPLES; i++)
+	{
+		single_T[i] = bme280_compensate_T(&bme.calib, adc_T[i], &t_fine);
+		single_P[i] = bme280_compensate_P(&bme.calib, adc_P[i], t_fine);
+		single_H[i] = bme280_compensate_H(&bme.calib, adc_H[i], t_fine);
+		if ((temperature[i] != single_T[i]) || (pressure[i] != single_P[i]) || (humidity[i] != single_H[i])) mismatches++;
+	}
+	CHECK_EQ(mismatches, 0);
+
+	// ----- throughput -----
+	bench_start(&batch);
+	for (uint32_t r = 0; r < ROUNDS; r++)
+	{
+		bench_sink = BME280_Compensate_Batch(&bme.calib, &raw, &out, SAMPLES);
+	}
+	bench_stop(&batch, ROUNDS * SAMPLES);
+
+	bench_start(&single);
+	for (uint32_t r = 0; r < ROUNDS; r++)
+	{
+		for (uint32_t i = 0; i < SAMPLES; i++)
+		{
+			single_T[i] = bme280_compensate_T(&bme.calib, adc_T[i], &t_fine);
+			single_P[i] = bme280_compensate_P(&bme.calib, adc_P[i], t_fine);
+			single_H[i] = bme280_compensate_H(&bme.calib, adc_H[i], t_fine);
+		}
+	}
+	bench_stop(&single, ROUNDS * SAMPLES);
+	bench_sink = single_T[SAMPLES - 1] + single_P[SAMPLES - 1] + single_H[SAMPLES - 1];
+
+	bench_start(&calculate);
+	for (uint32_t r = 0; r < ROUNDS; r++)
+	{
+		for (uint32_t i = 0; i < SAMPLES; i++)
+		{
+			memcpy(bme.raw, regs[i], BME280_DATA_SIZE);
+			bench_sink = BME280_Calculate(&bme);
+		}
+	}
+	bench_stop(&calculate, ROUNDS * SAMPLES);
+	CHECK_EQ(bme.temperature, single_T[SAMPLES - 1]);
+
+	printf("compensation             [ns/sample] [cycles]  [samples/s]\n");
+	print_rate("batch", &batch);
+	print_rate("single-sample functions", &single);
+	print_rate("BME280_Calculate", &calculate);
+
+	CHECK(batch.ns < calculate.ns);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,141 @@
+/*
+ * bench_calib.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Cycles of compensation with prepared calibration (BME280_CALIB, terms
+// computed once by bme280_prepare_calibration) against the same formulas
+// which extend coefficients of TCOEF and compute dig_T1 * 2, dig_P4 << 16,
+// dig_P5 * 2 and dig_H4 * 1048576 for every sample, as before.
+// Both have to give the same values.
+#include "test.h"
+#include "bench.h"
+
+#define SAMPLES		4096
+#define ROUNDS		200
+
+static BME280 bme;
+static int32_t adc_T[SAMPLES], adc_P[SAMPLES], adc_H[SAMPLES];
+
+/****************************************************************************/
+/*      former compensation: terms of calibration in every call				*/
+/****************************************************************************/
+__attribute__((noinline)) static int32_t coef_compensate_T(const TCOEF *coef, int32_t adc_T, int32_t *t_fine)
+{
+	int32_t var1, var2, temperature;
+
+	var1 = (((adc_T >> 3) - ((int32_t)coef->dig_T1 * 2)) * ((int32_t)coef->dig_T2)) >> 11;
+	var2 = (adc_T >> 4) - ((int32_t)coef->dig_T1);
+	var2 = (((var2 * var2) >> 12) * ((int32_t)coef->dig_T3)) >> 14;
+	*t_fine = var1 + var2;
+	temperature = (*t_fine * 5 + 128) >> 8;
+
+	if      (temperature < -4000) temperature = -4000;
+	else if (temperature > 8500)  temperature = 8500;
+
+	return temperature;
+}
+
+__attribute__((noinline)) static uint32_t coef_compensate_P(const TCOEF *coef, int32_t adc_P, int32_t t_fine)
+{
+	int32_t var1, var2;
+	uint32_t p;
+
+	var1 = (t_fine >> 1) - (int32_t)64000;
+	var2 = (((var1 >> 2) * (var1 >> 2)) >> 11 ) * ((int32_t)coef->dig_P6);
+	var2 = var2 + ((var1 * ((int32_t)coef->dig_P5)) << 1);
+	var2 = (var2 >> 2) + (((int32_t)coef->dig_P4) << 16);
+	var1 = (((coef->dig_P3 * (((var1 >> 2) * (var1 >> 2)) >> 13 )) >> 3) + ((((int32_t)coef->dig_P2) * var1) >> 1)) >> 18;
+	var1 = ((32768 + var1) * ((int32_t)coef->dig_P1)) >> 15;
+
+	if (var1 == 0) return 0;
+
+	p = (((uint32_t)(((int32_t)1048576) - adc_P) - (var2 >> 12))) * 3125;
+
+	if (p < 0x80000000) p = (p << 1) / ((uint32_t)var1);
+	else				p = (p / (uint32_t)var1) * 2;
+
+	var1 = (((int32_t)coef->dig_P9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+	var2 = (((int32_t)(p >> 2)) * ((int32_t)coef->dig_P8)) >> 13;
+	return (uint32_t)((int32_t)p + ((var1 + var2 + coef->dig_P7) >> 4));
+}
+
+__attribute__((noinline)) static uint32_t coef_compensate_H(const TCOEF *coef, int32_t adc_H, int32_t t_fine)
+{
+	int32_t var1, var2, var3, var4, var5;
+	uint32_t humidity;
+
+	var1 = t_fine - ((int32_t)76800);
+	var5 = (((adc_H << 14) - ((int32_t)coef->dig_H4 * 1048576) - ((int32_t)coef->dig_H5) * var1) + (int32_t)16384) >> 15;
+	var2 = (var1 * ((int32_t)coef->dig_H6)) >> 10;
+	var3 = (var1 * ((int32_t)coef->dig_H3)) >> 11;
+	var4 = ((var2 * (var3 + (int32_t)32768)) >> 10) + (int32_t)2097152;
+	var2 = ((var4 * ((int32_t)coef->dig_H2)) + 8192) >> 14;
+	var3 = var5 * var2;
+	var4 = ((var3 >> 15) * (var3 >> 15)) >> 7;
+	var5 = var3 - ((var4 * ((int32_t)coef->dig_H1)) >> 4);
+	var5 = (var5 < 0 ? 0 : var5);
+	var5 = (var5 > 419430400 ? 419430400 : var5);
+	humidity = (uint32_t)(var5 >> 12);
+
+	return (humidity > 102400) ? 102400 : humidity;
+}
+
+int main(void)
+{
+	BENCH prepared, coef;
+	uint32_t mismatches = 0, sum;
+	int32_t t_fine;
+
+	bench_sensor(&bme);
+	for (uint32_t i = 0; i < SAMPLES; i++) bench_raw(i, &adc_T[i], &adc_P[i], &adc_H[i]);
+
+	// ----- the same values -----
+	for (uint32_t i = 0; i < SAMPLES; i++)
+	{
+		int32_t t_fine_coef, t_coef = coef_compensate_T(&bme.coef, adc_T[i], &t_fine_coef);
+
+		if ((bme280_compensate_T(&bme.calib, adc_T[i], &t_fine) != t_coef) || (t_fine != t_fine_coef) ||
+			(bme280_compensate_P(&bme.calib, adc_P[i], t_fine) != coef_compensate_P(&bme.coef, adc_P[i], t_fine)) ||
+			(bme280_compensate_H(&bme.calib, adc_H[i], t_fine) != coef_compensate_H(&bme.coef, adc_H[i], t_fine))) mismatches++;
+	}
+	CHECK_EQ(mismatches, 0);
+
+	// ----- T + P + H of one sample -----
+	sum = 0;
+	bench_start(&coef);
+	for (uint32_t r = 0; r < ROUNDS; r++)
+	{
+		for (uint32_t i = 0; i < SAMPLES; i++)
+		{
+			sum += coef_compensate_T(&bme.coef, adc_T[i], &t_fine);
+			sum += coef_compensate_P(&bme.coef, adc_P[i], t_fine);
+			sum += coef_compensate_H(&bme.coef, adc_H[i], t_fine);
+		}
+	}
+	bench_stop(&coef, ROUNDS * SAMPLES);
+	bench_sink = sum;
+
+	sum = 0;
+	bench_start(&prepared);
+	for (uint32_t r = 0; r < ROUNDS; r++)
+	{
+		for (uint32_t i = 0; i < SAMPLES; i++)
+		{
+			sum += bme280_compensate_T(&bme.calib, adc_T[i], &t_fine);
+			sum += bme280_compensate_P(&bme.calib, adc_P[i], t_fine);
+			sum += bme280_compensate_H(&bme.calib, adc_H[i], t_fine);
+		}
+	}
+	bench_stop(&prepared, ROUNDS * SAMPLES);
+	bench_sink = sum;
+
+	printf("calibration terms        [ns/sample] [cycles]\n");
+	printf("%-24s %10.1f %9.1f\n", "in every call (TCOEF)", coef.ns, coef.cycles);
+	printf("%-24s %10.1f %9.1f\n", "prepared (BME280_CALIB)", prepared.ns, prepared.cycles);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,108 @@
+/*
+ * bench_driver.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Whole driver path on simulated sensor (BME280_sim.c connected directly,
+// without bus) and simulated clock: BME280_Conf after reset, then for every
+// sample BME280_Trigger, wait for the longest conversion time, read of data
+// registers by BME280_read_data and BME280_Calculate. Trace of pseudo-random
+// raw samples is replayed, every calculated temperature has to be the one
+// of the sample published by the simulator.
+// Samples/s and latency (trigger -> calculated values) are given in simulated
+// time, which is what the firmware gets with this configuration; host time
+// per sample is the cost of driver and simulator on the workstation.
+#include "test.h"
+#include "bench.h"
+#include "CLOCK/CLOCK.h"
+#include "BME280/BME280_sim.h"
+
+#define TRACE_LEN	256
+#define SAMPLES		20000
+
+static BME280 sensor;
+static BME280_SIM sim;
+static BME280_SIM_SAMPLE trace[TRACE_LEN];
+
+int main(void)
+{
+	static const uint8_t oversampling[] = {BME280_oversampling_x1, BME280_oversampling_x2, BME280_oversampling_x4, BME280_oversampling_x16};
+	BENCH host;
+	uint64_t start_ns, conf_ns, trigger_ns, latency_ns, latency_min, latency_max, latency_sum;
+	uint32_t mismatches, errors;
+	int32_t adc_T, adc_P, adc_H, t_fine, expected;
+	uint16_t index;
+	uint8_t result;
+
+	CLOCK_Conf();
+
+	for (uint16_t i = 0; i < TRACE_LEN; i++)
+	{
+		bench_raw(i, &adc_T, &adc_P, &adc_H);
+		trace[i].adc_T = adc_T;
+		trace[i].adc_P = adc_P;
+		trace[i].adc_H = adc_H;
+	}
+
+	BME280_Sim_Init(&sim, trace, TRACE_LEN, 0);
+	BME280_Init_Sim(&sensor, &sim);
+
+	printf("osrs   conf [us]  samples/s   latency min / mean / max [us]   host [ns]  [cycles]\n");
+
+	for (uint8_t o = 0; o < sizeof(oversampling) / sizeof(oversampling[0]); o++)
+	{
+		// ----- configuration after reset, calibration is read again -----
+		sensor.conf.osrs_t = sensor.conf.osrs_p = sensor.conf.osrs_h = oversampling[o];
+		sensor.reset_done = 0;
+		start_ns = host_now_ns;
+		do
+		{
+			result = BME280_Conf(&sensor);
+			if (result == 3) host_run_for_us(100);
+		}
+		while (result == 3);
+		conf_ns = host_now_ns - start_ns;
+		CHECK_EQ(result, 0);
+		host_run_for_us(BME280_Trigger(&sensor));		// conversion started by configuration
+
+		// ----- trigger -> conversion -> read -> calculation -----
+		mismatches = errors = 0;
+		latency_min = UINT64_MAX;
+		latency_max = latency_sum = 0;
+		start_ns = host_now_ns;
+		bench_start(&host);
+		for (uint32_t i = 0; i < SAMPLES; i++)
+		{
+			trigger_ns = host_now_ns;
+			host_run_for_us(BME280_Trigger(&sensor));
+			BME280_read_data(&sensor, 0xF7, BME280_DATA_SIZE, sensor.raw);
+			if (BME280_Calculate(&sensor)) errors++;
+
+			latency_ns = host_now_ns - trigger_ns;
+			if (latency_ns < latency_min) latency_min = latency_ns;
+			if (latency_ns > latency_max) latency_max = latency_ns;
+			latency_sum += latency_ns;
+
+			index = (sim.trace_index + TRACE_LEN - 1) % TRACE_LEN;
+			expected = bme280_compensate_T(&sensor.calib, (int32_t)trace[index].adc_T, &t_fine);
+			if (sensor.temperature != expected) mismatches++;
+		}
+		bench_stop(&host, SAMPLES);
+
+		printf("x%-4u %10.1f %10.2f %10.1f / %8.1f / %8.1f %11.1f %9.1f\n",
+			   1u << (oversampling[o] - 1), conf_ns / 1000.0, SAMPLES * 1e9 / (double)(host_now_ns - start_ns),
+			   latency_min / 1000.0, latency_sum / 1000.0 / SAMPLES, latency_max / 1000.0, host.ns, host.cycles);
+
+		CHECK_EQ(errors, 0);
+		CHECK_EQ(mismatches, 0);
+		CHECK(latency_min >= (uint64_t)bme280_compute_measure_time_us(typical_time, &sensor.conf) * 1000);
+	}
+
+	printf("driver: %u samples per configuration, %u conversions, %u reads, %u writes of simulator\n",
+		   SAMPLES, sim.conversions, sim.reads, sim.writes);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,96 @@
+/*
+ * bench_filter.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Running-window average (FILTER.c) against the former array-shift average
+// for windows of 10, 64 and 256 samples, and limits of averaging buffers
+// of sensor context (No_OF_SAMPLES_MAX).
+#include "test.h"
+#include "bench.h"
+#include "FILTER/FILTER.h"
+#include "BME280/BME280.h"
+
+#define SAMPLES		200000
+#define WINDOW_MAX	256
+
+static int32_t buffer[WINDOW_MAX], shifted[WINDOW_MAX];
+
+/****************************************************************************/
+/*      former averaging: window is shifted by one and summed again			*/
+/****************************************************************************/
+static int32_t shift_average(int32_t *samples, uint16_t size, uint16_t *count, int32_t sample)
+{
+	int32_t sum = 0;
+	uint16_t k;
+
+	if (*count < size) samples[(*count)++] = sample;
+	else
+	{
+		for (k = 1; k < size; k++) samples[k - 1] = samples[k];
+		samples[size - 1] = sample;
+	}
+
+	for (k = 0; k < *count; k++) sum += samples[k];
+	return sum / *count;
+}
+
+static int32_t sample_value(uint32_t i)
+{
+	return 2500 + (int32_t)((i * 2654435761u) >> 24) - 128;		// temperature with noise
+}
+
+int main(void)
+{
+	static const uint16_t windows[] = {10, 64, 256};
+	static BME280 bme;
+	MOVING_AVG avg;
+	BENCH running, shift;
+	uint16_t count;
+	int32_t a, b;
+
+	// ----- context buffers: window up to No_OF_SAMPLES_MAX, larger one is rejected -----
+	CHECK_EQ(BME280_Set_Average_Window(&bme, No_OF_SAMPLES_MAX, No_OF_SAMPLES_MAX, No_OF_SAMPLES_MAX), 0);
+	CHECK_EQ(bme.avg_temp.size, No_OF_SAMPLES_MAX);
+	CHECK_EQ(BME280_Set_Average_Window(&bme, 10, 256, 10), 1);
+	CHECK_EQ(bme.avg_temp.size, No_OF_SAMPLES_MAX);
+	CHECK_EQ(bme.avg_pressure.size, No_OF_SAMPLES_MAX);
+
+	printf("window   running [ns]  [cycles]   shift [ns]  [cycles]\n");
+
+	for (uint8_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++)
+	{
+		// ----- both averages give the same values -----
+		moving_avg_init(&avg, buffer, windows[w]);
+		count = 0;
+		for (uint32_t i = 0; i < 4 * WINDOW_MAX; i++)
+		{
+			a = moving_avg_update(&avg, sample_value(i));
+			b = shift_average(shifted, windows[w], &count, sample_value(i));
+			if (a != b)
+			{
+				CHECK_EQ(a, b);
+				break;
+			}
+		}
+
+		moving_avg_init(&avg, buffer, windows[w]);
+		bench_start(&running);
+		for (uint32_t i = 0; i < SAMPLES; i++) bench_sink = moving_avg_update(&avg, sample_value(i));
+		bench_stop(&running, SAMPLES);
+
+		count = 0;
+		bench_start(&shift);
+		for (uint32_t i = 0; i < SAMPLES; i++) bench_sink = shift_average(buffer, windows[w], &count, sample_value(i));
+		bench_stop(&shift, SAMPLES);
+
+		printf("%6u %11.1f %9.1f %12.1f %9.1f\n", windows[w], running.ns, running.cycles, shift.ns, shift.cycles);
+
+		if (windows[w] >= 64) CHECK(running.ns < shift.ns);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,203 @@
+/*
+ * bench_format.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Decimal formatting of FORMAT module against itoa (newlib algorithm: one
+// division and remainder by runtime radix per digit, then reversal) and
+// against snprintf:
+//		FORMAT_Int - the same string as "%d" for every value -100000 ..
+//			100000 and limits of int32_t,
+//		FORMAT_Uint - the same string as "%u" for 0 .. 200000 and limits,
+//		FORMAT_Fixed2 - the same string as "[-]%u,%02u" for every value
+//			-20000,00 .. 20000,00 and limits, padding to width,
+// cycles are printed per string, former driver sequence of temperature
+// string (itoa, strlen, comma, itoa of fraction) is timed too.
+#include <stdio.h>
+#include <stdlib.h>
+#include "test.h"
+#include "bench.h"
+#include "FORMAT/FORMAT.h"
+
+#define FIXED2_RANGE	2000000		// x 0,01
+#define ROUNDS			(1 << 21)
+
+static char text[FORMAT_FIXED2_MAX + 8], expected[32];
+
+/****************************************************************************/
+/*      itoa of newlib (libc of arm-none-eabi-gcc)							*/
+/****************************************************************************/
+__attribute__((noinline)) static char *libc_utoa(unsigned value, char *str, int base)
+{
+	const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+	int i = 0, j;
+	char c;
+
+	do
+	{
+		str[i++] = digits[value % base];
+		value /= base;
+	}
+	while (value != 0);
+	str[i] = '\0';
+
+	for (j = 0, i--; j < i; j++, i--)
+	{
+		c = str[j];
+		str[j] = str[i];
+		str[i] = c;
+	}
+	return str;
+}
+
+__attribute__((noinline)) static char *libc_itoa(int value, char *str, int base)
+{
+	if ((base == 10) && (value < 0))
+	{
+		str[0] = '-';
+		libc_utoa(-(unsigned)value, &str[1], base);
+	}
+	else libc_utoa((unsigned)value, str, base);
+	return str;
+}
+
+// former string of temperature in BME280_Calculate()
+__attribute__((noinline)) static uint8_t former_fixed2(char *buf, int32_t value)
+{
+	uint8_t len;
+	int32_t integer = value / 100, fract = value % 100;
+
+	if (fract < 0) fract = -fract;
+	libc_itoa(integer, buf, 10);
+	len = strlen(buf);
+	buf[len++] = ',';
+	if (fract < 10) buf[len++] = '0';
+	libc_itoa(fract, &buf[len], 10);
+	return strlen(buf);
+}
+
+__attribute__((noinline)) static uint8_t format_int(char *buf, int32_t value)
+{
+	return FORMAT_Int(buf, value);
+}
+
+__attribute__((noinline)) static uint8_t format_fixed2(char *buf, int32_t value)
+{
+	return FORMAT_Fixed2(buf, value, 0);
+}
+
+static void fixed2_expected(int32_t value, uint8_t width)
+{
+	uint32_t abs_value = (value < 0) ? -(uint32_t)value : (uint32_t)value;
+	char unpadded[32];
+
+	snprintf(unpadded, sizeof(unpadded), "%s%u,%02u", (value < 0) ? "-" : "", abs_value / 100, abs_value % 100);
+	snprintf(expected, sizeof(expected), "%*s", width, unpadded);
+}
+
+static void print_rate(const char *name, const BENCH *b)
+{
+	printf("%-24s %10.1f %9.1f\n", name, b->ns, b->cycles);
+}
+
+int main(void)
+{
+	static const int32_t limits[] = {INT32_MIN, INT32_MIN + 1, -1000000000, -999999999, 999999999, 1000000000, INT32_MAX};
+	BENCH format, itoa_bench, printf_bench;
+	uint32_t mismatches = 0, sum = 0;
+	uint8_t len;
+
+	// ----- FORMAT_Int: the same as "%d" -----
+	for (int32_t v = -100000; v <= 100000; v++)
+	{
+		len = FORMAT_Int(text, v);
+		snprintf(expected, sizeof(expected), "%d", v);
+		if (strcmp(text, expected) || (len != strlen(expected))) mismatches++;
+	}
+	for (uint8_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++)
+	{
+		len = FORMAT_Int(text, limits[i]);
+		snprintf(expected, sizeof(expected), "%d", limits[i]);
+		if (strcmp(text, expected) || (len != strlen(expected))) mismatches++;
+		libc_itoa(limits[i], text, 10);
+		CHECK(!strcmp(text, expected));
+	}
+	CHECK_EQ(mismatches, 0);
+
+	// ----- FORMAT_Uint: the same as "%u" -----
+	for (uint32_t v = 0; v <= 200000; v++)
+	{
+		len = FORMAT_Uint(text, v);
+		snprintf(expected, sizeof(expected), "%u", v);
+		if (strcmp(text, expected) || (len != strlen(expected))) mismatches++;
+	}
+	for (uint8_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++)
+	{
+		len = FORMAT_Uint(text, (uint32_t)limits[i]);
+		snprintf(expected, sizeof(expected), "%u", (uint32_t)limits[i]);
+		if (strcmp(text, expected) || (len != strlen(expected))) mismatches++;
+	}
+	CHECK_EQ(mismatches, 0);
+
+	// ----- FORMAT_Fixed2: the same as "[-]%u,%02u", padded to width -----
+	for (int32_t v = -FIXED2_RANGE; v <= FIXED2_RANGE; v++)
+	{
+		len = FORMAT_Fixed2(text, v, 0);
+		fixed2_expected(v, 0);
+		if (strcmp(text, expected) || (len != strlen(expected))) mismatches++;
+	}
+	for (uint8_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++)
+	{
+		for (uint8_t width = 0; width <= 8; width += 8)
+		{
+			len = FORMAT_Fixed2(text, limits[i], width);
+			fixed2_expected(limits[i], width);
+			if (strcmp(text, expected) || (len != strlen(expected))) mismatches++;
+		}
+	}
+	for (int32_t v = -4000; v <= 8500; v++)
+	{
+		len = FORMAT_Fixed2(text, v, 7);
+		fixed2_expected(v, 7);
+		if (strcmp(text, expected) || (len != 7)) mismatches++;
+	}
+	CHECK_EQ(mismatches, 0);
+
+	// ----- cycles per string: values of T (x 0,01 degree) and P [Pa] -----
+	printf("formatting               [ns/string] [cycles]\n");
+
+	bench_start(&format);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += format_int(text, 90000 + (i & 0x3FFF));
+	bench_stop(&format, ROUNDS);
+	bench_start(&itoa_bench);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += (uint8_t)*libc_itoa(90000 + (i & 0x3FFF), text, 10);
+	bench_stop(&itoa_bench, ROUNDS);
+	bench_start(&printf_bench);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += snprintf(text, sizeof(text), "%d", 90000 + (i & 0x3FFF));
+	bench_stop(&printf_bench, ROUNDS);
+	print_rate("FORMAT_Int", &format);
+	print_rate("itoa", &itoa_bench);
+	print_rate("snprintf %d", &printf_bench);
+
+	bench_start(&format);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += format_fixed2(text, (int32_t)(i & 0x3FFF) - 4000);
+	bench_stop(&format, ROUNDS);
+	bench_start(&itoa_bench);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += former_fixed2(text, (int32_t)(i & 0x3FFF) - 4000);
+	bench_stop(&itoa_bench, ROUNDS);
+	bench_start(&printf_bench);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += snprintf(text, sizeof(text), "%d,%02d", ((int32_t)(i & 0x3FFF) - 4000) / 100, abs(((int32_t)(i & 0x3FFF) - 4000) % 100));
+	bench_stop(&printf_bench, ROUNDS);
+	print_rate("FORMAT_Fixed2", &format);
+	print_rate("itoa, strlen, comma", &itoa_bench);
+	print_rate("snprintf %d,%02d", &printf_bench);
+
+	bench_sink = sum;
+
+	CHECK(format.cycles < itoa_bench.cycles);
+
+	return TEST_RESULT();
+}
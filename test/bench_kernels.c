@@ -0,0 +1,243 @@
+/*
+ * bench_kernels.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Division-free kernels against Bosch integer reference and former code
+// with divisions:
+//		temperature - bit-exact to Bosch code for every 20-bit adc_T,
+//		humidity - bit-exact for every 16-bit adc_H at 25 temperatures,
+//		udiv100 - equal to division for every uint32_t,
+//		sea level - table against Babinet formula in double precision,
+//			linear interpolation of table gives largest error at high altitude.
+// Former code with signed divisions by powers of two rounds towards zero,
+// the number of its different results is printed. Cycles of every kernel
+// are printed for both variants.
+#include <stdlib.h>
+#include <math.h>
+#include "test.h"
+#include "bench.h"
+#include "COMMON/common_var.h"
+
+#define ADC_RANGE		(1L << 20)
+#define ADC_H_RANGE		(1L << 16)
+#define T_STEPS			25
+#define ROUNDS			(1 << 22)
+#define SEA_ERROR		1e-4		// relative, table against formula (10 Pa of 1000 hPa, datasheet accuracy is 100 Pa)
+
+static BME280 bme;
+static volatile uint32_t divisor = 100;		// division of former split isn't replaced by compiler
+
+/****************************************************************************/
+/*      Bosch reference code (datasheet, chapter 4.2.3)						*/
+/****************************************************************************/
+static int32_t bosch_T(const TCOEF *c, int32_t adc_T, int32_t *t_fine)
+{
+	int32_t var1, var2;
+
+	var1 = ((((adc_T >> 3) - ((int32_t)c->dig_T1 << 1))) * ((int32_t)c->dig_T2)) >> 11;
+	var2 = (((((adc_T >> 4) - ((int32_t)c->dig_T1)) * ((adc_T >> 4) - ((int32_t)c->dig_T1))) >> 12) * ((int32_t)c->dig_T3)) >> 14;
+	*t_fine = var1 + var2;
+	return (*t_fine * 5 + 128) >> 8;
+}
+
+static uint32_t bosch_H(const TCOEF *c, int32_t adc_H, int32_t t_fine)
+{
+	int32_t v_x1_u32r;
+
+	v_x1_u32r = (t_fine - ((int32_t)76800));
+	v_x1_u32r = (((((adc_H << 14) - (((int32_t)c->dig_H4) * 1048576) - (((int32_t)c->dig_H5) * v_x1_u32r)) + ((int32_t)16384)) >> 15) *
+				 (((((((v_x1_u32r * ((int32_t)c->dig_H6)) >> 10) * (((v_x1_u32r * ((int32_t)c->dig_H3)) >> 11) + ((int32_t)32768))) >> 10) +
+				 ((int32_t)2097152)) * ((int32_t)c->dig_H2) + 8192) >> 14));
+	v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) * ((int32_t)c->dig_H1)) >> 4));
+	v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
+	v_x1_u32r = (v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r);
+	return (uint32_t)(v_x1_u32r >> 12);
+}
+
+/****************************************************************************/
+/*      former kernels: signed divisions instead of shifts					*/
+/****************************************************************************/
+__attribute__((noinline)) static int32_t former_T(const BME280_CALIB *cal, int32_t adc_T, int32_t *t_fine)
+{
+	int32_t var1, var2, temperature;
+
+	var1 = (((adc_T / 8) - cal->T1x2) * cal->T2) / 2048;
+	var2 = (adc_T / 16) - cal->T1;
+	var2 = (((var2 * var2) / 4096) * cal->T3) / 16384;
+	*t_fine = var1 + var2;
+	temperature = (*t_fine * 5 + 128) / 256;
+
+	if      (temperature < -4000) temperature = -4000;
+	else if (temperature > 8500)  temperature = 8500;
+	return temperature;
+}
+
+__attribute__((noinline)) static uint32_t former_H(const BME280_CALIB *cal, int32_t adc_H, int32_t t_fine)
+{
+	int32_t var1, var2, var3, var4, var5;
+	uint32_t humidity;
+
+	var1 = t_fine - ((int32_t)76800);
+	var5 = (((adc_H * 16384 - cal->H4x1048576) - cal->H5 * var1) + (int32_t)16384) / 32768;
+	var2 = (var1 * cal->H6) / 1024;
+	var3 = (var1 * cal->H3) / 2048;
+	var4 = ((var2 * (var3 + (int32_t)32768)) / 1024) + (int32_t)2097152;
+	var2 = ((var4 * cal->H2) + 8192) / 16384;
+	var3 = var5 * var2;
+	var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
+	var5 = var3 - ((var4 * cal->H1) / 16);
+	var5 = (var5 < 0 ? 0 : var5);
+	var5 = (var5 > 419430400 ? 419430400 : var5);
+	humidity = (uint32_t)(var5 / 4096);
+	return (humidity > 102400) ? 102400 : humidity;
+}
+
+// former integer Babinet reduction, three runtime divisions (uint16_t overflows,
+// it's timed only at 0 .. 40 degree and 900 .. 1064 hPa where divisors aren't 0)
+__attribute__((noinline)) static uint32_t former_sea_level(int32_t temperature, uint32_t pressure, int32_t altitude)
+{
+	uint16_t st_baryczny, tpm, t_sr;
+	uint32_t p0, p_sr;
+
+	st_baryczny = (800000 * (1000 + 4 * temperature) / (pressure));
+	p0 = pressure + (100000 * altitude / (st_baryczny));
+	p_sr = (pressure + p0) / 2;
+	tpm = temperature + ((6 * altitude) / 1000);
+	t_sr = (temperature + tpm) / 2;
+	st_baryczny = (800000 * (1000 + 4 * t_sr) / (p_sr));
+	return pressure + (100000 * altitude / (st_baryczny));
+}
+
+__attribute__((noinline)) static uint32_t table_sea_level(const uint32_t *table, int32_t temperature, uint32_t pressure)
+{
+	return bme280_sea_level_pressure(table, temperature, pressure);
+}
+
+// Babinet formula in double precision, the same as used for table
+static double babinet(double t, double p, double altitude)
+{
+	double t_m = t + 0.00325 * altitude;
+	double k = altitude / (16000.0 * (1.0 + 0.004 * t_m));
+
+	return p * (1.0 + k) / (1.0 - k);
+}
+
+static void print_pair(const char *name, const BENCH *a, const BENCH *b)
+{
+	printf("%-12s %10.1f %9.1f %12.1f %9.1f\n", name, a->ns, a->cycles, b->ns, b->cycles);
+}
+
+int main(void)
+{
+	static const int32_t altitudes[] = {0, 205, 1000, 2500};
+	static uint32_t table[BME280_SEA_TABLE_SIZE];
+	BENCH kernel, former;
+	int32_t t_fine, t_fine_ref, adc_T_steps[T_STEPS], temperature;
+	uint32_t mismatches = 0, former_differs = 0, split_errors = 0, sum;
+	double ref, error, max_sea;
+
+	bench_sensor(&bme);
+
+	// ----- temperature: every adc_T, in range where driver doesn't clamp -----
+	for (int32_t adc_T = 0; adc_T < ADC_RANGE; adc_T++)
+	{
+		int32_t ref = bosch_T(&bme.coef, adc_T, &t_fine_ref);
+
+		temperature = bme280_compensate_T(&bme.calib, adc_T, &t_fine);
+		if ((t_fine != t_fine_ref) || ((ref >= -4000) && (ref <= 8500) && (temperature != ref))) mismatches++;
+		if (former_T(&bme.calib, adc_T, &t_fine) != temperature) former_differs++;
+	}
+	CHECK_EQ(mismatches, 0);
+	printf("temperature: bit-exact for %ld adc_T, former code differs in %u\n", ADC_RANGE, former_differs);
+
+	// ----- humidity: every adc_H at temperatures -39 .. 81 degree -----
+	for (int32_t adc_T = 0, k = 0; (adc_T < ADC_RANGE) && (k < T_STEPS); adc_T++)
+	{
+		if (bme280_compensate_T(&bme.calib, adc_T, &t_fine) >= -3900 + k * 500) adc_T_steps[k++] = adc_T;
+	}
+	mismatches = former_differs = 0;
+	for (uint8_t k = 0; k < T_STEPS; k++)
+	{
+		bme280_compensate_T(&bme.calib, adc_T_steps[k], &t_fine);
+		for (int32_t adc_H = 0; adc_H < ADC_H_RANGE; adc_H++)
+		{
+			uint32_t humidity = bme280_compensate_H(&bme.calib, adc_H, t_fine);
+
+			if (humidity != bosch_H(&bme.coef, adc_H, t_fine)) mismatches++;
+			if (humidity != former_H(&bme.calib, adc_H, t_fine)) former_differs++;
+		}
+	}
+	CHECK_EQ(mismatches, 0);
+	printf("humidity: bit-exact for %ld adc_H x %u temperatures, former code differs in %u\n", ADC_H_RANGE, T_STEPS, former_differs);
+
+	// ----- udiv100: every uint32_t -----
+	for (uint64_t x = 0; x <= UINT32_MAX; x++)
+	{
+		if (udiv100((uint32_t)x) != (uint32_t)x / 100) split_errors++;
+	}
+	CHECK_EQ(split_errors, 0);
+	printf("udiv100: equal to division for every uint32_t\n");
+
+	// ----- sea level: table against formula, -40 .. 85 degree, 300 .. 1100 hPa -----
+	for (uint8_t a = 0; a < sizeof(altitudes) / sizeof(altitudes[0]); a++)
+	{
+		max_sea = 0;
+		bme280_prepare_sea_level(altitudes[a], table);
+		for (int32_t t = -4000; t <= 8500; t += 7)
+		{
+			for (uint32_t p = 30000; p <= 110000; p += 997)
+			{
+				ref = babinet(t / 100.0, p, altitudes[a]);
+				error = fabs(bme280_sea_level_pressure(table, t, p) - ref) / ref;
+				if (error > max_sea) max_sea = error;
+			}
+		}
+		CHECK(max_sea <= SEA_ERROR);
+		printf("sea level at %4ld m: max difference of table to Babinet formula %.1e (%.2f Pa of 1000 hPa)\n", (long)altitudes[a], max_sea, max_sea * 100000);
+	}
+
+	// ----- cycles -----
+	printf("kernel       shifts [ns]  [cycles]  former [ns]  [cycles]\n");
+
+	sum = 0;
+	bench_start(&kernel);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += bme280_compensate_T(&bme.calib, 440000 + (i & 0x1FFFF), &t_fine);
+	bench_stop(&kernel, ROUNDS);
+	bench_start(&former);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += former_T(&bme.calib, 440000 + (i & 0x1FFFF), &t_fine);
+	bench_stop(&former, ROUNDS);
+	print_pair("temperature", &kernel, &former);
+
+	bench_start(&kernel);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += bme280_compensate_H(&bme.calib, 20000 + (i & 0x3FFF), -60000 + (i & 0x3FFFF));
+	bench_stop(&kernel, ROUNDS);
+	bench_start(&former);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += former_H(&bme.calib, 20000 + (i & 0x3FFF), -60000 + (i & 0x3FFFF));
+	bench_stop(&former, ROUNDS);
+	print_pair("humidity", &kernel, &former);
+
+	bench_start(&kernel);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += udiv100(i * 2654435761u);
+	bench_stop(&kernel, ROUNDS);
+	bench_start(&former);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += (i * 2654435761u) / divisor;
+	bench_stop(&former, ROUNDS);
+	print_pair("split", &kernel, &former);
+
+	bme280_prepare_sea_level(205, table);
+	bench_start(&kernel);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += table_sea_level(table, (i & 0xFFF), 90000 + (i & 0x3FFF));
+	bench_stop(&kernel, ROUNDS);
+	bench_start(&former);
+	for (uint32_t i = 0; i < ROUNDS; i++) sum += former_sea_level((i & 0xFFF), 90000 + (i & 0x3FFF), 205);
+	bench_stop(&former, ROUNDS);
+	print_pair("sea level", &kernel, &former);
+
+	bench_sink = sum;
+
+	return TEST_RESULT();
+}
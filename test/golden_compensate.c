@@ -0,0 +1,237 @@
+/*
+ * golden_compensate.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Golden model of compensation: Bosch reference formulas in double
+// precision (datasheet, chapter 8.1) computed from raw coefficients (TCOEF)
+// against int32, int64 and float back ends using prepared calibration.
+// Calibrations are datasheet example and random variations of it, for each
+// of them every 20-bit adc_T is swept, then every 20-bit adc_P and every
+// 16-bit adc_H at temperatures -39 .. 81 degree. Work items (calibration,
+// temperature) are shared by one thread per CPU core.
+// Max errors to the reference are compared where the sensor works
+// (300 - 1100 hPa, 0 - 100 %), throughput of the sweep is printed.
+// Run by: make -C test golden, number of threads can be given as argument.
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "test.h"
+#include "bench.h"
+
+#define CALIBRATIONS		8
+#define T_STEPS				25
+#define ADC_RANGE			(1L << 20)
+#define ADC_H_RANGE			(1L << 16)
+#define MAX_THREADS			64
+
+// maximum errors to reference
+#define T_INT32_ERROR		0.01		// degree, result is in 0,01 degree
+#define T_FLOAT_ERROR		0.001
+#define P_INT32_ERROR		8.0			// Pa, 32-bit formula
+#define P_INT64_ERROR		1.0
+#define P_FLOAT_ERROR		0.1
+#define H_INT32_ERROR		0.02		// %
+#define H_FLOAT_ERROR		0.001
+
+enum {E_T_INT32, E_T_FLOAT, E_P_INT32, E_P_INT64, E_P_FLOAT, E_H_INT32, E_H_FLOAT, ERRORS};
+static const char *error_names[ERRORS] = {"T int32 [C]", "T float [C]", "P int32 [Pa]", "P int64 [Pa]", "P float [Pa]", "H int32 [%]", "H float [%]"};
+static const double error_limits[ERRORS] = {T_INT32_ERROR, T_FLOAT_ERROR, P_INT32_ERROR, P_INT64_ERROR, P_FLOAT_ERROR, H_INT32_ERROR, H_FLOAT_ERROR};
+
+typedef struct {
+	double max[ERRORS];
+	uint64_t samples;
+} GOLDEN_RESULT;
+
+static BME280 sensors[CALIBRATIONS];
+static int32_t adc_T_steps[CALIBRATIONS][T_STEPS];
+static GOLDEN_RESULT results[MAX_THREADS];
+static volatile uint32_t next_item;
+
+/****************************************************************************/
+/*      Bosch reference formulas in double precision				        */
+/****************************************************************************/
+static double ref_T(const TCOEF *c, int32_t adc_T, int32_t *t_fine)
+{
+	double var1, var2;
+
+	var1 = ((double)adc_T / 16384.0 - (double)c->dig_T1 / 1024.0) * (double)c->dig_T2;
+	var2 = ((double)adc_T / 131072.0 - (double)c->dig_T1 / 8192.0);
+	var2 = var2 * var2 * (double)c->dig_T3;
+	*t_fine = (int32_t)(var1 + var2);
+	return (var1 + var2) / 5120.0;
+}
+
+static double ref_P(const TCOEF *c, int32_t adc_P, int32_t t_fine)
+{
+	double var1, var2, p;
+
+	var1 = (double)t_fine / 2.0 - 64000.0;
+	var2 = var1 * var1 * (double)c->dig_P6 / 32768.0;
+	var2 = var2 + var1 * (double)c->dig_P5 * 2.0;
+	var2 = var2 / 4.0 + (double)c->dig_P4 * 65536.0;
+	var1 = ((double)c->dig_P3 * var1 * var1 / 524288.0 + (double)c->dig_P2 * var1) / 524288.0;
+	var1 = (1.0 + var1 / 32768.0) * (double)c->dig_P1;
+	if (var1 == 0.0) return 0;
+
+	p = 1048576.0 - (double)adc_P;
+	p = (p - var2 / 4096.0) * 6250.0 / var1;
+	var1 = (double)c->dig_P9 * p * p / 2147483648.0;
+	var2 = p * (double)c->dig_P8 / 32768.0;
+	return p + (var1 + var2 + (double)c->dig_P7) / 16.0;
+}
+
+static double ref_H(const TCOEF *c, int32_t adc_H, int32_t t_fine)
+{
+	double var_H;
+
+	var_H = (double)t_fine - 76800.0;
+	var_H = ((double)adc_H - ((double)c->dig_H4 * 64.0 + (double)c->dig_H5 / 16384.0 * var_H)) *
+			((double)c->dig_H2 / 65536.0 * (1.0 + (double)c->dig_H6 / 67108864.0 * var_H * (1.0 + (double)c->dig_H3 / 67108864.0 * var_H)));
+	var_H = var_H * (1.0 - (double)c->dig_H1 * var_H / 524288.0);
+
+	if      (var_H > 100.0) var_H = 100.0;
+	else if (var_H < 0.0)   var_H = 0.0;
+	return var_H;
+}
+
+static inline void update(GOLDEN_RESULT *r, uint8_t e, double error)
+{
+	error = fabs(error);
+	if (error > r->max[e]) r->max[e] = error;
+}
+
+/****************************************************************************/
+/*      calibration n: datasheet example (n = 0) or variation of every		*/
+/*      coefficient by up to +-5 %											*/
+/****************************************************************************/
+static int32_t vary(int32_t value, uint32_t *seed)
+{
+	*seed = *seed * 1103515245u + 12345u;
+	return value + (int32_t)((int64_t)value * ((int32_t)((*seed >> 16) % 1001) - 500) / 10000);
+}
+
+static void prepare_sensor(uint8_t n)
+{
+	BME280 *bme = &sensors[n];
+	TCOEF *c = &bme->coef;
+	uint32_t seed = n;
+	int32_t t_fine;
+
+	bench_sensor(bme);
+	if (n)
+	{
+		c->dig_T1 = vary(c->dig_T1, &seed);	c->dig_T2 = vary(c->dig_T2, &seed);	c->dig_T3 = vary(c->dig_T3, &seed);
+		c->dig_P1 = vary(c->dig_P1, &seed);	c->dig_P2 = vary(c->dig_P2, &seed);	c->dig_P3 = vary(c->dig_P3, &seed);
+		c->dig_P4 = vary(c->dig_P4, &seed);	c->dig_P5 = vary(c->dig_P5, &seed);	c->dig_P6 = vary(c->dig_P6, &seed);
+		c->dig_P7 = vary(c->dig_P7, &seed);	c->dig_P8 = vary(c->dig_P8, &seed);	c->dig_P9 = vary(c->dig_P9, &seed);
+		c->dig_H1 = vary(c->dig_H1, &seed);	c->dig_H2 = vary(c->dig_H2, &seed);	c->dig_H3 = vary(c->dig_H3, &seed);
+		c->dig_H4 = vary(c->dig_H4, &seed);	c->dig_H5 = vary(c->dig_H5, &seed);	c->dig_H6 = vary(c->dig_H6, &seed);
+		bme280_prepare_calibration(c, &bme->calib);
+	}
+
+	// adc_T of temperatures -39 .. 81 degree in steps of 5 degree
+	for (int32_t adc_T = 0, k = 0; (adc_T < ADC_RANGE) && (k < T_STEPS); adc_T++)
+	{
+		if (ref_T(c, adc_T, &t_fine) >= -39.0 + k * 5) adc_T_steps[n][k++] = adc_T;
+	}
+}
+
+/****************************************************************************/
+/*      work item: one calibration and temperature, adc_P and adc_H			*/
+/*      sweeps (item T_STEPS is sweep of adc_T)								*/
+/****************************************************************************/
+static void sweep(GOLDEN_RESULT *r, uint32_t item)
+{
+	const BME280 *bme = &sensors[item / (T_STEPS + 1)];
+	const TCOEF *c = &bme->coef;
+	const BME280_CALIB *cal = &bme->calib;
+	uint32_t k = item % (T_STEPS + 1);
+	int32_t t_fine, t_fine_f, t_fine_ref;
+	double ref;
+
+	if (k == T_STEPS)
+	{
+		for (int32_t adc_T = 0; adc_T < ADC_RANGE; adc_T++)
+		{
+			ref = ref_T(c, adc_T, &t_fine_ref);
+			if ((ref < -40.0) || (ref > 85.0)) continue;		// back ends clamp temperature
+
+			update(r, E_T_INT32, bme280_compensate_T(cal, adc_T, &t_fine) / 100.0 - ref);
+			update(r, E_T_FLOAT, bme280_compensate_T_float(cal, adc_T, &t_fine_f) - ref);
+			r->samples++;
+		}
+		return;
+	}
+
+	ref_T(c, adc_T_steps[item / (T_STEPS + 1)][k], &t_fine_ref);
+	bme280_compensate_T(cal, adc_T_steps[item / (T_STEPS + 1)][k], &t_fine);
+	bme280_compensate_T_float(cal, adc_T_steps[item / (T_STEPS + 1)][k], &t_fine_f);
+
+	for (int32_t adc = 0; adc < ADC_RANGE; adc++)
+	{
+		ref = ref_P(c, adc, t_fine_ref);
+		if ((ref >= 30000.0) && (ref <= 110000.0))
+		{
+			update(r, E_P_INT32, bme280_compensate_P(cal, adc, t_fine) - ref);
+			update(r, E_P_INT64, bme280_compensate_P_int64(cal, adc, t_fine) / 256.0 - ref);
+			update(r, E_P_FLOAT, bme280_compensate_P_float(cal, adc, t_fine_f) - ref);
+			r->samples++;
+		}
+
+		if (adc < ADC_H_RANGE)
+		{
+			ref = ref_H(c, adc, t_fine_ref);
+			update(r, E_H_INT32, bme280_compensate_H(cal, adc, t_fine) / 1024.0 - ref);
+			update(r, E_H_FLOAT, bme280_compensate_H_float(cal, adc, t_fine_f) - ref);
+			r->samples++;
+		}
+	}
+}
+
+static void *worker(void *arg)
+{
+	GOLDEN_RESULT *r = arg;
+	uint32_t item;
+
+	while ((item = __atomic_fetch_add(&next_item, 1, __ATOMIC_RELAXED)) < CALIBRATIONS * (T_STEPS + 1)) sweep(r, item);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	pthread_t threads[MAX_THREADS];
+	GOLDEN_RESULT total = {{0}, 0};
+	long cores = (argc > 1) ? atol(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+	uint32_t count = (cores < 1) ? 1 : (cores > MAX_THREADS) ? MAX_THREADS : cores;
+	BENCH bench;
+
+	for (uint8_t n = 0; n < CALIBRATIONS; n++) prepare_sensor(n);
+
+	bench_start(&bench);
+	for (uint32_t t = 0; t < count; t++) CHECK_EQ(pthread_create(&threads[t], 0, worker, &results[t]), 0);
+	for (uint32_t t = 0; t < count; t++)
+	{
+		pthread_join(threads[t], 0);
+		for (uint8_t e = 0; e < ERRORS; e++)
+		{
+			if (results[t].max[e] > total.max[e]) total.max[e] = results[t].max[e];
+		}
+		total.samples += results[t].samples;
+	}
+	bench_stop(&bench, 1);
+
+	printf("golden: %u calibrations, %u threads, %llu samples in %.2f s, %.1f M samples/s\n",
+		   CALIBRATIONS, count, (unsigned long long)total.samples, bench.ns / 1e9, total.samples / (bench.ns / 1e3));
+	for (uint8_t e = 0; e < ERRORS; e++)
+	{
+		printf("  max error %-14s %10.4f (limit %g)\n", error_names[e], total.max[e], error_limits[e]);
+		CHECK(total.max[e] <= error_limits[e]);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,111 @@
+/*
+ * bench.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef HOST_BENCH_H_
+#define HOST_BENCH_H_
+
+#include <stdint.h>
+#include <time.h>
+#include "BME280/BME280_compensate.h"
+
+// --------------------------------------------------------- //
+// host benchmarks: wall time by CLOCK_MONOTONIC (ns), CPU cycles by time
+// stamp counter on x86 (0 on other hosts), so they don't depend on
+// PROFILE_ENABLE. Numbers show ratios between
+// variants measured in one run, not cycles of Cortex-M3.
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t bench_cycles(void)
+{
+	return __builtin_ia32_rdtsc();			// x86intrin.h collides with __I of CMSIS
+}
+#else
+static inline uint64_t bench_cycles(void)
+{
+	return 0;
+}
+#endif
+
+static inline uint64_t bench_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+typedef struct {
+	uint64_t start_ns;
+	uint64_t start_cycles;
+	double ns;				// per operation
+	double cycles;			// per operation
+} BENCH;
+
+static inline void bench_start(BENCH *b)
+{
+	b->start_ns = bench_ns();
+	b->start_cycles = bench_cycles();
+}
+
+static inline void bench_stop(BENCH *b, uint32_t operations)
+{
+	uint64_t cycles = bench_cycles() - b->start_cycles;
+	uint64_t ns = bench_ns() - b->start_ns;
+
+	b->ns = (double)ns / operations;
+	b->cycles = (double)cycles / operations;
+}
+
+// keeps result of benchmarked code alive
+static volatile int32_t bench_sink;
+
+/****************************************************************************/
+/*      sensor context without bus: calibration of datasheet example		*/
+/*      (humidity of typical sensor), prepared as after BME280_Conf()		*/
+/****************************************************************************/
+static inline void bench_sensor(BME280 *bme)
+{
+	BME280_Init_Transport(bme, 0, 0);
+
+	bme->coef.dig_T1 = 27504;	bme->coef.dig_T2 = 26435;	bme->coef.dig_T3 = -1000;
+	bme->coef.dig_P1 = 36477;	bme->coef.dig_P2 = -10685;	bme->coef.dig_P3 = 3024;
+	bme->coef.dig_P4 = 2855;	bme->coef.dig_P5 = 140;		bme->coef.dig_P6 = -7;
+	bme->coef.dig_P7 = 15500;	bme->coef.dig_P8 = -14600;	bme->coef.dig_P9 = 6000;
+	bme->coef.dig_H1 = 75;		bme->coef.dig_H2 = 370;		bme->coef.dig_H3 = 0;
+	bme->coef.dig_H4 = 313;		bme->coef.dig_H5 = 50;		bme->coef.dig_H6 = 30;
+
+	bme280_prepare_calibration(&bme->coef, &bme->calib);
+}
+
+/****************************************************************************/
+/*      raw sample i of pseudo-random sequence around datasheet example,	*/
+/*      temperature about 0 .. 50 degree									*/
+/****************************************************************************/
+static inline void bench_raw(uint32_t i, int32_t *adc_T, int32_t *adc_P, int32_t *adc_H)
+{
+	uint32_t x = i * 2654435761u;
+
+	*adc_T = 440000 + (int32_t)(x % 160000);
+	*adc_P = 250000 + (int32_t)((x >> 8) % 200000);
+	*adc_H = 20000 + (int32_t)((x >> 16) % 12000);
+}
+
+/****************************************************************************/
+/*      raw values to data registers 0xF7 - 0xFE (as read from sensor)		*/
+/****************************************************************************/
+static inline void bench_pack_raw(int32_t adc_T, int32_t adc_P, int32_t adc_H, uint8_t *regs)
+{
+	regs[0] = adc_P >> 12;
+	regs[1] = adc_P >> 4;
+	regs[2] = (adc_P & 0x0F) << 4;
+	regs[3] = adc_T >> 12;
+	regs[4] = adc_T >> 4;
+	regs[5] = (adc_T & 0x0F) << 4;
+	regs[6] = adc_H >> 8;
+	regs[7] = adc_H;
+}
+
+#endif /* HOST_BENCH_H_ */
@@ -0,0 +1,341 @@
+/*
+ * host.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// instances of peripherals and core registers
+#undef HOST_PERIPH
+#define HOST_PERIPH(name, type)		type host_##name;
+HOST_PERIPHERALS
+
+uint64_t host_now_ns;
+uint8_t host_nvic_priority[HOST_NVIC_IRQS];
+void (*host_gpio_hook)(GPIO_TypeDef *port, uint16_t pins, uint8_t level);
+
+#define HOST_PENDING	16
+
+typedef struct {
+	uint64_t time;
+	void (*callback)(void);
+} HOST_EVENT;
+
+static HOST_EVENT events[HOST_EVENTS];			// callback 0 -> free entry
+static void (*pending[HOST_PENDING])(void);		// raised interrupts in order
+static uint8_t pending_count;
+static uint32_t primask;
+static uint8_t in_isr;
+static uint32_t irq_count;						// handlers run, WFI returns after any of them
+
+static void host_irq_flush(void);
+
+
+/****************************************************************************/
+/*      PRIMASK: defined as functions in core_cm3.c of the device			*/
+/****************************************************************************/
+uint32_t __get_PRIMASK(void)
+{
+	host_advance_ns(HOST_CPU_NS);
+	return primask;
+}
+
+void __set_PRIMASK(uint32_t value)
+{
+	primask = value & 1;
+	if (!primask) host_irq_flush();
+}
+
+void host_disable_irq(void)
+{
+	primask = 1;
+}
+
+void host_enable_irq(void)
+{
+	primask = 0;
+	host_irq_flush();
+}
+
+uint8_t host_in_isr(void)
+{
+	return in_isr;
+}
+
+/****************************************************************************/
+/*      raise interrupt: the same handler is pending only once				*/
+/****************************************************************************/
+void host_irq(void (*handler)(void))
+{
+	uint8_t i;
+
+	if (!handler) return;
+
+	for (i = 0; i < pending_count; i++)
+		if (pending[i] == handler) break;
+
+	if (i == pending_count)
+	{
+		if (pending_count == HOST_PENDING)
+		{
+			fprintf(stderr, "host: too many pending interrupts\n");
+			exit(2);
+		}
+		pending[pending_count++] = handler;
+	}
+
+	host_irq_flush();
+}
+
+/****************************************************************************/
+/*      run pending handlers, handlers don't preempt each other				*/
+/****************************************************************************/
+static void host_irq_flush(void)
+{
+	void (*handler)(void);
+
+	while (!primask && !in_isr && pending_count)
+	{
+		handler = pending[0];
+		memmove(&pending[0], &pending[1], (pending_count - 1) * sizeof(pending[0]));
+		pending_count--;
+
+		in_isr = 1;
+		irq_count++;
+		SCB->ICSR |= 1;					// VECTACTIVE: handler mode
+		handler();
+		SCB->ICSR &= ~SCB_ICSR_VECTACTIVE_Msk;
+		in_isr = 0;
+	}
+}
+
+/****************************************************************************/
+/*      WFI: with pending interrupt it returns at once, otherwise time		*/
+/*      jumps to events up to one of them raises interrupt					*/
+/****************************************************************************/
+void host_wfi(void)
+{
+	uint64_t time = 0;
+	uint32_t count = irq_count;
+
+	while (!pending_count && (irq_count == count))
+	{
+		if (!host_event_next(&time))
+		{
+			fprintf(stderr, "host: WFI without any wake-up source\n");
+			exit(2);
+		}
+		host_run_until(time);
+	}
+}
+
+void host_nvic_enable(IRQn_Type irq)
+{
+	(void)irq;
+}
+
+/****************************************************************************/
+/*      events of simulated time											*/
+/****************************************************************************/
+int host_event_at(uint64_t time_ns, void (*callback)(void))
+{
+	for (int i = 0; i < HOST_EVENTS; i++)
+	{
+		if (events[i].callback) continue;
+
+		events[i].time = time_ns;
+		events[i].callback = callback;
+		return i;
+	}
+
+	fprintf(stderr, "host: too many events\n");
+	exit(2);
+}
+
+void host_event_cancel(int id)
+{
+	if ((id >= 0) && (id < HOST_EVENTS)) events[id].callback = 0;
+}
+
+uint8_t host_event_next(uint64_t *time_ns)
+{
+	uint8_t found = 0;
+
+	for (uint8_t i = 0; i < HOST_EVENTS; i++)
+	{
+		if (!events[i].callback) continue;
+		if (!found || events[i].time < *time_ns) *time_ns = events[i].time;
+		found = 1;
+	}
+	return found;
+}
+
+void host_run_until(uint64_t time_ns)
+{
+	uint64_t next = 0;
+	void (*callback)(void);
+
+	while (host_event_next(&next) && (next <= time_ns))
+	{
+		for (uint8_t i = 0; i < HOST_EVENTS; i++)
+		{
+			if (!events[i].callback || events[i].time != next) continue;
+
+			callback = events[i].callback;
+			events[i].callback = 0;
+
+			if (next > host_now_ns)
+			{
+				host_now_ns = next;
+				if (host_time_changed) host_time_changed();
+			}
+			callback();
+			break;
+		}
+	}
+
+	if (time_ns > host_now_ns)
+	{
+		host_now_ns = time_ns;
+		if (host_time_changed) host_time_changed();
+	}
+}
+
+void host_run_for_us(uint64_t time_us)
+{
+	host_run_until(host_now_ns + time_us * 1000);
+}
+
+void host_advance_ns(uint64_t ns)
+{
+	host_run_until(host_now_ns + ns);
+}
+
+void host_reset(void)
+{
+	memset(events, 0, sizeof(events));
+	pending_count = 0;
+	primask = 0;
+	in_isr = 0;
+	host_now_ns = 0;
+}
+
+/****************************************************************************/
+/*      itoa of newlib: digits by division, then reversed					*/
+/****************************************************************************/
+char *itoa(int value, char *str, int base)
+{
+	unsigned uvalue = ((base == 10) && (value < 0)) ? -(unsigned)value : (unsigned)value;
+	char *p = str, *q, c;
+
+	if ((base < 2) || (base > 36))
+	{
+		str[0] = '\0';
+		return 0;
+	}
+	if ((base == 10) && (value < 0)) *p++ = '-';
+
+	q = p;
+	do
+	{
+		*q++ = "0123456789abcdefghijklmnopqrstuvwxyz"[uvalue % base];
+		uvalue /= base;
+	}
+	while (uvalue);
+	*q-- = '\0';
+
+	while (p < q)
+	{
+		c = *p;
+		*p++ = *q;
+		*q-- = c;
+	}
+	return str;
+}
+
+/****************************************************************************/
+/*      RCC, NVIC and GPIO: only output state of pins is modelled			*/
+/****************************************************************************/
+void RCC_AHBPeriphClockCmd(uint32_t periph, FunctionalState state)
+{
+	(void)periph; (void)state;
+}
+
+void RCC_APB1PeriphClockCmd(uint32_t periph, FunctionalState state)
+{
+	(void)periph; (void)state;
+}
+
+void RCC_APB2PeriphClockCmd(uint32_t periph, FunctionalState state)
+{
+	(void)periph; (void)state;
+}
+
+/****************************************************************************/
+/*      NVIC: priority is encoded by group in AIRCR as StdPeriph does it;	*/
+/*      with reset value of AIRCR the shift is out of range and Cortex-M3	*/
+/*      gives priority 0														*/
+/****************************************************************************/
+void NVIC_PriorityGroupConfig(uint32_t group)
+{
+	SCB->AIRCR = 0x05FA0000 | group;
+}
+
+void NVIC_Init(NVIC_InitTypeDef *init)
+{
+	uint32_t group_bits, pre_shift, sub_mask, priority;
+
+	if (init->NVIC_IRQChannelCmd == DISABLE) return;
+
+	group_bits	= (0x700 - (SCB->AIRCR & 0x700)) >> 8;
+	pre_shift	= 4 - group_bits;
+	sub_mask	= 0x0F >> group_bits;
+
+	priority = (pre_shift < 32) ? (uint32_t)init->NVIC_IRQChannelPreemptionPriority << pre_shift : 0;
+	priority |= init->NVIC_IRQChannelSubPriority & sub_mask;
+	host_nvic_priority[init->NVIC_IRQChannel] = (uint8_t)(priority << 4);
+}
+
+void GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init)
+{
+	(void)port; (void)init;
+}
+
+void GPIO_StructInit(GPIO_InitTypeDef *init)
+{
+	init->GPIO_Pin = GPIO_Pin_All;
+	init->GPIO_Speed = GPIO_Speed_2MHz;
+	init->GPIO_Mode = GPIO_Mode_IN_FLOATING;
+}
+
+void GPIO_SetBits(GPIO_TypeDef *port, uint16_t pins)
+{
+	port->ODR |= pins;
+	if (host_gpio_hook) host_gpio_hook(port, pins, 1);
+}
+
+void GPIO_ResetBits(GPIO_TypeDef *port, uint16_t pins)
+{
+	port->ODR &= ~pins;
+	if (host_gpio_hook) host_gpio_hook(port, pins, 0);
+}
+
+void GPIO_WriteBit(GPIO_TypeDef *port, uint16_t pin, BitAction value)
+{
+	if (value != Bit_RESET) GPIO_SetBits(port, pin);
+	else GPIO_ResetBits(port, pin);
+}
+
+uint8_t GPIO_ReadOutputDataBit(GPIO_TypeDef *port, uint16_t pin)
+{
+	return (port->ODR & pin) ? Bit_SET : Bit_RESET;
+}
+
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef *port, uint16_t pin)
+{
+	return (port->IDR & pin) ? Bit_SET : Bit_RESET;
+}
@@ -0,0 +1,161 @@
+/*
+ * host.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef HOST_HOST_H_
+#define HOST_HOST_H_
+
+// --------------------------------------------------------- //
+// Host build of driver modules: this header is force-included (-include)
+// before every source file. Device headers are used as they are, only
+// peripheral and core pointers are redirected to structures in host memory,
+// which are served by models (host_*.c), and core intrinsics are replaced
+// by the model of PRIMASK, pending interrupts and simulated time.
+#include "stm32f10x.h"
+#include <stdint.h>
+
+#define HOST_PERIPH(name, type)		extern type host_##name;
+#define HOST_PERIPHERALS \
+	HOST_PERIPH(SPI1, SPI_TypeDef) \
+	HOST_PERIPH(I2C1, I2C_TypeDef) \
+	HOST_PERIPH(USART1, USART_TypeDef) \
+	HOST_PERIPH(DMA1, DMA_TypeDef) \
+	HOST_PERIPH(DMA1_Channel1, DMA_Channel_TypeDef) \
+	HOST_PERIPH(DMA1_Channel2, DMA_Channel_TypeDef) \
+	HOST_PERIPH(DMA1_Channel3, DMA_Channel_TypeDef) \
+	HOST_PERIPH(DMA1_Channel4, DMA_Channel_TypeDef) \
+	HOST_PERIPH(DMA1_Channel5, DMA_Channel_TypeDef) \
+	HOST_PERIPH(DMA1_Channel6, DMA_Channel_TypeDef) \
+	HOST_PERIPH(DMA1_Channel7, DMA_Channel_TypeDef) \
+	HOST_PERIPH(TIM2, TIM_TypeDef) \
+	HOST_PERIPH(TIM3, TIM_TypeDef) \
+	HOST_PERIPH(GPIOA, GPIO_TypeDef) \
+	HOST_PERIPH(GPIOB, GPIO_TypeDef) \
+	HOST_PERIPH(GPIOC, GPIO_TypeDef) \
+	HOST_PERIPH(RTC, RTC_TypeDef) \
+	HOST_PERIPH(PWR, PWR_TypeDef) \
+	HOST_PERIPH(EXTI, EXTI_TypeDef) \
+	HOST_PERIPH(SysTick, SysTick_Type) \
+	HOST_PERIPH(SCB, SCB_Type) \
+	HOST_PERIPH(CoreDebug, CoreDebug_Type)
+
+HOST_PERIPHERALS
+
+#undef SPI1
+#undef I2C1
+#undef USART1
+#undef DMA1
+#undef DMA1_Channel1
+#undef DMA1_Channel2
+#undef DMA1_Channel3
+#undef DMA1_Channel4
+#undef DMA1_Channel5
+#undef DMA1_Channel6
+#undef DMA1_Channel7
+#undef TIM2
+#undef TIM3
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef RTC
+#undef PWR
+#undef EXTI
+#undef SysTick
+#undef SCB
+#undef CoreDebug
+
+#define SPI1			(&host_SPI1)
+#define I2C1			(&host_I2C1)
+#define USART1			(&host_USART1)
+#define DMA1			(&host_DMA1)
+#define DMA1_Channel1	(&host_DMA1_Channel1)
+#define DMA1_Channel2	(&host_DMA1_Channel2)
+#define DMA1_Channel3	(&host_DMA1_Channel3)
+#define DMA1_Channel4	(&host_DMA1_Channel4)
+#define DMA1_Channel5	(&host_DMA1_Channel5)
+#define DMA1_Channel6	(&host_DMA1_Channel6)
+#define DMA1_Channel7	(&host_DMA1_Channel7)
+#define TIM2			(&host_TIM2)
+#define TIM3			(&host_TIM3)
+#define GPIOA			(&host_GPIOA)
+#define GPIOB			(&host_GPIOB)
+#define GPIOC			(&host_GPIOC)
+#define RTC				(&host_RTC)
+#define PWR				(&host_PWR)
+#define EXTI			(&host_EXTI)
+#define SysTick			(&host_SysTick)
+#define SCB				(&host_SCB)
+#define CoreDebug		(&host_CoreDebug)
+
+// --------------------------------------------------------- //
+// core: PRIMASK, interrupts and sleep
+void host_disable_irq(void);
+void host_enable_irq(void);
+void host_wfi(void);
+void host_nvic_enable(IRQn_Type irq);
+
+#define __disable_irq()			host_disable_irq()
+#define __enable_irq()			host_enable_irq()
+#define __WFI()					host_wfi()
+#define NVIC_EnableIRQ(irq)		host_nvic_enable(irq)
+
+// priority registers written by NVIC_Init(), index is IRQn
+#define HOST_NVIC_IRQS			68
+extern uint8_t host_nvic_priority[HOST_NVIC_IRQS];
+
+// handlers are ordinary functions called by models, the attribute of
+// Cortex-M interrupt handler doesn't exist on host
+#define interrupt				used
+
+// --------------------------------------------------------- //
+// model of interrupt controller: handler is called at once if PRIMASK is
+// clear and no handler is running, otherwise it is pending up to
+// __enable_irq() / __set_PRIMASK(0) or end of running handler
+void host_irq(void (*handler)(void));
+uint8_t host_in_isr(void);
+
+// __get_PRIMASK() takes CPU time: drivers read it in every busy-wait loop
+// (critical sections), so models go on while CPU waits for them
+#define HOST_CPU_NS		100
+
+// --------------------------------------------------------- //
+// simulated time: only models move it forward (bus transfers, timers,
+// sleep), so tests are deterministic and independent of host speed.
+// Event is a change of hardware at given time (e.g. timer overflow), its
+// callback sets flags and raises interrupt by host_irq().
+extern uint64_t host_now_ns;
+
+#define HOST_EVENTS		16
+
+int host_event_at(uint64_t time_ns, void (*callback)(void));	// return id of event
+void host_event_cancel(int id);
+uint8_t host_event_next(uint64_t *time_ns);						// 1 if an event is scheduled, time of the nearest
+void host_run_until(uint64_t time_ns);							// execute events up to time_ns, then time is time_ns
+void host_run_for_us(uint64_t time_us);
+void host_advance_ns(uint64_t ns);								// time spent by CPU or bus
+void host_reset(void);											// clear events, pending interrupts and time
+void host_time_changed(void) __attribute__((weak));				// models of counters follow time (host_tim.c)
+
+// --------------------------------------------------------- //
+// itoa() of newlib (libc of the target) doesn't exist in glibc
+char *itoa(int value, char *str, int base);
+
+// --------------------------------------------------------- //
+// GPIO outputs are reported to models (e.g. chip select of SPI slave)
+extern void (*host_gpio_hook)(GPIO_TypeDef *port, uint16_t pins, uint8_t level);
+
+// --------------------------------------------------------- //
+// DMA: models are told when channel is enabled, channel end raises its interrupt
+extern void (*host_dma_hook[8])(DMA_Channel_TypeDef *channel);		// index is number of channel
+uint8_t host_dma_number(DMA_Channel_TypeDef *channel);
+void host_dma_complete(DMA_Channel_TypeDef *channel, uint8_t half);	// set flags (half -> HT only) and raise interrupt if enabled
+
+static inline uint8_t *host_ptr(uint32_t address)					// memory address programmed to DMA (build is -no-pie)
+{
+	return (uint8_t *)(uintptr_t)address;
+}
+
+#endif /* HOST_HOST_H_ */
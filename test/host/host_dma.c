@@ -0,0 +1,145 @@
+/*
+ * host_dma.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include <string.h>
+
+// --------------------------------------------------------- //
+// DMA1: registers of channels are kept as written by the driver, the data
+// are moved by models of peripherals (host_spi.c, host_usart.c), which are
+// told by host_dma_hook when channel is enabled. Flags in ISR are 4 bits
+// per channel (GIF, TCIF, HTIF, TEIF) as in hardware.
+void (*host_dma_hook[8])(DMA_Channel_TypeDef *channel);
+
+void DMA1_Channel1_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel2_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel3_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel4_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel5_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel6_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel7_IRQHandler(void) __attribute__((weak));
+
+static void (*const handlers[8])(void) = {
+	0,
+	DMA1_Channel1_IRQHandler, DMA1_Channel2_IRQHandler, DMA1_Channel3_IRQHandler, DMA1_Channel4_IRQHandler,
+	DMA1_Channel5_IRQHandler, DMA1_Channel6_IRQHandler, DMA1_Channel7_IRQHandler,
+};
+
+
+uint8_t host_dma_number(DMA_Channel_TypeDef *channel)
+{
+	if (channel == DMA1_Channel1) return 1;
+	if (channel == DMA1_Channel2) return 2;
+	if (channel == DMA1_Channel3) return 3;
+	if (channel == DMA1_Channel4) return 4;
+	if (channel == DMA1_Channel5) return 5;
+	if (channel == DMA1_Channel6) return 6;
+	if (channel == DMA1_Channel7) return 7;
+	return 0;
+}
+
+/****************************************************************************/
+/*      end of block (or half of it), interrupt if it is enabled in CCR		*/
+/****************************************************************************/
+void host_dma_complete(DMA_Channel_TypeDef *channel, uint8_t half)
+{
+	uint8_t n = host_dma_number(channel);
+	uint32_t flags = half ? DMA_IT_HT : (DMA_IT_TC | DMA_IT_HT);
+	uint32_t shift = 4 * (n - 1);
+
+	DMA1->ISR |= (flags | 1) << shift;
+	if (channel->CCR & flags) host_irq(handlers[n]);
+}
+
+/****************************************************************************/
+/*      clear flags: global flag of channel clears all its flags			*/
+/****************************************************************************/
+static void dma_clear(uint32_t flags)
+{
+	flags &= 0x0FFFFFFF;
+
+	for (uint8_t n = 0; n < 7; n++)
+		if (flags & (1UL << (4 * n))) flags |= 0xFUL << (4 * n);
+
+	DMA1->ISR &= ~flags;
+}
+
+/****************************************************************************/
+/*      functions of StdPeriph driver used by SPI and UART					*/
+/****************************************************************************/
+void DMA_DeInit(DMA_Channel_TypeDef *channel)
+{
+	channel->CCR = 0;
+	channel->CNDTR = 0;
+	channel->CPAR = 0;
+	channel->CMAR = 0;
+	dma_clear(1UL << (4 * (host_dma_number(channel) - 1)));
+}
+
+void DMA_StructInit(DMA_InitTypeDef *init)
+{
+	memset(init, 0, sizeof(*init));
+}
+
+void DMA_Init(DMA_Channel_TypeDef *channel, DMA_InitTypeDef *init)
+{
+	channel->CCR = (channel->CCR & DMA_CCR1_EN) | init->DMA_DIR | init->DMA_Mode | init->DMA_PeripheralInc |
+				   init->DMA_MemoryInc | init->DMA_PeripheralDataSize | init->DMA_MemoryDataSize |
+				   init->DMA_Priority | init->DMA_M2M;
+	channel->CNDTR = init->DMA_BufferSize;
+	channel->CPAR = init->DMA_PeripheralBaseAddr;
+	channel->CMAR = init->DMA_MemoryBaseAddr;
+}
+
+void DMA_Cmd(DMA_Channel_TypeDef *channel, FunctionalState state)
+{
+	uint8_t n = host_dma_number(channel);
+
+	if (state == DISABLE)
+	{
+		channel->CCR &= ~DMA_CCR1_EN;
+		return;
+	}
+
+	channel->CCR |= DMA_CCR1_EN;
+	if (host_dma_hook[n]) host_dma_hook[n](channel);
+}
+
+void DMA_ITConfig(DMA_Channel_TypeDef *channel, uint32_t it, FunctionalState state)
+{
+	if (state != DISABLE) channel->CCR |= it;
+	else channel->CCR &= ~it;
+}
+
+void DMA_SetCurrDataCounter(DMA_Channel_TypeDef *channel, uint16_t count)
+{
+	channel->CNDTR = count;
+}
+
+uint16_t DMA_GetCurrDataCounter(DMA_Channel_TypeDef *channel)
+{
+	return (uint16_t)channel->CNDTR;
+}
+
+FlagStatus DMA_GetFlagStatus(uint32_t flag)
+{
+	return (DMA1->ISR & flag & 0x0FFFFFFF) ? SET : RESET;
+}
+
+void DMA_ClearFlag(uint32_t flags)
+{
+	dma_clear(flags);
+}
+
+ITStatus DMA_GetITStatus(uint32_t it)
+{
+	return (DMA1->ISR & it & 0x0FFFFFFF) ? SET : RESET;
+}
+
+void DMA_ClearITPendingBit(uint32_t it)
+{
+	dma_clear(it);
+}
@@ -0,0 +1,434 @@
+/*
+ * host_i2c.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "host_i2c.h"
+
+// --------------------------------------------------------- //
+// I2C1 master and one BME280 slave. Every bus phase (START, address,
+// byte) is an event 1 or 9 bit times later, which sets flags of SR1/SR2
+// and raises event or error interrupt as enabled in CR2 (TXE and RXNE
+// only with ITBUFEN). ADDR is cleared by reading SR1 and SR2 in hardware,
+// plain reads can't be seen here, so it is cleared by the next driver
+// call. Slave protocol of the sensor: after address for write the first
+// byte is register, then (value, register) pairs; read continues from
+// the last register with auto-increment.
+#define BUS_IDLE		0
+#define BUS_START		1		// START is being generated
+#define BUS_ADDRESS		2		// address is being sent
+#define BUS_ADDRESSED	3		// ADDR is set, waiting for driver
+#define BUS_TX			4
+#define BUS_RX			5
+#define BUS_HELD		6		// SDA is held low by slave
+
+#define SLAVE_READ_SIZE		64
+
+static struct {
+	uint8_t phase;
+	uint8_t address;			// address byte sent by master
+	uint32_t bit_ns;			// SCL period
+	int event;
+	uint8_t fault;
+
+	// master transmitter
+	uint8_t shift_busy;
+	uint8_t tx_full;			// next byte is waiting in DR
+
+	// master receiver
+	uint8_t rx_stalled;			// byte is ready, but DR wasn't read yet
+	uint8_t stop_pending;
+
+	// slave
+	BME280_SIM *sim;
+	BME280 ctx;					// transport context for simulator
+	uint8_t SLA;
+	uint8_t reg;
+	uint8_t expect_reg;
+	BME280_REG writes[2 * BME280_MAX_REG_WRITE];
+	uint8_t write_count;
+	uint8_t read_buf[SLAVE_READ_SIZE];
+	uint8_t read_index;
+	uint8_t scl_pulses;			// SCL pulses while SDA is held
+} bus;
+
+HOST_I2C_STATS host_i2c_stats;
+
+void I2C1_EV_IRQHandler(void) __attribute__((weak));
+void I2C1_ER_IRQHandler(void) __attribute__((weak));
+
+static void bus_start_done(void);
+static void bus_address_done(void);
+static void bus_tx_done(void);
+static void bus_rx_done(void);
+
+
+/****************************************************************************/
+/*      interrupts follow level of flags as in hardware						*/
+/****************************************************************************/
+static void bus_irq(void)
+{
+	uint16_t sr1 = I2C1->SR1, cr2 = I2C1->CR2;
+
+	if ((cr2 & I2C_CR2_ITERREN) && (sr1 & (I2C_SR1_AF | I2C_SR1_ARLO | I2C_SR1_BERR | I2C_SR1_OVR)))
+		host_irq(I2C1_ER_IRQHandler);
+
+	if ((cr2 & I2C_CR2_ITEVTEN) &&
+		((sr1 & (I2C_SR1_SB | I2C_SR1_ADDR | I2C_SR1_BTF)) || ((cr2 & I2C_CR2_ITBUFEN) && (sr1 & (I2C_SR1_TXE | I2C_SR1_RXNE)))))
+		host_irq(I2C1_EV_IRQHandler);
+}
+
+static void bus_schedule(uint32_t bits, void (*callback)(void))
+{
+	host_event_cancel(bus.event);
+	bus.event = host_event_at(host_now_ns + bits * bus.bit_ns, callback);
+}
+
+/****************************************************************************/
+/*      STOP: writes collected by slave are applied							*/
+/****************************************************************************/
+static void bus_stop(void)
+{
+	if (bus.write_count) bme280_sim_transport.write(&bus.ctx, bus.writes, bus.write_count);
+	bus.write_count = 0;
+
+	host_event_cancel(bus.event);
+	bus.event = -1;
+	bus.phase = BUS_IDLE;
+	bus.shift_busy = bus.tx_full = bus.rx_stalled = bus.stop_pending = 0;
+	I2C1->SR1 &= ~(I2C_SR1_TXE | I2C_SR1_BTF);			// last received byte stays in DR
+	I2C1->SR2 &= ~(I2C_SR2_MSL | I2C_SR2_BUSY | I2C_SR2_TRA);
+	host_i2c_stats.stops++;
+}
+
+/****************************************************************************/
+/*      ADDR is cleared by the first driver call after it was set			*/
+/****************************************************************************/
+static void bus_clear_addr(void)
+{
+	if (!(I2C1->SR1 & I2C_SR1_ADDR)) return;
+
+	I2C1->SR1 &= ~I2C_SR1_ADDR;
+
+	if (bus.address & 1)
+	{
+		bus.phase = BUS_RX;
+		bus_schedule(9, bus_rx_done);
+	}
+	else
+	{
+		bus.phase = BUS_TX;
+		I2C1->SR1 |= I2C_SR1_TXE;
+	}
+}
+
+static void bus_start_done(void)
+{
+	bus.event = -1;
+
+	if (bus.fault == HOST_I2C_ARBITRATION)
+	{
+		bus.fault = 0;
+		bus.phase = BUS_IDLE;
+		I2C1->SR1 |= I2C_SR1_ARLO;
+		I2C1->SR2 &= ~I2C_SR2_MSL;			// master becomes slave
+		host_i2c_stats.arbitration++;
+	}
+	else
+	{
+		I2C1->SR1 |= I2C_SR1_SB;
+		I2C1->SR2 |= I2C_SR2_MSL | I2C_SR2_BUSY;
+	}
+	bus_irq();
+}
+
+static void bus_address_done(void)
+{
+	bus.event = -1;
+
+	if (((bus.address & 0xFE) != bus.SLA) || (bus.fault == HOST_I2C_NACK_ADDRESS))
+	{
+		if (bus.fault == HOST_I2C_NACK_ADDRESS) bus.fault = 0;
+		bus.phase = BUS_ADDRESSED;
+		I2C1->SR1 |= I2C_SR1_AF;
+		host_i2c_stats.nacks++;
+		bus_irq();
+		return;
+	}
+
+	if (bus.address & 1)
+	{
+		bme280_sim_transport.read(&bus.ctx, bus.reg, SLAVE_READ_SIZE, bus.read_buf);
+		bus.read_index = 0;
+	}
+	else
+	{
+		I2C1->SR2 |= I2C_SR2_TRA;
+		bus.expect_reg = 1;
+	}
+
+	bus.phase = BUS_ADDRESSED;
+	I2C1->SR1 |= I2C_SR1_ADDR;
+	bus_irq();
+}
+
+/****************************************************************************/
+/*      master transmitter: byte in shift register was sent					*/
+/****************************************************************************/
+static void bus_tx_done(void)
+{
+	bus.event = -1;
+	host_i2c_stats.bytes++;
+
+	if (bus.fault == HOST_I2C_NACK_DATA)
+	{
+		bus.fault = 0;
+		bus.shift_busy = bus.tx_full = 0;
+		bus.write_count = 0;						// sensor drops transaction
+		I2C1->SR1 |= I2C_SR1_AF;
+		host_i2c_stats.nacks++;
+		bus_irq();
+		return;
+	}
+
+	if (bus.tx_full)
+	{
+		bus.tx_full = 0;
+		bus_schedule(9, bus_tx_done);				// next byte moves from DR to shift register
+		I2C1->SR1 |= I2C_SR1_TXE;
+	}
+	else
+	{
+		bus.shift_busy = 0;
+		I2C1->SR1 |= I2C_SR1_BTF;
+	}
+	bus_irq();
+}
+
+/****************************************************************************/
+/*      slave gets byte written by master									*/
+/****************************************************************************/
+static void slave_write(uint8_t data)
+{
+	if (bus.expect_reg)
+	{
+		bus.reg = data;
+		bus.expect_reg = 0;
+		return;
+	}
+
+	if (bus.write_count < 2 * BME280_MAX_REG_WRITE)
+	{
+		bus.writes[bus.write_count].reg = bus.reg;
+		bus.writes[bus.write_count].value = data;
+		bus.write_count++;
+	}
+	bus.expect_reg = 1;
+}
+
+/****************************************************************************/
+/*      master receiver: ACK bit decides if slave sends next byte			*/
+/****************************************************************************/
+static void bus_rx_byte(void)
+{
+	I2C1->DR = bus.read_buf[bus.read_index];
+	if (bus.read_index < SLAVE_READ_SIZE - 1) bus.read_index++;
+	I2C1->SR1 |= I2C_SR1_RXNE;
+	host_i2c_stats.bytes++;
+
+	if (!(I2C1->CR1 & I2C_CR1_ACK))
+	{
+		if (bus.stop_pending) bus_stop();			// NACK + STOP after the last byte
+		else bus.phase = BUS_ADDRESSED;
+	}
+	else bus_schedule(9, bus_rx_done);
+
+	bus_irq();
+}
+
+static void bus_rx_done(void)
+{
+	bus.event = -1;
+
+	if (I2C1->SR1 & I2C_SR1_RXNE) bus.rx_stalled = 1;		// clock is stretched up to DR is read
+	else bus_rx_byte();
+}
+
+/****************************************************************************/
+/*      SCL pulses of bus recovery release SDA								*/
+/****************************************************************************/
+static void bus_gpio(GPIO_TypeDef *port, uint16_t pins, uint8_t level)
+{
+	if ((port != GPIOB) || !(pins & GPIO_Pin_6) || !level || (bus.phase != BUS_HELD)) return;
+
+	if (++bus.scl_pulses >= 3)
+	{
+		GPIOB->IDR |= GPIO_Pin_7;
+		bus.phase = BUS_IDLE;
+		host_i2c_stats.recoveries++;
+	}
+}
+
+/****************************************************************************/
+/*      test interface														*/
+/****************************************************************************/
+void host_i2c_attach(uint8_t SLA, BME280_SIM *sim)
+{
+	uint32_t bit_ns = bus.bit_ns ? bus.bit_ns : 10000;		// speed of I2C_Init is kept
+
+	memset(&bus, 0, sizeof(bus));
+	bus.SLA = SLA;
+	bus.sim = sim;
+	bus.ctx.transport_ctx = sim;
+	bus.event = -1;
+	bus.bit_ns = bit_ns;
+
+	GPIOB->IDR |= GPIO_Pin_6 | GPIO_Pin_7;		// lines are pulled up
+	host_gpio_hook = bus_gpio;
+}
+
+void host_i2c_fault(uint8_t fault)
+{
+	bus.fault = fault;
+
+	if (fault == HOST_I2C_SDA_STUCK)
+	{
+		bus.fault = 0;
+		bus.phase = BUS_HELD;
+		bus.scl_pulses = 0;
+		GPIOB->IDR &= ~GPIO_Pin_7;
+	}
+}
+
+/****************************************************************************/
+/*      functions of StdPeriph driver used by I2C							*/
+/****************************************************************************/
+void I2C_StructInit(I2C_InitTypeDef *init)
+{
+	init->I2C_ClockSpeed = 5000;
+	init->I2C_Mode = I2C_Mode_I2C;
+	init->I2C_DutyCycle = I2C_DutyCycle_2;
+	init->I2C_OwnAddress1 = 0;
+	init->I2C_Ack = I2C_Ack_Disable;
+	init->I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
+}
+
+void I2C_Init(I2C_TypeDef *i2c, I2C_InitTypeDef *init)
+{
+	bus.bit_ns = 1000000000UL / init->I2C_ClockSpeed;
+	i2c->CR1 = (i2c->CR1 & ~I2C_CR1_ACK) | init->I2C_Ack;
+}
+
+void I2C_Cmd(I2C_TypeDef *i2c, FunctionalState state)
+{
+	if (state != DISABLE) i2c->CR1 |= I2C_CR1_PE;
+	else i2c->CR1 &= ~I2C_CR1_PE;
+}
+
+void I2C_SoftwareResetCmd(I2C_TypeDef *i2c, FunctionalState state)
+{
+	if (state == DISABLE) return;
+
+	host_event_cancel(bus.event);
+	bus.event = -1;
+	if (bus.phase != BUS_HELD) bus.phase = BUS_IDLE;
+	bus.shift_busy = bus.tx_full = bus.rx_stalled = bus.stop_pending = 0;
+	i2c->SR1 = 0;
+	i2c->SR2 = 0;
+	i2c->CR1 = 0;
+	i2c->CR2 = 0;
+}
+
+void I2C_ITConfig(I2C_TypeDef *i2c, uint16_t it, FunctionalState state)
+{
+	bus_clear_addr();
+
+	if (state != DISABLE) i2c->CR2 |= it;
+	else i2c->CR2 &= ~it;
+
+	bus_irq();
+}
+
+void I2C_AcknowledgeConfig(I2C_TypeDef *i2c, FunctionalState state)
+{
+	if (state != DISABLE) i2c->CR1 |= I2C_CR1_ACK;
+	else i2c->CR1 &= ~I2C_CR1_ACK;
+}
+
+void I2C_GenerateSTART(I2C_TypeDef *i2c, FunctionalState state)
+{
+	if (state == DISABLE) return;
+
+	bus_clear_addr();
+	if (bus.phase == BUS_HELD) return;				// bus is busy, START isn't generated
+
+	if (bus.write_count) bme280_sim_transport.write(&bus.ctx, bus.writes, bus.write_count);
+	bus.write_count = 0;
+
+	i2c->SR1 &= ~(I2C_SR1_TXE | I2C_SR1_BTF);
+	bus.shift_busy = bus.tx_full = 0;
+	bus.phase = BUS_START;
+	host_i2c_stats.starts++;
+	bus_schedule(1, bus_start_done);
+}
+
+void I2C_GenerateSTOP(I2C_TypeDef *i2c, FunctionalState state)
+{
+	(void)i2c;
+	if (state == DISABLE) return;
+
+	bus_clear_addr();
+	if (bus.phase == BUS_RX) bus.stop_pending = 1;		// STOP after the current byte
+	else if (bus.phase != BUS_IDLE && bus.phase != BUS_HELD) bus_stop();
+}
+
+void I2C_Send7bitAddress(I2C_TypeDef *i2c, uint8_t address, uint8_t direction)
+{
+	i2c->SR1 &= ~I2C_SR1_SB;
+	bus.address = (direction == I2C_Direction_Receiver) ? (address | 1) : (address & 0xFE);
+	bus.phase = BUS_ADDRESS;
+	bus_schedule(9, bus_address_done);
+}
+
+void I2C_SendData(I2C_TypeDef *i2c, uint8_t data)
+{
+	bus_clear_addr();
+	if (bus.phase != BUS_TX) return;
+
+	slave_write(data);
+
+	if (!bus.shift_busy)
+	{
+		bus.shift_busy = 1;
+		bus_schedule(9, bus_tx_done);			// DR goes to shift register at once, TXE stays set
+	}
+	else
+	{
+		bus.tx_full = 1;
+		i2c->SR1 &= ~I2C_SR1_TXE;
+	}
+	i2c->SR1 &= ~I2C_SR1_BTF;
+	bus_irq();
+}
+
+uint8_t I2C_ReceiveData(I2C_TypeDef *i2c)
+{
+	uint8_t data = (uint8_t)i2c->DR;
+
+	bus_clear_addr();
+	i2c->SR1 &= ~I2C_SR1_RXNE;
+
+	if (bus.rx_stalled)
+	{
+		bus.rx_stalled = 0;
+		bus_rx_byte();
+	}
+	return data;
+}
+
+void I2C_ClearITPendingBit(I2C_TypeDef *i2c, uint32_t it)
+{
+	i2c->SR1 &= ~(uint16_t)(it & 0xFFFF);
+}
@@ -0,0 +1,33 @@
+/*
+ * host_i2c.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef HOST_HOST_I2C_H_
+#define HOST_HOST_I2C_H_
+
+#include "BME280/BME280_sim.h"
+
+// faults injected into the next transaction (once)
+#define HOST_I2C_NACK_ADDRESS	1		// slave doesn't acknowledge its address
+#define HOST_I2C_NACK_DATA		2		// slave doesn't acknowledge data byte
+#define HOST_I2C_ARBITRATION	3		// other master wins the bus at START
+#define HOST_I2C_SDA_STUCK		4		// slave holds SDA low up to a few SCL pulses of bus recovery
+
+typedef struct {
+	uint32_t starts;			// START and repeated START conditions
+	uint32_t stops;				// STOP conditions
+	uint32_t bytes;				// bytes transferred after address
+	uint32_t nacks;				// NACK of address or data
+	uint32_t arbitration;		// arbitration losses
+	uint32_t recoveries;		// SDA released by SCL pulses
+} HOST_I2C_STATS;
+
+extern HOST_I2C_STATS host_i2c_stats;
+
+void host_i2c_attach(uint8_t SLA, BME280_SIM *sim);		// simulated sensor with 8-bit address SLA
+void host_i2c_fault(uint8_t fault);
+
+#endif /* HOST_HOST_I2C_H_ */
@@ -0,0 +1,216 @@
+/*
+ * host_power.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "host_power.h"
+#include <string.h>
+
+// --------------------------------------------------------- //
+// STOP mode with RTC on LSE (32768 Hz) and EXTI wake-up. RTC counter counts
+// from RTC_SetCounter() at 32768 / (PRL + 1) Hz, alarm at counter value sets
+// ALRF and raises RTCAlarm interrupt through EXTI line 17. In STOP mode
+// TIM2 and TIM3 are frozen (their counters keep value), CPU waits for RTC
+// alarm or for edge on other EXTI line (host_power_wake_at), then timers
+// run again. HSE, PLL and LSE start at once.
+#define HOST_LSE_HZ		32768ULL
+
+HOST_POWER_STATS host_power_stats;
+
+void RTCAlarm_IRQHandler(void) __attribute__((weak));
+
+static uint64_t rtc_start_ns;			// time when counter was written
+static uint32_t rtc_start;				// written value
+static int alarm_event = -1;
+static uint8_t woken;					// EXTI line other than 17 had an edge
+
+static void rtc_alarm(void);
+static void exti_wake(void);
+static void exti_wake_handler(void);
+
+
+void host_power_reset(void)
+{
+	memset(&host_power_stats, 0, sizeof(host_power_stats));
+	alarm_event = -1;
+	woken = 0;
+}
+
+void host_power_wake_at(uint64_t time_ns)
+{
+	host_event_at(time_ns, exti_wake);
+}
+
+static void exti_wake(void)
+{
+	woken = 1;
+	host_irq(exti_wake_handler);
+}
+
+static void exti_wake_handler(void)
+{
+}
+
+/****************************************************************************/
+/*      RTC: counter follows simulated time, alarm is an event				*/
+/****************************************************************************/
+static uint64_t rtc_prescaler(void)
+{
+	return ((uint64_t)(RTC->PRLH & 0x0F) << 16 | RTC->PRLL) + 1;
+}
+
+uint32_t RTC_GetCounter(void)
+{
+	return rtc_start + (uint32_t)((host_now_ns - rtc_start_ns) * HOST_LSE_HZ / (rtc_prescaler() * 1000000000ULL));
+}
+
+void RTC_SetCounter(uint32_t value)
+{
+	rtc_start = value;
+	rtc_start_ns = host_now_ns;
+}
+
+// the first ns when counter has alarm value
+void RTC_SetAlarm(uint32_t value)
+{
+	uint64_t ticks_ns = (uint64_t)(value - rtc_start) * rtc_prescaler() * 1000000000ULL;
+
+	host_event_cancel(alarm_event);
+	alarm_event = host_event_at(rtc_start_ns + (ticks_ns + HOST_LSE_HZ - 1) / HOST_LSE_HZ, rtc_alarm);
+}
+
+static void rtc_alarm(void)
+{
+	alarm_event = -1;
+	RTC->CRL |= RTC_FLAG_ALR;
+	EXTI->PR |= EXTI_Line17;
+	if ((RTC->CRH & RTC_IT_ALR) && (EXTI->IMR & EXTI_Line17)) host_irq(RTCAlarm_IRQHandler);
+}
+
+void RTC_SetPrescaler(uint32_t value)
+{
+	RTC->PRLH = (value >> 16) & 0x0F;
+	RTC->PRLL = value & 0xFFFF;
+}
+
+void RTC_ITConfig(uint16_t it, FunctionalState state)
+{
+	if (state != DISABLE) RTC->CRH |= it;
+	else RTC->CRH &= ~it;
+}
+
+void RTC_ClearFlag(uint16_t flag)
+{
+	RTC->CRL &= ~flag;
+}
+
+void RTC_ClearITPendingBit(uint16_t it)
+{
+	RTC->CRL &= ~it;
+}
+
+void RTC_WaitForSynchro(void)
+{
+}
+
+void RTC_WaitForLastTask(void)
+{
+}
+
+/****************************************************************************/
+/*      EXTI: mask of interrupt lines and pending register					*/
+/****************************************************************************/
+void EXTI_Init(EXTI_InitTypeDef *init)
+{
+	if (init->EXTI_LineCmd != DISABLE) EXTI->IMR |= init->EXTI_Line;
+	else EXTI->IMR &= ~init->EXTI_Line;
+}
+
+void EXTI_ClearITPendingBit(uint32_t line)
+{
+	EXTI->PR &= ~line;
+}
+
+/****************************************************************************/
+/*      STOP mode: timers are frozen up to alarm or other EXTI edge			*/
+/****************************************************************************/
+void PWR_EnterSTOPMode(uint32_t regulator, uint8_t entry)
+{
+	uint8_t tim2_running = (TIM2->CR1 & TIM_CR1_CEN) ? 1 : 0;
+	uint8_t tim3_running = (TIM3->CR1 & TIM_CR1_CEN) ? 1 : 0;
+	uint64_t start = host_now_ns;
+
+	(void)regulator; (void)entry;
+
+	host_power_stats.stops++;
+	if (!(USART1->SR & USART_FLAG_TC)) host_power_stats.tx_busy++;
+
+	if (tim2_running) TIM_Cmd(TIM2, DISABLE);
+	if (tim3_running) TIM_Cmd(TIM3, DISABLE);
+
+	woken = 0;
+	host_wfi();
+
+	if (woken) host_power_stats.external++;
+	else host_power_stats.alarms++;
+	host_power_stats.stop_ns += host_now_ns - start;
+
+	if (tim2_running) TIM_Cmd(TIM2, ENABLE);
+	if (tim3_running) TIM_Cmd(TIM3, ENABLE);
+}
+
+void PWR_BackupAccessCmd(FunctionalState state)
+{
+	(void)state;
+}
+
+/****************************************************************************/
+/*      RCC: oscillators and PLL are ready at once							*/
+/****************************************************************************/
+void RCC_LSEConfig(uint8_t lse)
+{
+	(void)lse;
+}
+
+void RCC_RTCCLKConfig(uint32_t source)
+{
+	(void)source;
+}
+
+void RCC_RTCCLKCmd(FunctionalState state)
+{
+	(void)state;
+}
+
+void RCC_HSEConfig(uint32_t hse)
+{
+	(void)hse;
+}
+
+ErrorStatus RCC_WaitForHSEStartUp(void)
+{
+	return SUCCESS;
+}
+
+void RCC_PLLCmd(FunctionalState state)
+{
+	(void)state;
+}
+
+void RCC_SYSCLKConfig(uint32_t source)
+{
+	(void)source;
+}
+
+uint8_t RCC_GetSYSCLKSource(void)
+{
+	return 0x08;			// PLL
+}
+
+FlagStatus RCC_GetFlagStatus(uint8_t flag)
+{
+	(void)flag;
+	return SET;
+}
@@ -0,0 +1,26 @@
+/*
+ * host_power.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef HOST_HOST_POWER_H_
+#define HOST_HOST_POWER_H_
+
+#include <stdint.h>
+
+typedef struct {
+	uint32_t stops;				// entries of STOP mode
+	uint32_t alarms;			// STOP ended by RTC alarm
+	uint32_t external;			// STOP ended by other EXTI line
+	uint32_t tx_busy;			// STOP entered while USART1 was sending (data lost)
+	uint64_t stop_ns;			// time in STOP mode
+} HOST_POWER_STATS;
+
+extern HOST_POWER_STATS host_power_stats;
+
+void host_power_reset(void);								// clear counters and wake-up requests
+void host_power_wake_at(uint64_t time_ns);					// edge on EXTI line at time_ns (wakes up from STOP mode)
+
+#endif /* HOST_HOST_POWER_H_ */
@@ -0,0 +1,230 @@
+/*
+ * host_spi.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "host_spi.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// --------------------------------------------------------- //
+// SPI1 master with BME280 slaves on chip-select pins. Slave decodes SPI
+// protocol of the sensor: the first byte after CS falling edge is register
+// address with bit 7 = 1 for read (auto-increment), 0 for write followed by
+// value and next (address, value) pairs. Registers are served by BME280_SIM.
+// DMA transfer (channel 3 -> DR -> channel 2) is clocked at once when the
+// driver enables SPI DMA requests, simulated time is moved by the duration
+// of transfer and TC of channel 2 is raised.
+#define SLAVE_IDLE			0
+#define SLAVE_ADDRESS		1
+#define SLAVE_READ			2
+#define SLAVE_WRITE_VALUE	3
+#define SLAVE_WRITE_ADDRESS	4
+
+#define SLAVE_READ_SIZE		64		// registers fetched from simulator at address phase
+
+typedef struct {
+	GPIO_TypeDef *port;
+	uint16_t pin;
+	BME280_SIM *sim;
+	BME280 ctx;						// transport context for simulator
+	uint8_t state;
+	uint8_t read_buf[SLAVE_READ_SIZE];
+	uint8_t read_index;
+	uint8_t reg;
+	BME280_REG writes[2 * BME280_MAX_REG_WRITE];
+	uint8_t write_count;
+} HOST_SPI_SLAVE;
+
+HOST_SPI_STATS host_spi_stats;
+
+static HOST_SPI_SLAVE slaves[HOST_SPI_SLAVES];
+static uint8_t slave_count;
+static uint8_t spi_rx;			// last received byte of polled SPI
+
+static void spi_gpio(GPIO_TypeDef *port, uint16_t pins, uint8_t level);
+static void spi_dma_run(void);
+static uint8_t spi_exchange(uint8_t mosi);
+
+
+/****************************************************************************/
+/*      connect simulated sensor to chip select								*/
+/****************************************************************************/
+void host_spi_attach(GPIO_TypeDef *port, uint16_t pin, BME280_SIM *sim)
+{
+	HOST_SPI_SLAVE *slave = &slaves[slave_count++];
+
+	memset(slave, 0, sizeof(*slave));
+	slave->port = port;
+	slave->pin = pin;
+	slave->sim = sim;
+	slave->ctx.transport_ctx = sim;
+
+	host_gpio_hook = spi_gpio;
+}
+
+/****************************************************************************/
+/*      chip select edges: falling starts transaction, rising ends it		*/
+/****************************************************************************/
+static void spi_gpio(GPIO_TypeDef *port, uint16_t pins, uint8_t level)
+{
+	for (uint8_t i = 0; i < slave_count; i++)
+	{
+		HOST_SPI_SLAVE *slave = &slaves[i];
+
+		if ((slave->port != port) || !(slave->pin & pins)) continue;
+
+		if (!level)
+		{
+			if (slave->state == SLAVE_IDLE) host_spi_stats.selects++;
+			slave->state = SLAVE_ADDRESS;
+			slave->write_count = 0;
+			continue;
+		}
+
+		if (slave->state == SLAVE_IDLE) continue;
+		if (slave->write_count) bme280_sim_transport.write(&slave->ctx, slave->writes, slave->write_count);
+		slave->state = SLAVE_IDLE;
+	}
+}
+
+/****************************************************************************/
+/*      one byte clocked: MOSI goes to all selected slaves, MISO is			*/
+/*      taken from them (two selected slaves are bus collision)				*/
+/****************************************************************************/
+static uint8_t spi_exchange(uint8_t mosi)
+{
+	uint8_t miso = 0xFF, selected = 0;
+
+	host_spi_stats.bytes++;
+
+	for (uint8_t i = 0; i < slave_count; i++)
+	{
+		HOST_SPI_SLAVE *slave = &slaves[i];
+
+		switch (slave->state)
+		{
+		case SLAVE_IDLE:
+			continue;
+
+		case SLAVE_ADDRESS:
+			if (mosi & 0x80)
+			{
+				bme280_sim_transport.read(&slave->ctx, mosi, SLAVE_READ_SIZE, slave->read_buf);
+				slave->read_index = 0;
+				slave->state = SLAVE_READ;
+			}
+			else
+			{
+				slave->reg = mosi | 0x80;
+				slave->state = SLAVE_WRITE_VALUE;
+			}
+			break;
+
+		case SLAVE_READ:
+			miso = slave->read_buf[slave->read_index];
+			if (slave->read_index < SLAVE_READ_SIZE - 1) slave->read_index++;
+			break;
+
+		case SLAVE_WRITE_VALUE:
+			if (slave->write_count < 2 * BME280_MAX_REG_WRITE)
+			{
+				slave->writes[slave->write_count].reg = slave->reg;
+				slave->writes[slave->write_count].value = mosi;
+				slave->write_count++;
+			}
+			slave->state = SLAVE_WRITE_ADDRESS;
+			break;
+
+		case SLAVE_WRITE_ADDRESS:
+			slave->reg = mosi | 0x80;
+			slave->state = SLAVE_WRITE_VALUE;
+			break;
+		}
+		selected++;
+	}
+
+	if (selected > 1) host_spi_stats.collisions++;
+	if (!selected) host_spi_stats.unselected++;
+	return miso;
+}
+
+/****************************************************************************/
+/*      DMA: whole block of channel 3 is clocked, received bytes are		*/
+/*      written by channel 2												*/
+/****************************************************************************/
+static void spi_dma_run(void)
+{
+	DMA_Channel_TypeDef *rx = DMA1_Channel2, *tx = DMA1_Channel3;
+	uint16_t size = tx->CNDTR;
+	uint8_t *tx_mem = host_ptr(tx->CMAR), *rx_mem = host_ptr(rx->CMAR);
+
+	if (rx->CNDTR != size)
+	{
+		fprintf(stderr, "host_spi: Rx and Tx channels have different length\n");
+		exit(2);
+	}
+
+	host_spi_stats.transfers++;
+	for (uint16_t i = 0; i < size; i++)
+	{
+		rx_mem[i] = spi_exchange(tx_mem[i]);
+	}
+
+	tx->CNDTR = 0;
+	rx->CNDTR = 0;
+	host_advance_ns((uint64_t)size * HOST_SPI_BYTE_NS);
+
+	host_dma_complete(tx, 0);
+	host_dma_complete(rx, 0);
+}
+
+/****************************************************************************/
+/*      functions of StdPeriph driver used by SPI							*/
+/****************************************************************************/
+void SPI_Init(SPI_TypeDef *spi, SPI_InitTypeDef *init)
+{
+	(void)spi; (void)init;
+}
+
+void SPI_Cmd(SPI_TypeDef *spi, FunctionalState state)
+{
+	if (state != DISABLE) spi->CR1 |= SPI_CR1_SPE;
+	else spi->CR1 &= ~SPI_CR1_SPE;
+}
+
+void SPI_I2S_DMACmd(SPI_TypeDef *spi, uint16_t requests, FunctionalState state)
+{
+	const uint16_t both = SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx;
+
+	if (state == DISABLE)
+	{
+		spi->CR2 &= ~requests;
+		return;
+	}
+
+	spi->CR2 |= requests;
+	if (((spi->CR2 & both) == both) && (DMA1_Channel2->CCR & DMA_CCR1_EN) && (DMA1_Channel3->CCR & DMA_CCR1_EN))
+		spi_dma_run();
+}
+
+void SPI_I2S_SendData(SPI_TypeDef *spi, uint16_t data)
+{
+	(void)spi;
+	spi_rx = spi_exchange((uint8_t)data);
+	host_advance_ns(HOST_SPI_BYTE_NS);
+}
+
+uint16_t SPI_I2S_ReceiveData(SPI_TypeDef *spi)
+{
+	(void)spi;
+	return spi_rx;
+}
+
+FlagStatus SPI_I2S_GetFlagStatus(SPI_TypeDef *spi, uint16_t flag)
+{
+	(void)spi;
+	return (flag == SPI_I2S_FLAG_BSY) ? RESET : SET;	// byte is clocked inside SendData
+}
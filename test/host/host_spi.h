@@ -0,0 +1,28 @@
+/*
+ * host_spi.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef HOST_HOST_SPI_H_
+#define HOST_HOST_SPI_H_
+
+#include "BME280/BME280_sim.h"
+
+#define HOST_SPI_SLAVES		4
+#define HOST_SPI_BYTE_NS	889			// 8 bits at 9 MHz (72 MHz / prescaler 8)
+
+typedef struct {
+	uint32_t transfers;			// DMA blocks
+	uint32_t bytes;				// bytes clocked
+	uint32_t selects;			// chip-select windows
+	uint32_t collisions;		// bytes clocked with more than one slave selected
+	uint32_t unselected;		// bytes clocked without selected slave
+} HOST_SPI_STATS;
+
+extern HOST_SPI_STATS host_spi_stats;
+
+void host_spi_attach(GPIO_TypeDef *port, uint16_t pin, BME280_SIM *sim);	// simulated sensor on chip select
+
+#endif /* HOST_HOST_SPI_H_ */
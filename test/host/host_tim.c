@@ -0,0 +1,208 @@
+/*
+ * host_tim.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// TIM2 and TIM3: up-counting time base (72 MHz before prescaler) with
+// update event, one-pulse mode and compare of channel 1. CNT follows
+// simulated time, update and compare set flags at exact time and raise
+// interrupt if it is enabled in DIER.
+#define HOST_TIM_CLOCK		72000000ULL
+
+typedef struct {
+	TIM_TypeDef *tim;
+	void (*handler)(void);			// TIMx_IRQHandler
+	void (*update)(void);			// callbacks of events
+	void (*compare)(void);
+	uint64_t start_ns;				// time when CNT was 0 in current period
+	uint64_t compare_from;			// compare can't match before this time
+	int update_event;
+	int compare_event;
+} HOST_TIM;
+
+void TIM2_IRQHandler(void) __attribute__((weak));
+void TIM3_IRQHandler(void) __attribute__((weak));
+
+static void tim2_update(void);
+static void tim3_update(void);
+static void tim2_compare(void);
+static void tim3_compare(void);
+
+static HOST_TIM timers[2] = {
+	{TIM2, TIM2_IRQHandler, tim2_update, tim2_compare, 0, 0, -1, -1},
+	{TIM3, TIM3_IRQHandler, tim3_update, tim3_compare, 0, 0, -1, -1},
+};
+
+
+static HOST_TIM *host_tim(TIM_TypeDef *tim)
+{
+	return (tim == TIM2) ? &timers[0] : &timers[1];
+}
+
+static uint64_t tick_ns(TIM_TypeDef *tim)
+{
+	return ((uint64_t)tim->PSC + 1) * 1000000000ULL / HOST_TIM_CLOCK;
+}
+
+static uint64_t period_ns(TIM_TypeDef *tim)
+{
+	return ((uint64_t)tim->ARR + 1) * tick_ns(tim);
+}
+
+/****************************************************************************/
+/*      counter of running timer follows simulated time						*/
+/****************************************************************************/
+static void tim_sync(HOST_TIM *t)
+{
+	if (!(t->tim->CR1 & TIM_CR1_CEN)) return;
+	t->tim->CNT = (uint16_t)(((host_now_ns - t->start_ns) / tick_ns(t->tim)) % ((uint32_t)t->tim->ARR + 1));
+}
+
+void host_time_changed(void)
+{
+	tim_sync(&timers[0]);
+	tim_sync(&timers[1]);
+}
+
+/****************************************************************************/
+/*      events of update (end of period) and compare of channel 1			*/
+/****************************************************************************/
+static void tim_schedule(HOST_TIM *t)
+{
+	uint64_t compare;
+
+	host_event_cancel(t->update_event);
+	host_event_cancel(t->compare_event);
+	t->update_event = t->compare_event = -1;
+
+	if (!(t->tim->CR1 & TIM_CR1_CEN)) return;
+
+	t->update_event = host_event_at(t->start_ns + period_ns(t->tim), t->update);
+
+	if ((t->tim->DIER & TIM_IT_CC1) && (t->tim->CCR1 <= t->tim->ARR))
+	{
+		compare = t->start_ns + t->tim->CCR1 * tick_ns(t->tim);
+		while (compare < t->compare_from) compare += period_ns(t->tim);
+		t->compare_event = host_event_at(compare, t->compare);
+	}
+}
+
+static void tim_update(HOST_TIM *t)
+{
+	t->update_event = -1;
+	t->tim->SR |= TIM_SR_UIF;
+	t->tim->CNT = 0;
+
+	if (t->tim->CR1 & TIM_CR1_OPM) t->tim->CR1 &= ~TIM_CR1_CEN;		// one pulse: counter stops
+	else t->start_ns = host_now_ns;
+
+	tim_schedule(t);
+	if (t->tim->DIER & TIM_IT_Update) host_irq(t->handler);
+}
+
+static void tim_compare(HOST_TIM *t)
+{
+	t->compare_event = -1;
+	t->tim->SR |= TIM_SR_CC1IF;
+	t->compare_from = host_now_ns + 1;
+
+	tim_schedule(t);
+	if (t->tim->DIER & TIM_IT_CC1) host_irq(t->handler);
+}
+
+static void tim2_update(void)	{ tim_update(&timers[0]); }
+static void tim3_update(void)	{ tim_update(&timers[1]); }
+static void tim2_compare(void)	{ tim_compare(&timers[0]); }
+static void tim3_compare(void)	{ tim_compare(&timers[1]); }
+
+/****************************************************************************/
+/*      functions of StdPeriph driver used by TIMER and CLOCK				*/
+/****************************************************************************/
+void TIM_TimeBaseStructInit(TIM_TimeBaseInitTypeDef *init)
+{
+	init->TIM_Period = 0xFFFF;
+	init->TIM_Prescaler = 0;
+	init->TIM_ClockDivision = TIM_CKD_DIV1;
+	init->TIM_CounterMode = TIM_CounterMode_Up;
+	init->TIM_RepetitionCounter = 0;
+}
+
+void TIM_TimeBaseInit(TIM_TypeDef *tim, TIM_TimeBaseInitTypeDef *init)
+{
+	HOST_TIM *t = host_tim(tim);
+
+	tim->ARR = init->TIM_Period;
+	tim->PSC = init->TIM_Prescaler;
+	tim->CNT = 0;
+	tim->SR |= TIM_SR_UIF;			// update generated to load prescaler
+	t->start_ns = host_now_ns;
+	tim_schedule(t);
+}
+
+void TIM_Cmd(TIM_TypeDef *tim, FunctionalState state)
+{
+	HOST_TIM *t = host_tim(tim);
+
+	tim_sync(t);
+	if (state != DISABLE)
+	{
+		if (!(tim->CR1 & TIM_CR1_CEN)) t->start_ns = host_now_ns - tim->CNT * tick_ns(tim);
+		tim->CR1 |= TIM_CR1_CEN;
+	}
+	else tim->CR1 &= ~TIM_CR1_CEN;
+
+	t->compare_from = host_now_ns;
+	tim_schedule(t);
+}
+
+void TIM_SelectOnePulseMode(TIM_TypeDef *tim, uint16_t mode)
+{
+	tim->CR1 = (tim->CR1 & ~TIM_CR1_OPM) | mode;
+}
+
+void TIM_ITConfig(TIM_TypeDef *tim, uint16_t it, FunctionalState state)
+{
+	HOST_TIM *t = host_tim(tim);
+
+	if (state != DISABLE) tim->DIER |= it;
+	else tim->DIER &= ~it;
+
+	t->compare_from = host_now_ns;
+	tim_schedule(t);
+}
+
+ITStatus TIM_GetITStatus(TIM_TypeDef *tim, uint16_t it)
+{
+	return ((tim->SR & it) && (tim->DIER & it)) ? SET : RESET;
+}
+
+void TIM_ClearITPendingBit(TIM_TypeDef *tim, uint16_t it)
+{
+	tim->SR &= ~it;
+}
+
+void TIM_GenerateEvent(TIM_TypeDef *tim, uint16_t source)
+{
+	HOST_TIM *t = host_tim(tim);
+
+	tim->SR |= source;
+	if (tim->DIER & source) host_irq(t->handler);
+}
+
+void TIM_SetCounter(TIM_TypeDef *tim, uint16_t counter)
+{
+	HOST_TIM *t = host_tim(tim);
+
+	tim->CNT = counter;
+	t->start_ns = host_now_ns - counter * tick_ns(tim);
+	tim_schedule(t);
+}
+
+void TIM_SetAutoreload(TIM_TypeDef *tim, uint16_t autoreload)
+{
+	tim->ARR = autoreload;
+	tim_schedule(host_tim(tim));
+}
@@ -0,0 +1,200 @@
+/*
+ * host_usart.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#include "host_usart.h"
+#include <string.h>
+
+// --------------------------------------------------------- //
+// USART1 at 115200 baud with DMA1 channel 4 (TX) and channel 5 (RX, circular).
+// TX block is sent in CNDTR byte times after the channel is enabled, bytes
+// are copied from memory at the end of block, so data overwritten by the
+// driver while they are sent are seen as corrupted output. RX bytes are
+// written by channel 5 one per byte time with HT and TC flags of circular
+// buffer, line is idle one byte time after the last byte (IDLE interrupt).
+HOST_USART_STATS host_usart_stats;
+char host_usart_tx[HOST_USART_CAPTURE];
+uint32_t host_usart_tx_len;
+
+void USART1_IRQHandler(void) __attribute__((weak));
+
+static char rx_queue[HOST_USART_RX_QUEUE];
+static uint16_t rx_head, rx_tail;
+static uint8_t rx_running;				// event of the next byte is scheduled
+static uint16_t rx_size;				// CNDTR when channel 5 was enabled
+
+static void tx_start(DMA_Channel_TypeDef *channel);
+static void tx_done(void);
+static void rx_start(DMA_Channel_TypeDef *channel);
+static void rx_byte(void);
+static void rx_idle(void);
+
+
+/****************************************************************************/
+/*      connect model to DMA channels										*/
+/****************************************************************************/
+void host_usart_attach(void)
+{
+	memset(&host_usart_stats, 0, sizeof(host_usart_stats));
+	host_usart_tx_len = 0;
+	rx_head = rx_tail = 0;
+	rx_running = 0;
+
+	host_dma_hook[4] = tx_start;
+	host_dma_hook[5] = rx_start;
+}
+
+/****************************************************************************/
+/*      TX: block ends after its byte times									*/
+/****************************************************************************/
+static void tx_start(DMA_Channel_TypeDef *channel)
+{
+	USART1->SR &= ~USART_FLAG_TC;					// data register written by DMA
+	host_event_at(host_now_ns + (uint64_t)channel->CNDTR * HOST_USART_BYTE_NS, tx_done);
+}
+
+static void tx_done(void)
+{
+	DMA_Channel_TypeDef *channel = DMA1_Channel4;
+	uint32_t len = channel->CNDTR;
+
+	if (!(channel->CCR & DMA_CCR1_EN) || !len) return;
+
+	for (uint32_t i = 0; i < len; i++)
+	{
+		if (host_usart_tx_len < HOST_USART_CAPTURE) host_usart_tx[host_usart_tx_len++] = host_ptr(channel->CMAR)[i];
+	}
+
+	host_usart_stats.tx_transfers++;
+	host_usart_stats.tx_bytes += len;
+	if (len > host_usart_stats.tx_max_transfer) host_usart_stats.tx_max_transfer = len;
+
+	channel->CNDTR = 0;
+	USART1->SR |= USART_FLAG_TC;
+	host_dma_complete(channel, 0);
+}
+
+/****************************************************************************/
+/*      RX: circular buffer of channel 5									*/
+/****************************************************************************/
+static void rx_start(DMA_Channel_TypeDef *channel)
+{
+	rx_size = channel->CNDTR;
+}
+
+void host_usart_receive(const char *data, uint16_t len)
+{
+	for (uint16_t i = 0; i < len; i++)
+	{
+		rx_queue[rx_head] = data[i];
+		rx_head = (rx_head + 1) % HOST_USART_RX_QUEUE;
+	}
+
+	if (!rx_running && len)
+	{
+		rx_running = 1;
+		host_event_at(host_now_ns + HOST_USART_BYTE_NS, rx_byte);
+	}
+}
+
+static void rx_byte(void)
+{
+	DMA_Channel_TypeDef *channel = DMA1_Channel5;
+	char data = rx_queue[rx_tail];
+
+	rx_tail = (rx_tail + 1) % HOST_USART_RX_QUEUE;
+	USART1->DR = (uint8_t)data;
+
+	if ((channel->CCR & DMA_CCR1_EN) && (USART1->CR3 & USART_CR3_DMAR) && rx_size)
+	{
+		host_ptr(channel->CMAR)[rx_size - channel->CNDTR] = data;
+		host_usart_stats.rx_bytes++;
+
+		if (--channel->CNDTR == rx_size / 2) host_dma_complete(channel, 1);
+		else if (!channel->CNDTR)
+		{
+			channel->CNDTR = rx_size;			// circular mode
+			host_dma_complete(channel, 0);
+		}
+	}
+	else host_usart_stats.rx_lost++;
+
+	if (rx_tail != rx_head) host_event_at(host_now_ns + HOST_USART_BYTE_NS, rx_byte);
+	else
+	{
+		rx_running = 0;
+		host_event_at(host_now_ns + HOST_USART_BYTE_NS, rx_idle);
+	}
+}
+
+static void rx_idle(void)
+{
+	if (rx_running) return;				// next frame started
+
+	host_usart_stats.idle++;
+	USART1->SR |= USART_FLAG_IDLE;
+	if (USART1->CR1 & USART_CR1_IDLEIE) host_irq(USART1_IRQHandler);
+}
+
+/****************************************************************************/
+/*      functions of StdPeriph driver used by UART							*/
+/****************************************************************************/
+void USART_Init(USART_TypeDef *usart, USART_InitTypeDef *init)
+{
+	usart->BRR = 72000000 / init->USART_BaudRate;
+	usart->CR1 = (usart->CR1 & USART_CR1_UE) | init->USART_Mode | init->USART_Parity | init->USART_WordLength;
+	usart->CR2 = init->USART_StopBits;
+	usart->CR3 = init->USART_HardwareFlowControl;
+	usart->SR |= USART_FLAG_TC | USART_FLAG_TXE;		// reset value: nothing is sent
+}
+
+void USART_Cmd(USART_TypeDef *usart, FunctionalState state)
+{
+	if (state != DISABLE) usart->CR1 |= USART_CR1_UE;
+	else usart->CR1 &= ~USART_CR1_UE;
+}
+
+void USART_DMACmd(USART_TypeDef *usart, uint16_t requests, FunctionalState state)
+{
+	if (state != DISABLE) usart->CR3 |= requests;
+	else usart->CR3 &= ~requests;
+}
+
+// interrupt: bits 5..7 are register (1 -> CR1, 2 -> CR2, 3 -> CR3), bits 0..4 enable bit, bits 8..15 flag in SR
+static volatile uint16_t *it_register(USART_TypeDef *usart, uint16_t it)
+{
+	switch ((it >> 5) & 7)
+	{
+	case 1:	 return &usart->CR1;
+	case 2:	 return &usart->CR2;
+	default: return &usart->CR3;
+	}
+}
+
+void USART_ITConfig(USART_TypeDef *usart, uint16_t it, FunctionalState state)
+{
+	volatile uint16_t *reg = it_register(usart, it);
+
+	if (state != DISABLE) *reg |= 1 << (it & 0x1F);
+	else *reg &= ~(1 << (it & 0x1F));
+}
+
+ITStatus USART_GetITStatus(USART_TypeDef *usart, uint16_t it)
+{
+	return ((*it_register(usart, it) & (1 << (it & 0x1F))) && (usart->SR & (1 << (it >> 8)))) ? SET : RESET;
+}
+
+FlagStatus USART_GetFlagStatus(USART_TypeDef *usart, uint16_t flag)
+{
+	return (usart->SR & flag) ? SET : RESET;
+}
+
+// reading of SR and then DR clears IDLE (and RXNE)
+uint16_t USART_ReceiveData(USART_TypeDef *usart)
+{
+	usart->SR &= ~(USART_FLAG_IDLE | USART_FLAG_RXNE);
+	return usart->DR & 0x1FF;
+}
@@ -0,0 +1,33 @@
+/*
+ * host_usart.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef HOST_HOST_USART_H_
+#define HOST_HOST_USART_H_
+
+#include <stdint.h>
+
+#define HOST_USART_BYTE_NS	86806		// 10 bits at 115200 baud
+#define HOST_USART_CAPTURE	16384		// bytes sent by TX DMA which are kept for checks
+#define HOST_USART_RX_QUEUE	1024		// bytes waiting on RX line
+
+typedef struct {
+	uint32_t tx_transfers;		// DMA blocks of channel 4
+	uint32_t tx_bytes;
+	uint32_t tx_max_transfer;	// the longest DMA block
+	uint32_t rx_bytes;			// bytes written by channel 5
+	uint32_t rx_lost;			// bytes received while channel 5 was disabled
+	uint32_t idle;				// IDLE events (end of frame)
+} HOST_USART_STATS;
+
+extern HOST_USART_STATS host_usart_stats;
+extern char host_usart_tx[HOST_USART_CAPTURE];		// sent bytes in order
+extern uint32_t host_usart_tx_len;
+
+void host_usart_attach(void);										// connect model to DMA1 channels 4 and 5
+void host_usart_receive(const char *data, uint16_t len);			// bytes on RX line one per byte time from now, IDLE after the last one
+
+#endif /* HOST_HOST_USART_H_ */
@@ -0,0 +1,40 @@
+/*
+ * test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+#include <stdio.h>
+
+// --------------------------------------------------------- //
+// checks of host tests: failed check is printed and counted, main returns
+// TEST_RESULT() -> exit code 1 if any check failed
+static int test_failures;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) \
+		{ \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			test_failures++; \
+		} \
+	} while (0)
+
+#define CHECK_EQ(a, b) \
+	do { \
+		long long check_a = (long long)(a), check_b = (long long)(b); \
+		if (check_a != check_b) \
+		{ \
+			printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, check_a, check_b); \
+			test_failures++; \
+		} \
+	} while (0)
+
+#define TEST_RESULT() \
+	(printf("%-24s %s\n", __FILE__, test_failures ? "FAILED" : "OK"), test_failures ? 1 : 0)
+
+#endif /* HOST_TEST_H_ */
@@ -0,0 +1,107 @@
+/*
+ * test_backends.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Cross-check of compensation back ends (int32, int64, float) through the
+// common interface bme280_compensate() across the whole raw domain:
+// every 20-bit adc_T, every 20-bit adc_P and every 16-bit adc_H at
+// temperatures from -39 to 81 degree. Values are compared where sensor
+// works (300 - 1100 hPa for pressure), maximum differences are printed.
+// Division by zero has to be reported by all back ends. Float pressure
+// is clamped to 300 - 1100 hPa for every raw value.
+#include <stdlib.h>
+#include "test.h"
+#include "bench.h"
+
+#define ADC_RANGE			(1L << 20)		// 20-bit temperature and pressure
+#define ADC_H_RANGE			(1L << 16)		// 16-bit humidity
+#define T_STEPS				25				// temperatures of pressure and humidity sweeps
+#define P_MIN				(30000UL << 8)	// x 1/256 Pa
+#define P_MAX				(110000UL << 8)
+
+// tolerances between back ends
+#define T_TOLERANCE			1				// x 0,01 degree (rounding of float)
+#define P_INT32_TOLERANCE	(8 << 8)		// x 1/256 Pa, Bosch 32-bit formula differs from 64-bit one by up to ~6 Pa
+#define P_FLOAT_TOLERANCE	(2 << 8)		// x 1/256 Pa, single precision
+#define H_TOLERANCE			102				// x 1/1024 %, 0,1 %
+
+static BME280 bme;
+
+int main(void)
+{
+	static const uint8_t backends[] = {BME280_BACKEND_INT32, BME280_BACKEND_INT64, BME280_BACKEND_FLOAT};
+	BME280_TPH tph[3];
+	int32_t adc_T_steps[T_STEPS], t_fine, diff, max_T = 0, max_H = 0;
+	int32_t max_P32 = 0, max_Pf = 0;
+	uint32_t compared_P = 0, compared_H = 0, float_outside = 0;
+	uint8_t result[3];
+
+	bench_sensor(&bme);
+
+	// ----- temperature: every adc_T -----
+	for (int32_t adc_T = 0; adc_T < ADC_RANGE; adc_T++)
+	{
+		for (uint8_t b = 0; b < 3; b++) bme280_compensate(backends[b], &bme.calib, adc_T, 415148, 27000, &tph[b]);
+
+		CHECK_EQ(tph[1].temperature, tph[0].temperature);
+		diff = abs(tph[2].temperature - tph[0].temperature);
+		if (diff > max_T) max_T = diff;
+	}
+	CHECK(max_T <= T_TOLERANCE);
+
+	// adc_T of temperatures -39 .. 81 degree in steps of 5 degree, inside of clamped range
+	for (int32_t adc_T = 0, k = 0; (adc_T < ADC_RANGE) && (k < T_STEPS); adc_T++)
+	{
+		if (bme280_compensate_T(&bme.calib, adc_T, &t_fine) >= -3900 + k * 500) adc_T_steps[k++] = adc_T;
+	}
+	CHECK_EQ(bme280_compensate_T(&bme.calib, adc_T_steps[T_STEPS - 1], &t_fine), 8100);
+
+	// ----- pressure and humidity: every adc_P and adc_H at every temperature -----
+	for (uint8_t k = 0; k < T_STEPS; k++)
+	{
+		for (int32_t adc = 0; adc < ADC_RANGE; adc++)
+		{
+			for (uint8_t b = 0; b < 3; b++)
+				result[b] = bme280_compensate(backends[b], &bme.calib, adc_T_steps[k], adc, adc & (ADC_H_RANGE - 1), &tph[b]);
+
+			if ((tph[2].pressure < P_MIN) || (tph[2].pressure > P_MAX)) float_outside++;
+
+			if ((tph[1].pressure >= P_MIN) && (tph[1].pressure <= P_MAX))
+			{
+				CHECK_EQ(result[0] | result[1] | result[2], 0);
+				diff = abs((int32_t)(tph[0].pressure - tph[1].pressure));
+				if (diff > max_P32) max_P32 = diff;
+				diff = abs((int32_t)(tph[2].pressure - tph[1].pressure));
+				if (diff > max_Pf) max_Pf = diff;
+				compared_P++;
+			}
+
+			if (adc < ADC_H_RANGE)
+			{
+				CHECK_EQ(tph[1].humidity, tph[0].humidity);
+				diff = abs((int32_t)(tph[2].humidity - tph[0].humidity));
+				if (diff > max_H) max_H = diff;
+				compared_H++;
+			}
+		}
+	}
+	CHECK(compared_P > T_STEPS * 100000);
+	CHECK(max_P32 <= P_INT32_TOLERANCE);
+	CHECK(max_Pf <= P_FLOAT_TOLERANCE);
+	CHECK(max_H <= H_TOLERANCE);
+	CHECK_EQ(float_outside, 0);
+
+	// ----- dig_P1 = 0: division by zero in all back ends -----
+	bme.coef.dig_P1 = 0;
+	bme280_prepare_calibration(&bme.coef, &bme.calib);
+	for (uint8_t b = 0; b < 3; b++) CHECK_EQ(bme280_compensate(backends[b], &bme.calib, 519888, 415148, 27000, &tph[b]), 1);
+
+	printf("backends: max difference to int64 / int32: T float %d x 0,01 C, P int32 %.2f Pa, P float %.2f Pa (%u values), H float %.3f %% (%u values)\n",
+		   max_T, max_P32 / 256.0, max_Pf / 256.0, compared_P, max_H / 1024.0, compared_H);
+
+	return TEST_RESULT();
+}
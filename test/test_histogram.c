@@ -0,0 +1,98 @@
+/*
+ * test_histogram.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// HISTOGRAM: value goes to bin of its significant bits, values from 2^24
+// to the last bin, count / min / max / sum are exact, percentile is upper
+// bound of bin limited to max. Report is compared as text, values over
+// 2^31 (e.g. sum of 64-bit mean, long intervals, cycles) are printed
+// whole - not masked to 31 bits. The same for PROFILE report.
+#include <string.h>
+#include "test.h"
+#include "HISTOGRAM/HISTOGRAM.h"
+#include "PROFILE/PROFILE.h"
+
+static char text[1024];
+static uint16_t text_len;
+
+static void print(const char *str)
+{
+	uint16_t len = strlen(str);
+
+	if (text_len + len >= sizeof(text)) len = sizeof(text) - 1 - text_len;
+	memcpy(&text[text_len], str, len);
+	text_len += len;
+	text[text_len] = 0;
+}
+
+static void clear(void)
+{
+	text_len = 0;
+	text[0] = 0;
+}
+
+int main(void)
+{
+	static const uint32_t values[] = {0, 1, 5, 100, 3000000000u};
+	HISTOGRAM hist;
+
+	// ----- empty -----
+	histogram_reset(&hist);
+	CHECK_EQ(histogram_percentile(&hist, 500), 0);
+	clear();
+	histogram_report(&hist, "empty ", print);
+	CHECK(!strcmp(text, "empty 0\n\r \n\r"));
+
+	// ----- bins by significant bits -----
+	for (uint32_t bit = 0; bit < 32; bit++)
+	{
+		histogram_reset(&hist);
+		histogram_add(&hist, 1UL << bit);
+		CHECK_EQ(hist.bins[(bit + 1 < HISTOGRAM_BINS - 1) ? bit + 1 : HISTOGRAM_BINS - 1], 1);
+		histogram_add(&hist, (2UL << bit) - 1);			// the highest value of the same bin
+		CHECK_EQ(hist.bins[(bit + 1 < HISTOGRAM_BINS - 1) ? bit + 1 : HISTOGRAM_BINS - 1], 2);
+	}
+	histogram_reset(&hist);
+	histogram_add(&hist, 0);
+	CHECK_EQ(hist.bins[0], 1);
+
+	// ----- exact statistics, percentile by bins -----
+	histogram_reset(&hist);
+	for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) histogram_add(&hist, values[i]);
+	CHECK_EQ(hist.count, 5);
+	CHECK_EQ(hist.min, 0);
+	CHECK_EQ(hist.max, 3000000000u);
+	CHECK(hist.sum == 3000000106ULL);
+	CHECK_EQ(histogram_percentile(&hist, 0), 0);			// the first sample: bin 0
+	CHECK_EQ(histogram_percentile(&hist, 500), 7);			// the 3rd sample (5): bin < 2^3
+	CHECK_EQ(histogram_percentile(&hist, 800), 127);		// the 4th sample (100): bin < 2^7
+	CHECK_EQ(histogram_percentile(&hist, 990), 3000000000u);	// the last bin: max
+
+	histogram_reset(&hist);
+	histogram_add(&hist, 3);
+	histogram_add(&hist, 2);
+	CHECK_EQ(histogram_percentile(&hist, 1000), 3);			// bound of bin (3) isn't above max
+
+	// ----- report: values over 2^31 are printed whole -----
+	histogram_reset(&hist);
+	for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) histogram_add(&hist, values[i]);
+	clear();
+	histogram_report(&hist, "interval ", print);
+	CHECK(!strcmp(text, "interval 5 / 0 / 600000021 / 3000000000 / 3000000000 / 7 / 3000000000\n\r"
+						"  <2^0:1 <2^1:1 <2^3:1 <2^7:1 >=2^24:1\n\r"));
+
+	// ----- PROFILE report -----
+	PROFILE_Reset();
+	PROFILE_Add(PROFILE_READ, 3000000000u);
+	PROFILE_Add(PROFILE_READ, 4000000000u);
+	clear();
+	PROFILE_Report(print);
+	CHECK(!strcmp(text, "\n\rstage        count / min / mean / max [" PROFILE_UNIT "]\n\r"
+						"read        2 / 3000000000 / 3500000000 / 4000000000\n\r"));
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,184 @@
+/*
+ * test_i2c.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// I2C1 interrupt driver against simulated BME280 slave: configuration,
+// queued transactions, NACK of address and data, arbitration loss, SDA held
+// low by slave (timeout and bus recovery), blocking calls from interrupt
+// and with interrupts masked, transactions queued from interrupt while the
+// main loop waits for its own transaction.
+#include "test.h"
+#include "host_i2c.h"
+#include "CLOCK/CLOCK.h"
+#include "TIMER/TIMER.h"
+
+static BME280 sensor;
+static BME280_SIM sim;
+static uint8_t isr_chip_id, isr_raw[BME280_DATA_SIZE];
+static volatile I2C_STATUS isr_status;
+static volatile uint8_t done_count;
+static I2C_STATUS done_status[I2C_QUEUE_SIZE];
+static uint32_t isr_queued, isr_full, isr_done;
+
+static void read_done(I2C_STATUS status)
+{
+	if (done_count < I2C_QUEUE_SIZE) done_status[done_count] = status;
+	done_count++;
+}
+
+static void isr_read_done(I2C_STATUS status)
+{
+	if (status == i2c_ok) isr_done++;
+}
+
+/****************************************************************************/
+/*      timer interrupt: blocking read is polled inside of handler			*/
+/****************************************************************************/
+static void timer_blocking_read(void)
+{
+	isr_status = I2C_READ(BME280_ADDR, 0xD0, 1, &isr_chip_id);
+}
+
+/****************************************************************************/
+/*      timer interrupt queues read, main loop waits for its own one		*/
+/****************************************************************************/
+static void timer_queue_read(void)
+{
+	if (I2C_READ_IT(BME280_ADDR, 0xF7, BME280_DATA_SIZE, isr_raw, isr_read_done) == i2c_ok) isr_queued++;
+	else isr_full++;
+}
+
+int main(void)
+{
+	uint8_t raw[BME280_CALIB1_SIZE], chip_id = 0, ctrl = 0, result;
+	uint8_t reads[I2C_QUEUE_SIZE][BME280_DATA_SIZE];
+	uint64_t start_ns;
+	uint32_t conversion;
+
+	CLOCK_Conf();
+	TIMER_Conf();
+	I2C_Conf(4000);								// 400 kHz
+
+	BME280_Sim_Init(&sim, 0, 0, 0);
+	host_i2c_attach(BME280_ADDR, &sim);
+	BME280_Init_I2C(&sensor, BME280_ADDR);
+
+	// ----- configuration and calibration by blocking transactions -----
+	do
+	{
+		result = BME280_Conf(&sensor);
+		host_run_for_us(1000);
+	}
+	while (result == 3);
+	CHECK_EQ(result, 0);
+	CHECK_EQ(sensor.err_conf, 0);
+	CHECK_EQ(sensor.coef.dig_T1, 27504);
+	CHECK_EQ(sensor.coef.dig_P9, 6000);
+	CHECK_EQ(sensor.coef.dig_H2, 370);
+
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xD0, 1, &chip_id), i2c_ok);
+	CHECK_EQ(chip_id, BME280_SIM_CHIP_ID);
+
+	// ----- write and read back -----
+	ctrl = 0x05;
+	CHECK_EQ(I2C_WRITE(BME280_ADDR, 0xF2, 1, &ctrl), i2c_ok);
+	ctrl = 0;
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xF2, 1, &ctrl), i2c_ok);
+	CHECK_EQ(ctrl, 0x05);
+	ctrl = 0x01;
+	CHECK_EQ(I2C_WRITE(BME280_ADDR, 0xF2, 1, &ctrl), i2c_ok);
+
+	// ----- forced conversion and data read by sensor transport -----
+	conversion = BME280_Trigger(&sensor);
+	host_run_for_us(conversion);
+	BME280_read_data(&sensor, 0xF7, BME280_DATA_SIZE, sensor.raw);
+	CHECK_EQ(BME280_Calculate(&sensor), 0);
+	CHECK_EQ(sensor.temperature, 2508);
+
+	// ----- queue: transactions run one after another, full queue is rejected -----
+	done_count = 0;
+	for (uint8_t i = 0; i < I2C_QUEUE_SIZE - 1; i++)
+		CHECK_EQ(I2C_READ_IT(BME280_ADDR, 0xF7, BME280_DATA_SIZE, reads[i], read_done), i2c_ok);
+	CHECK_EQ(I2C_READ_IT(BME280_ADDR, 0xF7, BME280_DATA_SIZE, reads[I2C_QUEUE_SIZE - 1], read_done), i2c_queue_full);
+	host_run_for_us(3000);
+	CHECK_EQ(done_count, I2C_QUEUE_SIZE - 1);
+	for (uint8_t i = 0; i < I2C_QUEUE_SIZE - 1; i++)
+	{
+		CHECK_EQ(done_status[i], i2c_ok);
+		CHECK(memcmp(reads[i], sensor.raw, BME280_DATA_SIZE) == 0);
+	}
+
+	// ----- NACK of address, NACK of data, arbitration loss; next transaction is fine -----
+	host_i2c_fault(HOST_I2C_NACK_ADDRESS);
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xD0, 1, &chip_id), i2c_nack);
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xD0, 1, &chip_id), i2c_ok);
+
+	host_i2c_fault(HOST_I2C_NACK_DATA);
+	ctrl = 0x03;
+	CHECK_EQ(I2C_WRITE(BME280_ADDR, 0xF2, 1, &ctrl), i2c_nack);
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xF2, 1, &ctrl), i2c_ok);
+	CHECK_EQ(ctrl, 0x01);										// dropped write
+
+	CHECK_EQ(I2C_READ(BME280_ADDR & 0xFE, 0xD0, 1, &chip_id), i2c_ok);
+	CHECK_EQ(I2C_READ(0xA0, 0xD0, 1, &chip_id), i2c_nack);		// no device at this address
+
+	host_i2c_fault(HOST_I2C_ARBITRATION);
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xD0, 1, &chip_id), i2c_arbitration_lost);
+	CHECK_EQ(host_i2c_stats.arbitration, 1);
+	chip_id = 0;
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xD0, 1, &chip_id), i2c_ok);
+	CHECK_EQ(chip_id, BME280_SIM_CHIP_ID);
+
+	// ----- SDA held low: transaction times out, bus is recovered -----
+	host_i2c_fault(HOST_I2C_SDA_STUCK);
+	start_ns = host_now_ns;
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xD0, 1, &chip_id), i2c_timeout);
+	CHECK(host_now_ns - start_ns >= (I2C_TIMEOUT_MS - 1) * 1000000ULL);		// deadline has 1 ms resolution
+	CHECK(host_now_ns - start_ns <= (I2C_TIMEOUT_MS + 2) * 1000000ULL);
+	CHECK_EQ(host_i2c_stats.recoveries, 1);
+	chip_id = 0;
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xD0, 1, &chip_id), i2c_ok);
+	CHECK_EQ(chip_id, BME280_SIM_CHIP_ID);
+
+	// ----- blocking read with interrupts masked: state machine is polled -----
+	chip_id = 0;
+	__disable_irq();
+	CHECK_EQ(I2C_READ(BME280_ADDR, 0xD0, 1, &chip_id), i2c_ok);
+	__enable_irq();
+	CHECK_EQ(chip_id, BME280_SIM_CHIP_ID);
+
+	// ----- blocking read from timer interrupt: I2C interrupts can't preempt it, state machine is polled -----
+	isr_status = i2c_busy;
+	TIMER_Start_Oneshot(100, timer_blocking_read);
+	host_run_for_us(200);
+	CHECK_EQ(isr_status, i2c_ok);
+	CHECK_EQ(isr_chip_id, BME280_SIM_CHIP_ID);
+
+	// ----- interrupt queues reads at different moments of blocking transactions of main loop -----
+	for (uint32_t i = 0; i < 200; i++)
+	{
+		TIMER_Start_Oneshot(10 + (i % 97), timer_queue_read);
+
+		while (TIMER_Busy())
+		{
+			CHECK_EQ(I2C_READ(BME280_ADDR, 0x88, BME280_CALIB1_SIZE, raw), i2c_ok);
+			CHECK_EQ(raw[0], 0x70);
+			host_advance_ns(3000);
+		}
+	}
+	host_run_for_us(3000);
+
+	CHECK_EQ(isr_queued + isr_full, 200);
+	CHECK_EQ(isr_done, isr_queued);
+	CHECK(isr_queued > 0);
+	CHECK(memcmp(isr_raw, sensor.raw, BME280_DATA_SIZE) == 0);
+
+	printf("i2c: %u starts, %u stops, %u bytes, %u nacks, interrupt reads queued %u / rejected %u\n",
+		   host_i2c_stats.starts, host_i2c_stats.stops, host_i2c_stats.bytes, host_i2c_stats.nacks, isr_queued, isr_full);
+
+	return TEST_RESULT();
+}
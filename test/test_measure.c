@@ -0,0 +1,158 @@
+/*
+ * test_measure.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Forced-mode pipeline on simulated time: data are read after the longest
+// conversion time, read which finds the bus busy (DMA transfer started by
+// other code) is retried after MEASURE_RETRY_US, and a bus which stays busy
+// longer than all retries gives missed reads instead of a silent skip.
+// PROFILE_READ probe spans every asynchronous read from its start to the
+// completion interrupt; attempts which find the bus busy aren't counted.
+#include "test.h"
+#include "host_spi.h"
+#include "CLOCK/CLOCK.h"
+#include "MEASURE/MEASURE.h"
+
+#define SENSORS		2
+
+static BME280 sensors[SENSORS];
+static BME280_SIM sims[SENSORS];
+static uint8_t hog_buf[BME280_CALIB1_SIZE];
+static uint32_t ready[SENSORS], hog_transfers, hog_limit;
+
+static void data_ready(BME280 *bme)
+{
+	ready[bme - sensors]++;
+}
+
+/****************************************************************************/
+/*      other user of SPI: every finished transfer starts the next one		*/
+/*      up to hog_limit, so the bus is busy almost all the time				*/
+/****************************************************************************/
+static void hog_done(void)
+{
+	if (++hog_transfers < hog_limit)
+		BME280_read_data_DMA(&sensors[0], 0x88, BME280_CALIB1_SIZE, hog_buf, hog_done);
+}
+
+static void wait_cycle(void)
+{
+	while (MEASURE_Busy()) host_wfi();
+}
+
+int main(void)
+{
+	MEASURE_STATS stats;
+	MEASURE_LATENCY latency;
+	PROFILE_STAT read;
+	uint32_t cycle_us;
+	uint8_t result;
+
+	CLOCK_Conf();
+	MEASURE_Conf();
+	SPI_Conf();
+	MEASURE_Set_Callback(data_ready);
+
+	for (uint8_t n = 0; n < SENSORS; n++)
+	{
+		BME280_Sim_Init(&sims[n], 0, 0, 0);
+		host_spi_attach(GPIOB, n ? GPIO_Pin_1 : GPIO_Pin_0, &sims[n]);
+		BME280_Init_SPI(&sensors[n], GPIOB, n ? GPIO_Pin_1 : GPIO_Pin_0);
+		if (n) sensors[n].conf.osrs_t = sensors[n].conf.osrs_p = sensors[n].conf.osrs_h = BME280_oversampling_x2;
+
+		do
+		{
+			result = BME280_Conf(&sensors[n]);
+			host_run_for_us(1000);
+		}
+		while (result == 3);
+		CHECK_EQ(result, 0);
+		MEASURE_Register(&sensors[n]);
+	}
+	cycle_us = MEASURE_Cycle_Time();
+	PROFILE_Conf();
+	CHECK_EQ(cycle_us, bme280_compute_measure_time_us(max_time, &sensors[0].conf));
+
+	// ----- data are read after the longest conversion, not earlier -----
+	CHECK_EQ(MEASURE_Start(), 0);
+	CHECK_EQ(MEASURE_Start(), 1);
+	host_run_for_us(cycle_us - 1);
+	CHECK_EQ(ready[0] + ready[1], 0);
+	CHECK_EQ(MEASURE_Busy(), 1);
+	wait_cycle();
+	CHECK_EQ(ready[0], 1);
+	CHECK_EQ(ready[1], 1);
+
+	MEASURE_Latency(0, &latency, 1);
+	CHECK(latency.trigger_to_data.min >= cycle_us);
+	CHECK(latency.trigger_to_data.max <= cycle_us + 100);
+	MEASURE_Stats(&stats, 1);
+	CHECK_EQ(stats.cycles, 1);
+	CHECK_EQ(stats.reads, 2);
+	CHECK_EQ(stats.retries, 0);
+	CHECK_EQ(stats.missed, 0);
+	PROFILE_Get(PROFILE_READ, &read);
+	CHECK_EQ(read.count, 2);
+	CHECK(read.min > 0);
+
+	// ----- other transfer is in progress when timer expires: read is retried -----
+	MEASURE_Start();
+	host_run_for_us(cycle_us - 5);
+	hog_transfers = 0;
+	hog_limit = 1;
+	CHECK_EQ(BME280_read_data_DMA(&sensors[0], 0x88, BME280_CALIB1_SIZE, hog_buf, hog_done), 0);
+	wait_cycle();
+	CHECK_EQ(hog_transfers, 1);
+	CHECK_EQ(ready[0], 2);
+	CHECK_EQ(ready[1], 2);
+
+	MEASURE_Stats(&stats, 1);
+	CHECK_EQ(stats.reads, 2);
+	CHECK(stats.retries >= 1);
+	CHECK_EQ(stats.missed, 0);
+	MEASURE_Latency(0, &latency, 1);
+	CHECK(latency.trigger_to_data.max >= cycle_us + MEASURE_RETRY_US);		// sample waited for the bus
+	PROFILE_Get(PROFILE_READ, &read);
+	CHECK_EQ(read.count, 4);
+
+	// ----- bus stays busy longer than all retries: both sensors are missed -----
+	MEASURE_Start();
+	host_run_for_us(cycle_us - 5);
+	hog_transfers = 0;
+	hog_limit = 2 * SENSORS * (MEASURE_READ_RETRIES + 1) * MEASURE_RETRY_US / 20;		// transfer takes ~24 us
+	BME280_read_data_DMA(&sensors[0], 0x88, BME280_CALIB1_SIZE, hog_buf, hog_done);
+	wait_cycle();
+	while (SPI_DMA_Busy()) host_wfi();
+	CHECK_EQ(hog_transfers, hog_limit);
+	CHECK_EQ(ready[0], 2);
+	CHECK_EQ(ready[1], 2);
+
+	MEASURE_Stats(&stats, 1);
+	CHECK_EQ(stats.cycles, 1);
+	CHECK_EQ(stats.reads, 0);
+	CHECK_EQ(stats.retries, SENSORS * MEASURE_READ_RETRIES);
+	CHECK_EQ(stats.missed, SENSORS);
+	PROFILE_Get(PROFILE_READ, &read);
+	CHECK_EQ(read.count, 4);
+
+	// ----- the next cycle is normal again -----
+	CHECK_EQ(MEASURE_Start(), 0);
+	wait_cycle();
+	CHECK_EQ(ready[0], 3);
+	CHECK_EQ(ready[1], 3);
+	MEASURE_Stats(&stats, 0);
+	CHECK_EQ(stats.reads, 2);
+	CHECK_EQ(stats.missed, 0);
+	CHECK_EQ(host_spi_stats.collisions, 0);
+	PROFILE_Get(PROFILE_READ, &read);
+	CHECK_EQ(read.count, 6);
+
+	printf("measure: cycle %u us, %u hog transfers, retries %u x %u us before miss\n",
+		   (unsigned)cycle_us, hog_transfers, MEASURE_READ_RETRIES, MEASURE_RETRY_US);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,121 @@
+/*
+ * test_multi.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Four sensors on SPI1 (chip selects PB0..PB3), each with its own simulator,
+// trace and oversampling, measured concurrently by the forced-mode pipeline:
+// every cycle all of them are triggered at once and read one after another
+// from interrupts. Data of every sensor have to come from its own simulator
+// and its own context only.
+#include "test.h"
+#include "host_spi.h"
+#include "CLOCK/CLOCK.h"
+#include "MEASURE/MEASURE.h"
+#include "BME280/BME280_compensate.h"
+
+#define SENSORS		4
+#define TRACE_LEN	8
+#define CYCLES		200
+
+static BME280 sensors[SENSORS];
+static BME280_SIM sims[SENSORS];
+static BME280_SIM_SAMPLE traces[SENSORS][TRACE_LEN];
+static uint32_t ready[SENSORS], mismatches;
+static const uint16_t cs_pins[SENSORS] = {GPIO_Pin_0, GPIO_Pin_1, GPIO_Pin_2, GPIO_Pin_3};
+static const uint8_t oversampling[SENSORS] = {BME280_oversampling_x1, BME280_oversampling_x2, BME280_oversampling_x4, BME280_oversampling_x16};
+
+/****************************************************************************/
+/*      data of sensor (interrupt) have to be the last sample published		*/
+/*      by its own simulator												*/
+/****************************************************************************/
+static void data_ready(BME280 *bme)
+{
+	uint8_t n = bme - sensors;
+	BME280_SIM *sim = &sims[n];
+	const BME280_SIM_SAMPLE *expected = &traces[n][(sim->trace_index + TRACE_LEN - 1) % TRACE_LEN];
+	int32_t adc_T, adc_P, adc_H;
+
+	bme280_unpack_raw(bme->raw, &adc_T, &adc_P, &adc_H);
+	if ((adc_T != (int32_t)expected->adc_T) || (adc_P != (int32_t)expected->adc_P) || (adc_H != expected->adc_H)) mismatches++;
+	ready[n]++;
+}
+
+int main(void)
+{
+	int32_t temperature[SENSORS];
+	uint8_t result;
+
+	CLOCK_Conf();
+	MEASURE_Conf();
+	SPI_Conf();
+	MEASURE_Set_Callback(data_ready);
+
+	for (uint8_t n = 0; n < SENSORS; n++)
+	{
+		for (uint8_t k = 0; k < TRACE_LEN; k++)
+		{
+			traces[n][k].adc_T = 519888 + n * 8000 + k * 100;
+			traces[n][k].adc_P = 415148 - n * 4000 + k * 50;
+			traces[n][k].adc_H = 27000 + n * 1000 + k * 10;
+		}
+
+		BME280_Sim_Init(&sims[n], traces[n], TRACE_LEN, 0);
+		host_spi_attach(GPIOB, cs_pins[n], &sims[n]);
+		BME280_Init_SPI(&sensors[n], GPIOB, cs_pins[n]);
+		sensors[n].conf.osrs_t = sensors[n].conf.osrs_p = sensors[n].conf.osrs_h = oversampling[n];
+
+		do
+		{
+			result = BME280_Conf(&sensors[n]);
+			host_run_for_us(1000);
+		}
+		while (result == 3);
+		CHECK_EQ(result, 0);
+		CHECK_EQ(MEASURE_Register(&sensors[n]), 0);
+	}
+	CHECK_EQ(MEASURE_Register(&sensors[0]), 1);
+
+	// ----- each context keeps its own configuration -----
+	for (uint8_t n = 0; n < SENSORS; n++)
+	{
+		CHECK_EQ(sensors[n].shadow.reg[1] >> 5, oversampling[n]);
+		CHECK_EQ(sims[n].regs[0xF4] >> 5, oversampling[n]);
+	}
+	CHECK_EQ(MEASURE_Cycle_Time(), bme280_compute_measure_time_us(max_time, &sensors[3].conf));
+
+	// ----- concurrent cycles -----
+	for (uint32_t cycle = 0; cycle < CYCLES; cycle++)
+	{
+		CHECK_EQ(MEASURE_Start(), 0);
+		CHECK_EQ(MEASURE_Start(), 1);
+		while (MEASURE_Busy()) host_wfi();
+
+		for (uint8_t n = 0; n < SENSORS; n++)
+		{
+			CHECK_EQ(sensors[n].data_ready, 1);
+			CHECK_EQ(BME280_Calculate(&sensors[n]), 0);
+			temperature[n] = sensors[n].temperature;
+		}
+
+		// higher raw temperature of every next sensor
+		for (uint8_t n = 1; n < SENSORS; n++) CHECK(temperature[n] > temperature[n - 1]);
+	}
+
+	for (uint8_t n = 0; n < SENSORS; n++)
+	{
+		CHECK_EQ(ready[n], CYCLES);
+		CHECK(sims[n].conversions >= CYCLES);
+	}
+	CHECK_EQ(mismatches, 0);
+	CHECK_EQ(host_spi_stats.collisions, 0);
+	CHECK_EQ(host_spi_stats.unselected, 0);
+
+	printf("multi: %u sensors, %u cycles of %u us, temperatures %d %d %d %d\n",
+		   SENSORS, CYCLES, (unsigned)MEASURE_Cycle_Time(), (int)temperature[0], (int)temperature[1], (int)temperature[2], (int)temperature[3]);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,168 @@
+/*
+ * test_power.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Idle policy of POWER with STOP mode on model of RTC, EXTI and PWR
+// (host_power.c), scheduler in tickless mode on CLOCK: periodic task of
+// 1 ms CPU time every 100 ms puts MCU into STOP mode between runs, awake
+// and sleep time add up to elapsed time, duty cycle is 1 %, clock follows
+// real time across STOP periods and task keeps its period. Short timers
+// and transmit in progress are slept by WFI, edge on other EXTI line ends
+// STOP early without loss of time. Two hours of 1 s period give sleep time
+// over 2^32 us, which 32-bit counters couldn't hold.
+#include <stdlib.h>
+#include "test.h"
+#include "host_usart.h"
+#include "host_power.h"
+#include "POWER/POWER.h"
+
+#define TASK_CONTROL		0
+#define EV_TICK				(1UL << 0)
+#define TASK_RUN_NS			1000000		// CPU time of task
+#define CLOCK_ERROR_US		1000		// clock against simulated time
+#define ACCOUNT_ERROR_US	(CLOCK_ERROR_US + TASK_RUN_NS / 1000)	// task which runs at the end isn't counted as awake yet
+#define RTC_TICK_US			(1000000 / POWER_RTC_HZ + 1)
+
+static uint32_t period_ms, runs;
+static uint64_t start_ns, max_latency_ns;
+static int64_t clock_start_error;
+
+static void task_control(uint32_t events)
+{
+	uint64_t expected = start_ns + (uint64_t)(runs + 1) * period_ms * 1000000;
+	uint64_t latency = (host_now_ns > expected) ? host_now_ns - expected : expected - host_now_ns;
+
+	(void)events;
+	if (latency > max_latency_ns) max_latency_ns = latency;
+	runs++;
+	host_advance_ns(TASK_RUN_NS);
+}
+
+/****************************************************************************/
+/*      main loop of SCHEDULER_Run() with POWER_Idle() as idle hook			*/
+/****************************************************************************/
+static void run_until(uint64_t end_ns)
+{
+	while (host_now_ns < end_ns)
+	{
+		if (SCHEDULER_Dispatch()) continue;
+
+		__disable_irq();
+		POWER_Idle();
+		__enable_irq();
+	}
+}
+
+static void start_period(uint32_t ms)
+{
+	SCHEDULER_Timer_Stop(0);
+	while (SCHEDULER_Dispatch());						// expiry of previous period
+	period_ms = ms;
+	runs = 0;
+	max_latency_ns = 0;
+	start_ns = host_now_ns - host_now_ns % 1000000;		// timers are counted in whole ms of clock
+	SCHEDULER_Timer_Start(0, TASK_CONTROL, EV_TICK, ms);
+	POWER_Reset_Stats();
+	host_power_reset();
+	clock_start_error = (int64_t)CLOCK_Now_us() - (int64_t)(host_now_ns / 1000);
+}
+
+// drift of clock against simulated time from start of period
+static int64_t clock_error_us(void)
+{
+	return (int64_t)CLOCK_Now_us() - (int64_t)(host_now_ns / 1000) - clock_start_error;
+}
+
+int main(void)
+{
+	POWER_STATS power;
+	uint64_t elapsed_us;
+	uint32_t tx_start;
+
+	host_reset();
+	host_usart_attach();
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+	CLOCK_Conf();
+	UART_Conf(UART_BAUD);
+	POWER_Conf();
+	SCHEDULER_Set_Time_Source(CLOCK_Now_ms);
+	CHECK_EQ(SCHEDULER_Register(TASK_CONTROL, task_control), 0);
+	CHECK_EQ(host_nvic_priority[TIM3_IRQn], CLOCK_IRQ_PRIORITY << 4);		// group was set before CLOCK_Conf
+
+	// ----- 100 ms period: STOP mode between runs -----
+	start_period(100);
+	run_until(start_ns + 10000 * 1000000ULL);
+	POWER_Stats(&power);
+	elapsed_us = (host_now_ns - start_ns) / 1000;
+
+	printf("stop: %u runs, %u stops, %u WFI, awake %llu us, sleep %llu us, duty %u / 1000, clock error %lld us\n",
+		   runs, power.stops, power.sleeps, (unsigned long long)power.awake_us, (unsigned long long)power.sleep_us,
+		   POWER_Duty_Cycle(&power), (long long)clock_error_us());
+	CHECK(runs >= 99);
+	CHECK(power.stops >= runs - 1);
+	CHECK_EQ(power.stops, host_power_stats.stops);
+	CHECK_EQ(host_power_stats.alarms, host_power_stats.stops);
+	CHECK(llabs((long long)(power.awake_us - (uint64_t)runs * TASK_RUN_NS / 1000)) <= 1000);
+	CHECK(llabs((long long)(power.awake_us + power.sleep_us - elapsed_us)) <= ACCOUNT_ERROR_US);
+	CHECK(host_power_stats.stop_ns / 1000 <= power.sleep_us);
+	CHECK(llabs(clock_error_us()) <= CLOCK_ERROR_US);
+	CHECK(max_latency_ns <= 2000000);
+	CHECK(POWER_Duty_Cycle(&power) >= 9 && POWER_Duty_Cycle(&power) <= 11);
+
+	// ----- 2 ms period: shorter than POWER_STOP_MIN_MS, only WFI -----
+	start_period(2);
+	run_until(start_ns + 1000 * 1000000ULL);
+	POWER_Stats(&power);
+	CHECK(runs >= 499);
+	CHECK_EQ(power.stops, 0);
+	CHECK_EQ(host_power_stats.stops, 0);
+	CHECK(power.sleeps >= runs - 1);
+	CHECK(llabs(clock_error_us()) <= CLOCK_ERROR_US);
+
+	// ----- transmit in progress: WFI up to the last byte, then STOP -----
+	start_period(100);
+	tx_start = host_usart_tx_len;
+	CHECK_EQ(uart_write("transmit is not lost in STOP mode\r\n", 35), 35);
+	run_until(start_ns + 1000 * 1000000ULL);
+	POWER_Stats(&power);
+	CHECK_EQ(host_usart_tx_len - tx_start, 35);
+	CHECK_EQ(host_power_stats.tx_busy, 0);
+	CHECK(power.sleeps >= 1);
+	CHECK(power.stops >= runs - 1);
+
+	// ----- edge on other EXTI line ends STOP early, time isn't lost -----
+	start_period(100);
+	host_power_wake_at(start_ns + 30 * 1000000ULL);
+	host_power_wake_at(start_ns + 250 * 1000000ULL);
+	run_until(start_ns + 1000 * 1000000ULL);
+	POWER_Stats(&power);
+	elapsed_us = (host_now_ns - start_ns) / 1000;
+	CHECK_EQ(host_power_stats.external, 2);
+	CHECK(host_power_stats.stops >= runs + 2 - 1);
+	CHECK(runs >= 9);
+	CHECK(max_latency_ns <= 2000000);
+	CHECK(llabs((long long)(power.awake_us + power.sleep_us - elapsed_us)) <= ACCOUNT_ERROR_US + 2 * RTC_TICK_US);
+	CHECK(llabs(clock_error_us()) <= CLOCK_ERROR_US + 2 * RTC_TICK_US);		// part of RTC tick is lost by early wake-up
+
+	// ----- two hours of 1 s period: counters over 32 bits -----
+	start_period(1000);
+	run_until(start_ns + 2 * 3600 * 1000000000ULL);
+	POWER_Stats(&power);
+	elapsed_us = (host_now_ns - start_ns) / 1000;
+
+	printf("long: %u runs, %u stops, awake %llu us, sleep %llu us, duty %u / 1000, clock error %lld us\n",
+		   runs, power.stops, (unsigned long long)power.awake_us, (unsigned long long)power.sleep_us,
+		   POWER_Duty_Cycle(&power), (long long)clock_error_us());
+	CHECK(runs >= 2 * 3600 - 1);
+	CHECK(power.sleep_us > 0xFFFFFFFFULL);
+	CHECK(llabs((long long)(power.awake_us + power.sleep_us - elapsed_us)) <= ACCOUNT_ERROR_US);
+	CHECK(llabs(clock_error_us()) <= CLOCK_ERROR_US);
+	CHECK(max_latency_ns <= 2000000);
+	CHECK(POWER_Duty_Cycle(&power) <= 1);
+
+	return TEST_RESULT();
+}
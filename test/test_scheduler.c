@@ -0,0 +1,192 @@
+/*
+ * test_scheduler.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Scheduler on simulated time: periodic task of the highest priority and
+// long background task of low priority, timers counted by 1 ms tick
+// (SysTick interrupt) and in tickless mode from ms clock with sleep up to
+// the nearest timer. Latency from timer expiry to dispatch and interval of
+// periodic task are collected in histograms: latency is bounded by run time
+// of background task (run to completion) plus one ms of timer resolution,
+// mean interval is the period and no expiry is lost. Deferred work
+// queued from interrupt runs before tasks.
+#include <stdlib.h>
+#include "test.h"
+#include "SCHEDULER/SCHEDULER.h"
+#include "HISTOGRAM/HISTOGRAM.h"
+
+#define TASK_CONTROL		0
+#define TASK_BACKGROUND		3
+#define EV_TICK				(1UL << 0)
+
+#define CONTROL_PERIOD		10			// ms
+#define BACKGROUND_PERIOD	7			// ms
+#define BACKGROUND_RUN_NS	2500000		// CPU time of background task
+#define DEFER_PERIOD		5			// ticks between deferred work items
+#define RUN_MS				10000
+
+static HISTOGRAM latency, interval;
+static uint64_t start_ns, last_ns, deferred_ns;
+static uint32_t control_runs, background_runs, ticks;
+static HISTOGRAM defer_latency;
+static int tick_event = -1;
+
+static void print(const char *str)
+{
+	fputs(str, stdout);
+}
+
+/****************************************************************************/
+/*      periodic task: latency to expected expiry, interval to last run		*/
+/****************************************************************************/
+static void task_control(uint32_t events)
+{
+	uint64_t expected = start_ns + (uint64_t)(control_runs + 1) * CONTROL_PERIOD * 1000000;
+
+	(void)events;
+	histogram_add(&latency, (uint32_t)((host_now_ns - expected) / 1000));
+	if (control_runs) histogram_add(&interval, (uint32_t)((host_now_ns - last_ns) / 1000));
+	last_ns = host_now_ns;
+	control_runs++;
+}
+
+static void task_background(uint32_t events)
+{
+	(void)events;
+	host_advance_ns(BACKGROUND_RUN_NS);		// interrupts are served, tasks wait
+	background_runs++;
+}
+
+static void deferred(void *arg)
+{
+	(void)arg;
+	histogram_add(&defer_latency, (uint32_t)((host_now_ns - deferred_ns) / 1000));
+}
+
+/****************************************************************************/
+/*      SysTick: 1 ms tick of scheduler, every DEFER_PERIOD tick defers work	*/
+/****************************************************************************/
+static void systick_handler(void)
+{
+	SCHEDULER_Tick();
+	if (++ticks % DEFER_PERIOD == 0)
+	{
+		deferred_ns = host_now_ns;
+		SCHEDULER_Defer(deferred, 0);
+	}
+}
+
+static void systick_event(void)
+{
+	tick_event = host_event_at(host_now_ns + 1000000, systick_event);
+	host_irq(systick_handler);
+}
+
+/****************************************************************************/
+/*      tickless: ms clock and wake-up at the nearest timer					*/
+/****************************************************************************/
+static uint32_t now_ms(void)
+{
+	return (uint32_t)((host_now_ns - start_ns) / 1000000);
+}
+
+static void wake_handler(void)
+{
+}
+
+static void wake_event(void)
+{
+	host_irq(wake_handler);
+}
+
+/****************************************************************************/
+/*      main loop of SCHEDULER_Run() up to end time, idle sleeps by WFI		*/
+/*      with interrupts masked; tickless idle schedules wake-up				*/
+/****************************************************************************/
+static void run_until(uint64_t end_ns, uint8_t tickless)
+{
+	uint32_t timeout;
+	int wake = -1;
+
+	while (host_now_ns < end_ns)
+	{
+		if (SCHEDULER_Dispatch()) continue;
+
+		__disable_irq();
+		timeout = SCHEDULER_Next_Timeout();
+		if (timeout)
+		{
+			if (tickless) wake = host_event_at(start_ns + ((uint64_t)now_ms() + timeout) * 1000000, wake_event);
+			host_wfi();
+			if (tickless) host_event_cancel(wake);
+		}
+		__enable_irq();
+	}
+}
+
+static void reset_stats(void)
+{
+	histogram_reset(&latency);
+	histogram_reset(&interval);
+	histogram_reset(&defer_latency);
+	control_runs = background_runs = 0;
+	start_ns = host_now_ns;
+}
+
+static void check_stats(const char *mode)
+{
+	printf("%s      count / min / mean / max / jitter / p50 / p99 [us]\n", mode);
+	histogram_report(&latency, "latency  ", print);
+	histogram_report(&interval, "interval ", print);
+
+	CHECK(control_runs >= RUN_MS / CONTROL_PERIOD - 1);				// no expiry is lost
+	CHECK(background_runs >= RUN_MS / BACKGROUND_PERIOD - 2);
+	CHECK(latency.max <= BACKGROUND_RUN_NS / 1000 + 1000);			// run to completion + timer resolution
+	CHECK(llabs((long long)(interval.sum / interval.count) - CONTROL_PERIOD * 1000) <= 10);	// no drift
+}
+
+int main(void)
+{
+	SCHEDULER_STATS stats;
+
+	host_reset();
+	CHECK_EQ(SCHEDULER_Register(TASK_CONTROL, task_control), 0);
+	CHECK_EQ(SCHEDULER_Register(TASK_BACKGROUND, task_background), 0);
+	CHECK_EQ(SCHEDULER_Register(TASK_CONTROL, task_background), 1);
+
+	// ----- 1 ms tick from SysTick -----
+	reset_stats();
+	systick_event();
+	SCHEDULER_Timer_Start(0, TASK_CONTROL, EV_TICK, CONTROL_PERIOD);
+	SCHEDULER_Timer_Start(1, TASK_BACKGROUND, EV_TICK, BACKGROUND_PERIOD);
+	run_until(start_ns + RUN_MS * 1000000ULL, 0);
+	check_stats("tick");
+
+	histogram_report(&defer_latency, "deferred ", print);
+	CHECK(defer_latency.count >= RUN_MS / DEFER_PERIOD - 1);
+	CHECK(defer_latency.max <= BACKGROUND_RUN_NS / 1000);				// work waits only for running task
+	SCHEDULER_Stats(&stats);
+	CHECK_EQ(stats.work_dropped, 0);
+	CHECK_EQ(stats.work_done, defer_latency.count);
+
+	// ----- tickless: timers from ms clock, CPU sleeps up to the nearest one -----
+	SCHEDULER_Timer_Stop(0);
+	SCHEDULER_Timer_Stop(1);
+	host_event_cancel(tick_event);
+	while (SCHEDULER_Dispatch());					// the last deferred work
+	ticks = 0;
+
+	reset_stats();
+	SCHEDULER_Set_Time_Source(now_ms);
+	SCHEDULER_Timer_Start(0, TASK_CONTROL, EV_TICK, CONTROL_PERIOD);
+	SCHEDULER_Timer_Start(1, TASK_BACKGROUND, EV_TICK, BACKGROUND_PERIOD);
+	run_until(start_ns + RUN_MS * 1000000ULL, 1);
+	check_stats("tickless");
+	CHECK_EQ(ticks, 0);
+
+	return TEST_RESULT();
+}
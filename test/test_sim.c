@@ -0,0 +1,196 @@
+/*
+ * test_sim.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Replay of raw-sample trace by simulated sensor (BME280_USE_SIM) connected
+// directly to driver, without bus: status bits after reset and during
+// conversion, forced conversions publish samples of trace in order and in
+// loop, data registers keep previous sample up to the end of conversion,
+// normal mode publishes one sample per cycle also after long time without
+// access, skipped channels read reset values. Reference pressure of
+// altitude out of sensor range is rejected. Compensation parameters are
+// read only after reset, verification only reads configuration back and
+// reports changed registers of forced mode as configuration error.
+#include "test.h"
+#include "CLOCK/CLOCK.h"
+#include "BME280/BME280_sim.h"
+#include "BME280/BME280_compensate.h"
+
+#define TRACE_LEN	5
+
+static BME280 sensor;
+static BME280_SIM sim;
+static const BME280_SIM_SAMPLE trace[TRACE_LEN] = {
+	{519888, 415148, 27000},		// datasheet example: 25.08 C
+	{520888, 416148, 27100},
+	{521888, 417148, 27200},
+	{522888, 418148, 27300},
+	{523888, 419148, 27400},
+};
+
+static uint8_t read_status(void)
+{
+	uint8_t status;
+
+	BME280_read_data(&sensor, 0xF3, 1, &status);
+	return status;
+}
+
+/****************************************************************************/
+/*      index of trace sample in data registers, -1 if it isn't any			*/
+/****************************************************************************/
+static int32_t sample_index(void)
+{
+	int32_t adc_T, adc_P, adc_H;
+
+	BME280_read_data(&sensor, 0xF7, BME280_DATA_SIZE, sensor.raw);
+	bme280_unpack_raw(sensor.raw, &adc_T, &adc_P, &adc_H);
+
+	for (int32_t k = 0; k < TRACE_LEN; k++)
+	{
+		if ((adc_T == (int32_t)trace[k].adc_T) && (adc_P == (int32_t)trace[k].adc_P) && (adc_H == trace[k].adc_H)) return k;
+	}
+	return -1;
+}
+
+int main(void)
+{
+	uint32_t conversion, cycle_us, start;
+	uint16_t index;
+	int32_t adc_T, adc_P, adc_H;
+	uint8_t result, osrs_p;
+
+	CLOCK_Conf();
+
+	BME280_Sim_Init(&sim, trace, TRACE_LEN, 0);
+	BME280_Init_Sim(&sensor, &sim);
+
+	// ----- NVM is copied after power-on: im_update bit -----
+	CHECK_EQ(read_status(), BMP280_IM_UPDATE_STATUS);
+	host_run_for_us(BME280_SIM_RESET_US);
+	CHECK_EQ(read_status(), 0);
+
+	do
+	{
+		result = BME280_Conf(&sensor);
+		host_run_for_us(1000);
+	}
+	while (result == 3);
+	CHECK_EQ(result, 0);
+	CHECK_EQ(sensor.coef.dig_T1, 27504);
+
+	// ----- forced conversions replay trace in order and in loop -----
+	host_run_for_us(100000);
+	CHECK_EQ(read_status(), 0);				// conversion started by configuration is finished
+	index = sim.trace_index;
+	start = sim.conversions;
+	for (uint16_t i = 0; i < 3 * TRACE_LEN; i++)
+	{
+		conversion = BME280_Trigger(&sensor);
+		CHECK_EQ(read_status() & BMP280_MEASURING_STATUS, BMP280_MEASURING_STATUS);
+		if (i) CHECK_EQ(sample_index(), (index + TRACE_LEN - 1) % TRACE_LEN);	// previous sample up to end of conversion
+
+		host_run_for_us(conversion);
+		CHECK_EQ(read_status(), 0);
+		CHECK_EQ(sample_index(), index);
+		index = (index + 1) % TRACE_LEN;
+	}
+	CHECK_EQ(sim.conversions - start, 3 * TRACE_LEN);
+
+	// ----- values of datasheet example -----
+	while (sim.trace_index != 1)
+	{
+		host_run_for_us(BME280_Trigger(&sensor));
+	}
+	BME280_read_data(&sensor, 0xF7, BME280_DATA_SIZE, sensor.raw);
+	CHECK_EQ(BME280_Calculate(&sensor), 0);
+	CHECK_EQ(sensor.temperature, 2508);
+
+	// ----- reference pressure: altitude 0 at measured pressure, out of range is rejected -----
+	CHECK_EQ(BME280_Set_Reference_Pressure(&sensor, sensor.preasure), 0);
+	CHECK_EQ(BME280_Calculate(&sensor), 0);
+	CHECK(abs(sensor.altitude) < 100);
+	CHECK_EQ(BME280_Set_Reference_Pressure(&sensor, 0), 1);
+	CHECK_EQ(BME280_Set_Reference_Pressure(&sensor, BME280_REFERENCE_MIN - 1), 1);
+	CHECK_EQ(BME280_Set_Reference_Pressure(&sensor, BME280_REFERENCE_MAX + 1), 1);
+	CHECK_EQ(BME280_Calculate(&sensor), 0);
+	CHECK(abs(sensor.altitude) < 100);				// previous reference is kept
+
+	// ----- no new conversion without trigger in forced mode -----
+	start = sim.conversions;
+	host_run_for_us(1000000);
+	CHECK_EQ(sim.conversions, start);
+	CHECK_EQ(sample_index(), 0);
+
+	// ----- skipped pressure: reset value of data registers -----
+	osrs_p = sensor.conf.osrs_p;
+	sensor.conf.osrs_p = 0;					// skipped
+	host_run_for_us(BME280_Trigger(&sensor));
+	BME280_read_data(&sensor, 0xF7, BME280_DATA_SIZE, sensor.raw);
+	bme280_unpack_raw(sensor.raw, &adc_T, &adc_P, &adc_H);
+	CHECK_EQ(adc_P, 0x80000);
+	CHECK_EQ(adc_T, (int32_t)trace[1].adc_T);
+	sensor.conf.osrs_p = osrs_p;
+
+	// ----- configuration without reset: nothing is written, calibration isn't read again -----
+	host_run_for_us(BME280_Trigger(&sensor));		// ctrl_meas with restored oversampling
+	start = sim.reads;
+	CHECK_EQ(BME280_Conf(&sensor), 0);
+	CHECK_EQ(sim.reads, start);
+
+	// ----- verification only reads back, changed register of forced mode is an error -----
+	start = sim.writes;
+	CHECK_EQ(BME280_Verify(&sensor), 0);
+	CHECK_EQ(sensor.err_conf, 0);
+	sim.regs[0xF5] ^= 0x04;					// filter changed behind the driver
+	CHECK_EQ(BME280_Verify(&sensor), 2);
+	CHECK_EQ(sensor.err_conf, config_reg);
+	sensor.err_conf = calib_reg;
+	CHECK_EQ(BME280_Verify(&sensor), 2);
+	CHECK_EQ(sensor.err_conf, both);
+	CHECK_EQ(sim.writes, start);
+	sensor.err_conf = 0;
+	CHECK_EQ(BME280_Conf(&sensor), 0);		// registers are written again
+	CHECK_EQ(sim.writes - start, 1);
+	CHECK_EQ(BME280_Verify(&sensor), 0);
+
+	// ----- normal mode: one sample every cycle, also after long time without access -----
+	BME280_Set_Normal_Mode(&sensor, BME280_STANDBY_MS_10, BME280_FILTER_OFF);
+	sensor.reset_done = 0;
+	sensor.coef.dig_T1 = 0;
+	do
+	{
+		result = BME280_Conf(&sensor);
+		host_run_for_us(1000);
+	}
+	while (result == 3);
+	CHECK_EQ(result, 0);
+	CHECK_EQ(sensor.coef.dig_T1, 27504);			// calibration is read again after reset
+	cycle_us = BME280_Cycle_Time_us(&sensor);
+
+	while (!(read_status() & BMP280_MEASURING_STATUS)) host_advance_ns(10000);
+	while (read_status() & BMP280_MEASURING_STATUS) host_advance_ns(10000);		// end of conversion
+	start = sim.conversions;
+	index = (sim.trace_index + TRACE_LEN - 1) % TRACE_LEN;
+	CHECK_EQ(sample_index(), index);
+
+	for (uint16_t i = 1; i <= 2 * TRACE_LEN; i++)
+	{
+		host_run_for_us(cycle_us);
+		CHECK_EQ(sample_index(), (index + i) % TRACE_LEN);
+		CHECK_EQ(sim.conversions - start, i);			// state of simulator is updated by access
+	}
+
+	host_run_for_us(100 * cycle_us);				// no access: whole cycles are skipped at once
+	CHECK_EQ(sample_index(), (index + 2 * TRACE_LEN + 100) % TRACE_LEN);
+	CHECK_EQ(sim.conversions - start, 2 * TRACE_LEN + 100);
+
+	printf("sim: %u conversions, %u reads, %u writes, %u bytes, cycle %u us\n",
+		   sim.conversions, sim.reads, sim.writes, sim.bytes, (unsigned)cycle_us);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,137 @@
+/*
+ * test_spi_dma.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// SPI1 + DMA1 channel 2/3 driver against simulated BME280 slaves:
+// configuration, reads in one chip-select window, busy flag while the end
+// of transfer interrupt is pending, and transfers started from interrupt
+// while the main loop waits for its own transfer.
+#include "test.h"
+#include "host_spi.h"
+#include "CLOCK/CLOCK.h"
+#include "TIMER/TIMER.h"
+
+static BME280 sensor_a, sensor_b;
+static BME280_SIM sim_a, sim_b;
+static uint8_t raw_b[BME280_DATA_SIZE];
+static volatile uint8_t done_a, done_b;
+static uint32_t isr_started, isr_busy;
+
+static void read_a_done(void)
+{
+	done_a++;
+}
+
+static void read_b_done(void)
+{
+	done_b++;
+}
+
+/****************************************************************************/
+/*      timer interrupt starts read of sensor B, DMA can be busy			*/
+/*      with transfer of main loop											*/
+/****************************************************************************/
+static void timer_read_b(void)
+{
+	if (BME280_read_data_DMA(&sensor_b, 0xF7, BME280_DATA_SIZE, raw_b, read_b_done)) isr_busy++;
+	else isr_started++;
+}
+
+static void conf_sensor(BME280 *bme)
+{
+	uint8_t result;
+
+	do
+	{
+		result = BME280_Conf(bme);
+		host_run_for_us(1000);
+	}
+	while (result == 3);
+
+	CHECK_EQ(result, 0);
+	CHECK_EQ(bme->err_conf, 0);
+}
+
+int main(void)
+{
+	uint8_t raw[BME280_CALIB1_SIZE], chip_id = 0;
+	uint32_t conversion;
+
+	CLOCK_Conf();
+	TIMER_Conf();
+	SPI_Conf();
+
+	BME280_Sim_Init(&sim_a, 0, 0, 0);
+	BME280_Sim_Init(&sim_b, 0, 0, 0);
+	host_spi_attach(GPIOB, GPIO_Pin_0, &sim_a);
+	host_spi_attach(GPIOB, GPIO_Pin_1, &sim_b);
+	BME280_Init_SPI(&sensor_a, GPIOB, GPIO_Pin_0);
+	BME280_Init_SPI(&sensor_b, GPIOB, GPIO_Pin_1);
+
+	// ----- configuration and calibration are read by blocking DMA transfers -----
+	conf_sensor(&sensor_a);
+	conf_sensor(&sensor_b);
+	CHECK_EQ(sensor_a.coef.dig_T1, 27504);
+	CHECK_EQ(sensor_a.coef.dig_P9, 6000);
+	CHECK_EQ(sensor_b.coef.dig_H2, 370);
+
+	BME280_read_data(&sensor_a, 0xD0, 1, &chip_id);
+	CHECK_EQ(chip_id, BME280_SIM_CHIP_ID);
+	CHECK_EQ(host_spi_stats.collisions, 0);
+	CHECK_EQ(host_spi_stats.unselected, 0);
+
+	// ----- forced conversion and one data read -----
+	conversion = BME280_Trigger(&sensor_a);
+	host_run_for_us(conversion);
+	CHECK_EQ(BME280_read_data_DMA(&sensor_a, 0xF7, BME280_DATA_SIZE, sensor_a.raw, read_a_done), 0);
+	CHECK_EQ(done_a, 1);
+	CHECK_EQ(SPI_DMA_Busy(), 0);
+	CHECK_EQ(BME280_Calculate(&sensor_a), 0);
+	CHECK_EQ(sensor_a.temperature, 2508);
+
+	// ----- end of transfer is pending: DMA stays busy, CS stays low -----
+	__disable_irq();
+	CHECK_EQ(BME280_read_data_DMA(&sensor_a, 0xF7, BME280_DATA_SIZE, raw, read_a_done), 0);
+	CHECK_EQ(SPI_DMA_Busy(), 1);
+	CHECK_EQ(GPIO_ReadOutputDataBit(GPIOB, GPIO_Pin_0), Bit_RESET);
+	CHECK_EQ(BME280_read_data_DMA(&sensor_b, 0xF7, BME280_DATA_SIZE, raw_b, read_b_done), 1);
+	CHECK_EQ(SPI_DMA_Transfer(GPIOB, GPIO_Pin_1, raw, 0, raw, SPI_DMA_BUF_SIZE + 1, 0), 2);
+	CHECK_EQ(done_a, 1);
+	__enable_irq();
+	CHECK_EQ(done_a, 2);
+	CHECK_EQ(done_b, 0);
+	CHECK_EQ(SPI_DMA_Busy(), 0);
+	CHECK_EQ(GPIO_ReadOutputDataBit(GPIOB, GPIO_Pin_0), Bit_SET);
+	CHECK(memcmp(raw, sensor_a.raw, BME280_DATA_SIZE) == 0);
+
+	// ----- interrupt starts transfers at different moments of blocking transfers of main loop -----
+	for (uint32_t i = 0; i < 2000; i++)
+	{
+		TIMER_Start_Oneshot(10 + (i % 97), timer_read_b);
+
+		while (TIMER_Busy())
+		{
+			BME280_read_data(&sensor_a, 0x88, BME280_CALIB1_SIZE, raw);		// long transfer, ~24 us
+			CHECK_EQ(raw[0], 0x70);
+			host_advance_ns(3000);											// main loop work between transfers
+		}
+		while (SPI_DMA_Busy()) host_advance_ns(100);
+	}
+
+	CHECK_EQ(isr_started + isr_busy, 2000);
+	CHECK_EQ(done_b, isr_started);
+	CHECK(isr_busy > 0);
+	CHECK(isr_started > 0);
+	CHECK_EQ(host_spi_stats.collisions, 0);
+	CHECK_EQ(host_spi_stats.unselected, 0);
+	CHECK(memcmp(raw_b, sensor_a.raw, BME280_DATA_SIZE) == 0);		// both simulators publish default sample
+
+	printf("spi dma: %u transfers, %u bytes, interrupt reads started %u / rejected as busy %u\n",
+		   host_spi_stats.transfers, host_spi_stats.bytes, isr_started, isr_busy);
+
+	return TEST_RESULT();
+}
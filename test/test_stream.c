@@ -0,0 +1,152 @@
+/*
+ * test_stream.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// Streaming of sensors in normal mode on simulated time. Constant signal
+// has to be published every conversion cycle (new conversion is recognised
+// by time, not by values). Sensors with clock faster or slower than the MCU
+// replay trace of unique samples: the phase drifts through the conversion,
+// which has to be caught by status bits, so no conversion is published twice.
+#include "test.h"
+#include "host_spi.h"
+#include "CLOCK/CLOCK.h"
+#include "MEASURE/MEASURE.h"
+#include "BME280/BME280_compensate.h"
+
+#define SENSORS		3
+#define TRACE_LEN	4096
+#define CYCLES		1500
+#define SKEW_PPM	20000		// +-2 % clock error of sensor
+
+static BME280 sensors[SENSORS];
+static BME280_SIM sims[SENSORS];
+static BME280_SIM_SAMPLE trace[TRACE_LEN];
+static uint32_t published[SENSORS], repeated[SENSORS];
+static int32_t last_index[SENSORS];
+static const uint16_t cs_pins[SENSORS] = {GPIO_Pin_0, GPIO_Pin_1, GPIO_Pin_2};
+
+/****************************************************************************/
+/*      clocks of sensors: exact, 2 % fast, 2 % slow						*/
+/****************************************************************************/
+static uint32_t fast_clock(void)
+{
+	return (uint32_t)(host_now_ns * (1000000 + SKEW_PPM) / 1000000000ULL);
+}
+
+static uint32_t slow_clock(void)
+{
+	return (uint32_t)(host_now_ns * (1000000 - SKEW_PPM) / 1000000000ULL);
+}
+
+/****************************************************************************/
+/*      published sample has to be later in trace than the previous one		*/
+/****************************************************************************/
+static void data_ready(BME280 *bme)
+{
+	uint8_t n = bme - sensors;
+	int32_t adc_T, adc_P, adc_H, index;
+
+	bme280_unpack_raw(bme->raw, &adc_T, &adc_P, &adc_H);
+	index = adc_T - (int32_t)trace[0].adc_T;
+	if (n && (last_index[n] >= 0) && ((uint32_t)(index - last_index[n] - 1) % TRACE_LEN >= TRACE_LEN / 2)) repeated[n]++;	// trace is replayed in loop
+	last_index[n] = index;
+	published[n]++;
+}
+
+static void stream(uint8_t n, MEASURE_STREAM_STATS *stats)
+{
+	uint32_t cycle_us = BME280_Cycle_Time_us(&sensors[n]);
+
+	CHECK_EQ(MEASURE_Stream_Start(&sensors[n]), 0);
+	CHECK_EQ(MEASURE_Stream_Start(&sensors[n]), 1);
+	host_run_for_us((uint64_t)CYCLES * cycle_us);
+	MEASURE_Stream_Stop();
+	MEASURE_Stream_Stats(stats);
+
+	printf("stream %u: %u samples, %u duplicates, %u skipped, %u resyncs, %u drifts, %u conversions, ODR %u mHz\n",
+		   n, stats->samples, stats->duplicates, stats->skipped, stats->resyncs, stats->drifts,
+		   sims[n].conversions, MEASURE_Stream_ODR(stats));
+}
+
+int main(void)
+{
+	static uint32_t (*const clocks[SENSORS])(void) = {0, fast_clock, slow_clock};
+	MEASURE_STREAM_STATS stats;
+	uint32_t cycle_us, start;
+	uint8_t result;
+
+	CLOCK_Conf();
+	MEASURE_Conf();
+	SPI_Conf();
+	MEASURE_Set_Callback(data_ready);
+
+	for (uint32_t k = 0; k < TRACE_LEN; k++)
+	{
+		trace[k].adc_T = 400000 + k;
+		trace[k].adc_P = 415148;
+		trace[k].adc_H = 27000;
+	}
+
+	for (uint8_t n = 0; n < SENSORS; n++)
+	{
+		// sensor 0 has constant sample, the others replay unique samples
+		BME280_Sim_Init(&sims[n], n ? trace : 0, n ? TRACE_LEN : 0, clocks[n]);
+		host_spi_attach(GPIOB, cs_pins[n], &sims[n]);
+		BME280_Init_SPI(&sensors[n], GPIOB, cs_pins[n]);
+		BME280_Set_Normal_Mode(&sensors[n], BME280_STANDBY_MS_10, BME280_FILTER_OFF);
+		sensors[n].conf.osrs_t = sensors[n].conf.osrs_p = sensors[n].conf.osrs_h = BME280_oversampling_x1;
+		last_index[n] = -1;
+
+		do
+		{
+			result = BME280_Conf(&sensors[n]);
+			host_run_for_us(1000);
+		}
+		while (result == 3);
+		CHECK_EQ(result, 0);
+		CHECK_EQ(MEASURE_Register(&sensors[n]), 0);
+	}
+
+	// ----- forced-mode sensor can't be streamed -----
+	sensors[0].conf.mode = BME280_FORCEDMODE;
+	CHECK_EQ(MEASURE_Stream_Start(&sensors[0]), 1);
+	sensors[0].conf.mode = BME280_NORMALMODE;
+
+	// ----- constant signal: published every cycle, nothing dropped as duplicate -----
+	cycle_us = BME280_Cycle_Time_us(&sensors[0]);
+	start = sims[0].conversions;
+	stream(0, &stats);
+	CHECK_EQ(stats.cycle_us, cycle_us);
+	CHECK_EQ(stats.duplicates, 0);
+	CHECK_EQ(stats.drifts, 0);
+	CHECK_EQ(stats.skipped, 0);
+	CHECK_EQ(published[0], stats.samples);
+	// only cycles of phase searches (every MEASURE_RESYNC_SAMPLES) aren't read
+	CHECK(stats.samples + 2 * stats.resyncs >= sims[0].conversions - start);
+	CHECK(stats.samples >= CYCLES * 9 / 10);
+	CHECK(MEASURE_Stream_ODR(&stats) > 1000000000ULL / cycle_us * 99 / 100);
+	CHECK(MEASURE_Stream_ODR(&stats) < 1000000000ULL / cycle_us * 101 / 100);
+
+	// ----- sensor faster than expected: conversions are skipped, never repeated -----
+	stream(1, &stats);
+	CHECK_EQ(repeated[1], 0);
+	CHECK_EQ(published[1], stats.samples);
+	CHECK(stats.samples >= CYCLES * 8 / 10);
+	CHECK(stats.drifts > 0);
+
+	// ----- sensor slower than expected: the read reaches the same conversion -----
+	// again only through the conversion, status bits have to stop it
+	stream(2, &stats);
+	CHECK_EQ(repeated[2], 0);
+	CHECK_EQ(published[2], stats.samples);
+	CHECK(stats.samples >= CYCLES * 8 / 10);
+	CHECK(stats.drifts > 0);
+
+	CHECK_EQ(host_spi_stats.collisions, 0);
+
+	return TEST_RESULT();
+}
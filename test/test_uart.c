@@ -0,0 +1,230 @@
+/*
+ * test_uart.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: agent
+ */
+
+// --------------------------------------------------------- //
+// UART with DMA on model of USART1 (host_usart.c): priority of TX interrupt
+// needs priority group set before UART_Conf, transmit ring buffer wraps
+// around in DMA blocks of at most UART_TX_DMA_CHUNK bytes without loss or
+// reordering, full buffer drops whole blocks (back-pressure is left to the
+// caller) and releases space after every block, received lines are taken
+// over by IDLE and half/full transfer interrupts across wrap-around of
+// circular buffer, echoed back, and overrun flushes buffer. Line counter
+// counts every CR of a frame which wraps around the buffer, and without
+// line consumer UART_RX_STR_EVENT drops unread lines and ends the loop of
+// caller.
+#include <string.h>
+#include "test.h"
+#include "host_usart.h"
+#include "UART/UART.h"
+
+#define LINES		60
+
+extern volatile uint16_t UART_RxHead;
+
+static uint32_t lines_signalled;
+static char line[UART_RX_BUF_SIZE + 1];
+static char expected[HOST_USART_CAPTURE];
+static uint32_t expected_len;
+
+static void line_received(void)
+{
+	lines_signalled++;
+}
+
+static void drain(void)
+{
+	while (uart_tx_busy()) host_run_for_us(100);
+}
+
+static void receive(const char *data)
+{
+	uint16_t len = strlen(data);
+
+	host_usart_receive(data, len);
+	host_run_for_us((uint64_t)(len + 2) * HOST_USART_BYTE_NS / 1000);
+}
+
+int main(void)
+{
+	uint16_t len, free_before, accepted = 0;
+	uint32_t dropped, tx_start;
+
+	host_reset();
+	host_usart_attach();
+	register_uart_rx_line_callback(line_received);
+
+	// ----- priority of interrupts: group has to be set before NVIC_Init -----
+	UART_Conf(UART_BAUD);
+	CHECK_EQ(host_nvic_priority[DMA1_Channel4_IRQn], 0);			// reset value of group: priority is lost
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+	UART_Conf(UART_BAUD);
+	CHECK_EQ(host_nvic_priority[DMA1_Channel4_IRQn], UART_TX_IRQ_PRIORITY << 4);
+	CHECK_EQ(host_nvic_priority[USART1_IRQn], 0);
+	CHECK_EQ(host_nvic_priority[DMA1_Channel5_IRQn], 0);
+
+	// ----- transmit: lines of different length wrap around the buffer several times -----
+	for (uint16_t n = 0; n < LINES; n++)
+	{
+		len = 37 + n % 23;
+		for (uint16_t i = 0; i < len - 2; i++) line[i] = 'A' + (n + i) % 26;
+		line[len - 2] = '\r';
+		line[len - 1] = '\n';
+
+		while (uart_tx_free() < len) host_run_for_us(100);				// caller waits for space
+		CHECK_EQ(uart_write(line, len), len);
+		memcpy(&expected[expected_len], line, len);
+		expected_len += len;
+	}
+	drain();
+	CHECK(expected_len > 3 * UART_TX_BUF_SIZE);
+	CHECK_EQ(host_usart_tx_len, expected_len);
+	CHECK(!memcmp(host_usart_tx, expected, expected_len));
+	CHECK(host_usart_stats.tx_max_transfer <= UART_TX_DMA_CHUNK);
+	CHECK(host_usart_stats.tx_transfers > expected_len / UART_TX_DMA_CHUNK);	// blocks are cut at end of buffer
+	CHECK_EQ(uart_tx_dropped(), 0);
+	CHECK_EQ(uart_tx_free(), UART_TX_BUF_SIZE - 1);
+
+	// ----- back-pressure: full buffer drops whole blocks, nothing is sent twice -----
+	tx_start = host_usart_tx_len;
+	expected_len = 0;
+	memset(line, '#', 100);
+	for (uint16_t n = 0; n < 8; n++)
+	{
+		line[0] = '0' + n;
+		len = uart_write(line, 100);
+		CHECK((len == 0) || (len == 100));
+		if (len)
+		{
+			memcpy(&expected[expected_len], line, 100);
+			expected_len += 100;
+			accepted++;
+		}
+	}
+	CHECK_EQ(accepted, (UART_TX_BUF_SIZE - 1) / 100);
+	CHECK_EQ(uart_tx_dropped(), (8 - accepted) * 100);
+	CHECK_EQ(uart_write("x", 1) + uart_write("yz", 2), 3);			// short blocks still fit
+	memcpy(&expected[expected_len], "xyz", 3);
+	expected_len += 3;
+	CHECK_EQ(uart_write(line, uart_tx_free() + 1), 0);
+	dropped = uart_tx_dropped();
+
+	free_before = uart_tx_free();
+	host_run_for_us((UART_TX_DMA_CHUNK + 1) * HOST_USART_BYTE_NS / 1000);
+	CHECK_EQ(uart_tx_free(), free_before + UART_TX_DMA_CHUNK);		// space is released after every block
+	drain();
+	CHECK_EQ(host_usart_tx_len - tx_start, expected_len);
+	CHECK(!memcmp(&host_usart_tx[tx_start], expected, expected_len));
+	CHECK_EQ(uart_tx_dropped(), dropped);
+
+	// ----- receive: line is taken over by IDLE and echoed -----
+	tx_start = host_usart_tx_len;
+	receive("period 100\r");
+	CHECK_EQ(host_usart_stats.idle, 1);
+	CHECK_EQ(lines_signalled, 1);
+	CHECK_EQ(ascii_line, 1);
+	CHECK(!strcmp(uart_get_str(line), "period 100"));
+	CHECK_EQ(ascii_line, 0);
+	drain();
+	CHECK_EQ(host_usart_tx_len - tx_start, 11);
+	CHECK(!memcmp(&host_usart_tx[tx_start], "period 100\r", 11));
+
+	// ----- receive: lines wrap around circular buffer -----
+	for (uint16_t n = 0; n < 12; n++)
+	{
+		char text[64];
+
+		len = 30 + 2 * n;
+		for (uint16_t i = 0; i < len; i++) text[i] = 'a' + (n + i) % 26;
+		text[len] = '\r';
+		text[len + 1] = 0;
+		receive(text);
+
+		text[len] = 0;
+		CHECK_EQ(ascii_line, 1);
+		CHECK(!strcmp(uart_get_str(line), text));
+	}
+	CHECK_EQ(lines_signalled, 13);
+
+	// ----- receive: frame longer than half of buffer is taken over by HT / TC -----
+	{
+		char text[UART_RX_BUF_SIZE];
+
+		memset(text, 'L', 100);
+		text[100] = '\r';
+		text[101] = 0;
+		receive(text);
+
+		text[100] = 0;
+		CHECK(!strcmp(uart_get_str(line), text));
+		CHECK_EQ(uart_rx_overruns(), 0);
+	}
+
+	// ----- receive: overrun flushes buffer, next lines are received -----
+	{
+		char text[201];
+
+		memset(text, 'x', 199);
+		text[199] = '\r';
+		text[200] = 0;
+		receive(text);
+		CHECK(uart_rx_overruns() > 0);
+		CHECK_EQ(ascii_line, 1);
+		uart_get_str(line);							// tail of flushed line
+
+		receive("ok\r");
+		CHECK(!strcmp(uart_get_str(line), "ok"));
+	}
+
+	// ----- receive: several CRs of one frame which wraps around the buffer are all counted -----
+	{
+		char text[UART_RX_BUF_SIZE];
+		uint16_t fill = (UART_RX_BUF_SIZE - 4 - UART_RxHead) & UART_RX_BUF_MASK;
+
+		if (fill < 2) fill += UART_RX_BUF_SIZE / 2;		// filler line needs at least one character and CR
+		memset(text, 'f', fill - 1);
+		text[fill - 1] = '\r';
+		text[fill] = 0;
+		receive(text);
+		uart_get_str(line);
+		CHECK_EQ(UART_RxHead, UART_RX_BUF_SIZE - 4);
+
+		receive("ab\rcd\ref\r");						// CRs before and after the end of buffer
+		CHECK_EQ(ascii_line, 3);
+		CHECK(!strcmp(uart_get_str(line), "ab"));
+		CHECK(!strcmp(uart_get_str(line), "cd"));
+		CHECK(!strcmp(uart_get_str(line), "ef"));
+		CHECK_EQ(ascii_line, 0);
+	}
+
+	// ----- receive without line consumer: UART_RX_STR_EVENT drops unread lines -----
+	{
+		uint8_t calls = 0;
+
+		receive("first\r");
+		receive("second\r");
+		CHECK_EQ(ascii_line, 2);
+		while (ascii_line && (calls < 10))					// loop of task_command
+		{
+			UART_RX_STR_EVENT(line);
+			calls++;
+		}
+		CHECK_EQ(calls, 1);
+		CHECK_EQ(ascii_line, 0);
+		CHECK_EQ(uart_getc(), -1);
+
+		receive("next\r");
+		CHECK_EQ(ascii_line, 1);
+		CHECK(!strcmp(uart_get_str(line), "next"));
+	}
+	CHECK_EQ(host_usart_stats.rx_lost, 0);
+
+	printf("uart: %u bytes sent in %u DMA blocks (max %u), %u received, %u dropped, %u overruns\n",
+		   host_usart_stats.tx_bytes, host_usart_stats.tx_transfers, host_usart_stats.tx_max_transfer,
+		   host_usart_stats.rx_bytes, uart_tx_dropped(), uart_rx_overruns());
+
+	return TEST_RESULT();
+}